@@ -16,7 +16,7 @@ void Init_WidgetEditor( void )
 {
   app.delegate.logic = we_DoLoop;
   app.delegate.draw  = we_RenderLoop;
-  app.options.frame_cap = 1;
+  app.options.frame_cap = FRAME_PACE_CAP;
 
 }
 
@@ -50,24 +50,15 @@ static void we_RenderLoop( float dt )
 void aMainloop( void )
 {
   float dt = a_GetDeltaTime();
-  a_TimerStart( app.time.FPS_cap_timer );
   a_GetFPS();
   a_PrepareScene();
   
   app.delegate.logic( dt );
   app.delegate.draw( dt );
   
+  // Paced to app.options.target_fps by a_PresentScene()
   a_PresentScene();
   app.time.frames++;
-  
-  if ( app.options.frame_cap )
-  {
-    int frame_tick = a_TimerGetTicks( app.time.FPS_cap_timer );
-    if ( frame_tick < LOGIC_RATE )
-    {
-      SDL_Delay( LOGIC_RATE - frame_tick );
-    }
-  }
 }
 
 int main( void )
@@ -37,7 +37,7 @@ BLIT_OBJECTS = {
 # Objects that should use a_Object* pattern (noun-verb)
 USED_OBJECTS = {
     "Timer", "Viewport", "Flex", "Widget", "Image", "Audio",
-    "AUF", "Glyph", "Font", "Texture", "Error"
+    "AUF", "Glyph", "Font", "Texture", "Error", "RenderState", "SpriteBatch", "Atlas", "Pixels", "Layer", "Framebuffer", "DrawList", "Capture", "FramePace", "RenderStats", "Particles", "Pack", "HotReload", "Preload", "SpriteSheet", "Animation"
 }
 
 # Pattern to match function declarations in header
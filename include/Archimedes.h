@@ -166,13 +166,74 @@ typedef struct
   int x, y, z;
 } aPoint3i_t;
 
-typedef struct
+typedef struct _aImage_t
 {
   SDL_Surface* surface;
   SDL_Texture* texture;
   char* filename;
+  aRecti_t rect;      // Region of texture holding this image (whole texture unless atlased)
+  int atlas_page;     // Atlas page the texture belongs to, -1 if the image owns its texture
+  int w;              // Texture width, recorded once when the texture is created
+  int h;              // Texture height
+  uint32_t format;    // Texture SDL_PixelFormatEnum
+  int access;         // Texture SDL_TextureAccess
+  int state;          // aImageState_t; only a_ImageLoadAsync() images are ever not ready
+  int refcount;       // Outstanding a_ImageLoad/a_ImageAcquire references
+  size_t bytes;       // Surface plus owned texture, counted against the cache budget
+  float decode_ms;    // Last decode of the file, on whichever thread did it
+  float upload_ms;    // Last texture creation or atlas upload
+  uint32_t last_use;  // Cache frame it was last acquired or drawn on
+  struct _aImage_t* lru_prev;  // Unreferenced images, most recently released first
+  struct _aImage_t* lru_next;
 } aImage_t;
 
+typedef enum
+{
+  IMAGE_LOAD_DEFAULT = 0,
+  IMAGE_LOAD_ATLAS   = 1 << 0,  // Pack into a shared atlas page when small enough
+  IMAGE_LOAD_DROP_SURFACE = 1 << 1  // Free the surface once the texture is up; see a_ImageGetSurface()
+} aImageLoadFlags_t;
+
+typedef enum
+{
+  IMAGE_STATE_READY = 0,
+  IMAGE_STATE_PENDING,   // Decoding on a worker or waiting for its upload
+  IMAGE_STATE_FAILED
+} aImageState_t;
+
+typedef void ( *aImageLoadCallback_t )( aImage_t* img, void* user );
+
+#define IMAGE_CACHE_DEFAULT_BUDGET ( (size_t)256 * 1024 * 1024 )
+
+#define PACK_MAX_MOUNTS 4
+
+typedef void ( *aHotReloadCallback_t )( const char* path, void* user );
+
+#define HOT_RELOAD_MAX_DIRS  64
+#define HOT_RELOAD_MAX_FILES 64
+
+enum
+{
+  PACK_WRITE_COMPRESS = 1 << 0   // LZ-compress pixel blocks that shrink
+};
+
+#define IMAGE_ASYNC_MAX_WORKERS   4
+#define IMAGE_ASYNC_UPLOAD_BUDGET ( (size_t)4 * 1024 * 1024 )  // Decoded bytes uploaded per frame
+
+#define ATLAS_MAX_PAGES      8
+#define ATLAS_PAGE_SIZE      1024
+#define ATLAS_MAX_IMAGE_SIZE 256
+#define ATLAS_PADDING        1
+
+typedef struct
+{
+  int page_count;
+  int image_count;
+  int page_size[ATLAS_MAX_PAGES];
+  float occupancy[ATLAS_MAX_PAGES];   // Fraction of each page covered by images
+  float total_occupancy;
+} aAtlasStats_t;
+
 typedef struct
 {
   uint8_t r;
@@ -181,6 +242,62 @@ typedef struct
   uint8_t a;
 } aColor_t;
 
+typedef struct
+{
+  SDL_Surface* surface;
+  uint8_t* pixels;    // Surface pixels, valid between a_PixelsBegin() and a_PixelsEnd()
+  int pitch;
+  int bpp;            // Bytes per pixel
+  int fast;           // 32-bit 8888 layout, handled by the vector kernels
+  int locked;         // Session took the surface lock
+  aRecti_t dirty;     // Bounding box of every pixel written, in surface coordinates
+} aPixels_t;
+
+typedef struct _aLayer_t
+{
+  SDL_Texture* texture;             // SDL_TEXTUREACCESS_TARGET, premultiplied contents
+  SDL_Texture* previous_target;     // Target to restore in a_LayerEnd()
+  int w;
+  int h;
+  int dirty;                        // Contents must be redrawn before the next composite
+  struct _aLayer_t* next;
+} aLayer_t;
+
+enum
+{
+  CAPTURE_FORMAT_PNG,   /**< Smaller files, slow to encode */
+  CAPTURE_FORMAT_QOI    /**< Fast to encode, for frame sequences */
+};
+
+typedef struct
+{
+  int backlog;          // Captures queued or being encoded
+  int capacity;         // Ring size; captures are dropped when backlog reaches it
+  int written;          // Files written since start-up
+  int dropped;          // Captures skipped because the ring was full
+} aCaptureStats_t;
+
+/*
+ * Particles as parallel arrays for a_DrawParticles(). Color comes from
+ * colors[] when set, otherwise color, with its alpha replaced by the
+ * alpha ramp when life[] and alpha_ramp are set.
+ */
+typedef struct
+{
+  const float* x;             // Left edge of each particle
+  const float* y;             // Top edge of each particle
+  int count;
+  float size;                 // Width and height of every particle
+  const aColor_t* colors;     // Per-particle color, or NULL
+  aColor_t color;             // Color of every particle when colors is NULL
+  const float* life;          // Per-particle age indexing alpha_ramp, or NULL
+  float life_max;             // Age at the last ramp entry
+  const uint8_t* alpha_ramp;  // Alpha by age, evenly spaced over [0, life_max]
+  int ramp_size;
+  aImage_t* image;            // NULL for solid quads, else textured point sprites
+  aRectf_t src;               // Region of image relative to it; zero size for all of it
+} aParticles_t;
+
 typedef struct
 {
   uint32_t start_ticks;
@@ -195,14 +312,44 @@ typedef struct
   int  error_type;
 } aError_t;
 
+typedef struct
+{
+  aRectf_t rect;        // Trimmed frame on the sheet image
+  aPoint2f_t offset;    // Trim offset minus pivot, added to the draw position
+} aSpriteFrame_t;
+
+typedef struct
+{
+  char* name;
+  int first;            // Start of its run in aSpriteSheet_t.sequence
+  int frame_count;
+  uint32_t frame_duration;
+  int loop;             // 0 holds the last frame
+} aSpriteSheetAnim_t;
+
+typedef struct
+{
+  aImage_t* image;
+  aSpriteFrame_t* frames;      // Every named frame, in file order
+  char** frame_names;
+  int frame_count;
+  aSpriteFrame_t* sequence;    // Each animation's frames back to back
+  int sequence_count;
+  aSpriteSheetAnim_t* anims;
+  int anim_count;
+} aSpriteSheet_t;
+
 typedef struct
 {
   aImage_t * sprite_sheet;
   int frame_count;
   int frame_index;
-  aRectf_t sprite_rect;
+  aRectf_t sprite_rect;        // Current frame's rect on the sheet
   uint32_t frame_duration;
   aTimer_t* animation_timer;
+  aSpriteFrame_t* frames;      // Precomputed, one per frame
+  aSpriteSheet_t* sheet;       // Owns frames; NULL if the animation does
+  int loop;
 } aAnimation_t;
 
 typedef struct _widget_t
@@ -296,12 +443,30 @@ typedef struct _aAUF_t
 
 } aAUF_t;
 
+enum
+{
+  FRAME_PACE_UNCAPPED,  /**< Present as fast as possible */
+  FRAME_PACE_CAP,       /**< Sleep-then-spin to app.options.target_fps */
+  FRAME_PACE_VSYNC      /**< Let SDL_RenderPresent() wait for the display */
+};
+
 typedef struct
 {
-  uint8_t frame_cap;
+  uint8_t frame_cap;        // FRAME_PACE_* mode, applied by a_PresentScene(); defaults to UNCAPPED
+  int target_fps;           // Frame rate for FRAME_PACE_CAP
   int scale_factor;
+  uint8_t headless;         // Set by a_InitEx(); no window, rendering goes to app.framebuffer
 } aOptions_t;
 
+typedef struct
+{
+  int width;
+  int height;
+  const char* title;
+  uint32_t window_flags;    // SDL_WindowFlags for the window, ignored when headless
+  uint8_t headless;         // Dummy video driver and a software renderer drawing into memory
+} aInitOptions_t;
+
 typedef struct
 {
   int x;
@@ -314,17 +479,52 @@ typedef struct
   int8_t  wheel;
 } aMouse_t;
 
-typedef struct _aImageCacheNode_t
+typedef struct
 {
+  uint64_t hash;
+  char* path;          // Interned copy of the key, owned by the cache
   aImage_t* image;
-  struct _aImageCacheNode_t* next;
-} aImageCacheNode_t;
+} aImageCacheEntry_t;
 
 typedef struct
 {
-  aImageCacheNode_t* head;
+  aImageCacheEntry_t* entries;
+  int capacity;        // Always a power of two
+  int count;
+  aImage_t* lru_head;  // Most recently released unreferenced image
+  aImage_t* lru_tail;  // Next to be evicted
+  size_t resident_bytes;
+  size_t budget;       // 0 disables eviction
+  uint32_t evictions;
+  uint32_t frame;      // Bumped by a_PrepareScene(), stamped into aImage_t.last_use
+  uint32_t hits;       // Loads answered from the cache
+  uint32_t misses;     // Loads that had to decode the file
+  uint32_t loads;      // Decodes that reached the GPU, reloads included
+  double decode_ms;    // Summed over every load
+  double upload_ms;
 } aImageCache_t;
 
+typedef struct
+{
+  int images;           // Images in the cache
+  int unreferenced;     // Of those, how many are eligible for eviction
+  size_t resident_bytes;
+  size_t budget;
+  uint32_t evictions;   // Since a_ImageInit()
+  uint32_t hits;        // Counters below are since a_ImageInit() too
+  uint32_t misses;
+  uint32_t loads;
+  float decode_ms;
+  float upload_ms;
+  size_t surface_bytes; // resident_bytes split by where the pixels live
+  size_t texture_bytes; // Textures images own; atlas pages are counted apart
+  size_t atlas_bytes;   // Every atlas page, whatever it holds
+  uint32_t frame;       // Current cache frame, to compare against last_use
+} aImageCacheStats_t;
+
+// Marks an image as used this frame for a_ImageCacheDump()
+#define IMAGE_TOUCH( img ) ( (img)->last_use = app.img_cache ? app.img_cache->frame : 0 )
+
 typedef struct
 {
   uint32_t current_time; //Delta time
@@ -336,6 +536,66 @@ typedef struct
   float avg_FPS;
 } aDeltaTime_t;
 
+typedef struct
+{
+  int mode;                 // FRAME_PACE_* mode in effect
+  int target_fps;           // Cap, or the display refresh rate under vsync
+  int frames;               // Frames paced since the mode was set
+  int missed;               // Frames that finished after their deadline
+  float frame_ms;           // Duration of the last frame, present to present
+  float worst_ms;           // Longest frame since the mode was set
+} aFramePaceStats_t;
+
+#define RENDER_STATE_TEXTURE_SLOTS 64
+
+typedef struct
+{
+  SDL_Texture* texture;
+  aColor_t mod;
+  SDL_BlendMode blend;
+  uint8_t color_known;
+  uint8_t alpha_known;
+  uint8_t blend_known;
+} aTextureModState_t;
+
+typedef struct
+{
+  uint8_t known;              // Bit set of the renderer state values below that are valid
+  aColor_t draw_color;
+  SDL_BlendMode blend_mode;
+  aTextureModState_t textures[RENDER_STATE_TEXTURE_SLOTS];  // Direct-mapped by texture pointer
+
+  uint32_t skipped;           // State changes that matched the shadow copy and were not sent to SDL
+  uint32_t applied;           // State changes that reached SDL
+} aRenderState_t;
+
+/*
+ * Per-frame renderer counters. Only collected when the engine is built
+ * with -DARCHIMEDES_RENDER_STATS (make STATS=1); otherwise every counter
+ * compiles away.
+ */
+typedef struct
+{
+  uint32_t draw_calls;        // SDL_RenderGeometry, SDL_RenderCopy and SDL_RenderClear calls
+  uint32_t vertices;          // Vertices submitted, 4 per copy
+  uint32_t texture_binds;     // Draw calls using a different texture than the one before
+  uint32_t state_changes;     // Render state changes that reached SDL
+  uint32_t state_skipped;     // Redundant state changes dropped by the shadow state
+  uint32_t target_changes;    // Render target switches
+  uint32_t glyphs;            // Glyphs copied by the text renderer
+  uint32_t widgets;           // Widgets drawn
+  uint32_t viewport_draws;    // Primitives drawn through the viewport transform
+  uint64_t pixels_filled;     // Destination area of every fill and copy, overdraw included
+} aRenderStats_t;
+
+#if defined(ARCHIMEDES_RENDER_STATS)
+#define RENDER_STATS_ADD( field, n )           ( a_RenderStatsCounters()->field += (n) )
+#define RENDER_STATS_DRAW( texture, vertices ) a_RenderStatsDraw( texture, vertices )
+#else
+#define RENDER_STATS_ADD( field, n )           ( (void)0 )
+#define RENDER_STATS_DRAW( texture, vertices ) ( (void)0 )
+#endif
+
 typedef struct
 {
   void (*logic)( float delta_time );
@@ -347,6 +607,7 @@ typedef struct
 {
   SDL_Window* window;
   SDL_Renderer* renderer;
+  SDL_Surface* framebuffer;   // Software render target in headless mode, NULL otherwise
   aDelegate_t delegate;
   aOptions_t options;
   aDeltaTime_t time;
@@ -366,6 +627,7 @@ typedef struct
   char input_text[MAX_INPUT_LENGTH];
   int last_key_pressed;
   aRectf_t g_viewport;
+  aRenderState_t render_state;
   struct {
     int channel_count;       // Total number of mixing channels
     int reserved_channels;   // Channels reserved from auto-allocation
@@ -806,6 +1068,40 @@ void a_AudioPlayEffect(aAudioClip_t *clip);
 float a_GetDeltaTime( void );
 void a_GetFPS( void );
 
+/**
+ * @brief Select how a_PresentScene() paces frames
+ *
+ * FRAME_PACE_CAP sleeps for most of the remaining frame time and spins on
+ * SDL_GetPerformanceCounter() for the rest, landing within about 0.1 ms of
+ * each deadline. FRAME_PACE_VSYNC turns on renderer vsync and falls back
+ * to a cap at the display refresh rate if the renderer can't do it.
+ *
+ * @param mode FRAME_PACE_UNCAPPED, FRAME_PACE_CAP or FRAME_PACE_VSYNC
+ * @param target_fps Frame rate for FRAME_PACE_CAP; 0 keeps the current one
+ *
+ * @note Same as writing app.options.frame_cap and app.options.target_fps,
+ *       which are picked up on the next present. Resets the pacing stats
+ * @note The default is FRAME_PACE_UNCAPPED, so a_PresentScene() never
+ *       sleeps unless the app opts in here; games with their own limiter
+ *       keep working unchanged
+ */
+void a_FramePaceSetMode( const int mode, const int target_fps );
+
+/**
+ * @brief Wait out the rest of the frame according to the pacing mode
+ *
+ * @note Called automatically by a_PresentScene() after presenting
+ */
+void a_FramePaceWait( void );
+
+/**
+ * @brief Read the frame pacing counters
+ *
+ * @param stats Filled with the active mode, target rate, frame count,
+ *              missed deadlines and frame times
+ */
+void a_FramePaceGetStats( aFramePaceStats_t* stats );
+
 /*
 ---------------------------------------------------------------
 ---                        Draw                             ---
@@ -818,7 +1114,7 @@ void a_GetFPS( void );
  * Initializes the render target and clears the screen with the current background color.
  * This function must be called at the beginning of each frame before any drawing operations.
  * 
- * @note Sets the render draw color to white (255,255,255,255) for subsequent operations
+ * @note Leaves the draw color set to the background; draw calls set their own state
  * @note Must be paired with a_PresentScene() to display the rendered frame
  */
 void a_PrepareScene( void );
@@ -832,9 +1128,30 @@ void a_PrepareScene( void );
  * 
  * @note Uses double-buffered rendering: swaps front and back buffers
  * @note Call this after all drawing operations in a frame
+ * @note Flushes any queued primitives before presenting
  */
 void a_PresentScene( void );
 
+/**
+ * @brief Submit all queued primitives to the renderer
+ * 
+ * Points, lines, rects, filled rects and triangle outlines are not drawn
+ * immediately; they are queued as colored geometry and submitted with a single
+ * SDL_RenderGeometry() call. Archimedes flushes on its own before textured
+ * draws, text, circles, screenshots and presenting, so draw order is preserved.
+ * 
+ * @note Call this before issuing raw SDL_Render* calls of your own
+ * @note Requires SDL 2.0.18 or newer for SDL_RenderGeometry()
+ */
+void a_DrawFlush( void );
+
+/**
+ * @brief Free the storage backing the primitive queue
+ * 
+ * @note Called automatically by a_Quit()
+ */
+void a_DrawCleanUp( void );
+
 /**
  * @brief Draw a single point at specified coordinates
  * 
@@ -848,303 +1165,1631 @@ void a_PresentScene( void );
 void a_DrawPoint( const int x, const int y, const aColor_t color );
 
 /**
- * @brief Draw a line between two points
- * 
- * Renders a straight line from the starting point to the ending point using
- * the specified color. Uses SDL's line drawing algorithm for optimal performance.
+ * @brief Draw a line between two points
+ * 
+ * Renders a straight line from the starting point to the ending point using
+ * the specified color. Uses SDL's line drawing algorithm for optimal performance.
+ * 
+ * @param x1 Starting X coordinate
+ * @param y1 Starting Y coordinate
+ * @param x2 Ending X coordinate
+ * @param y2 Ending Y coordinate
+ * @param color RGBA color structure for the line
+ * 
+ */
+void a_DrawLine( const int x1, const int y1, const int x2, const int y2, const aColor_t color );
+
+/**
+ * @brief Draw a horizontal line
+ * 
+ * Renders a horizontal line between two X coordinates at a fixed Y position.
+ * 
+ * @param x1 Starting X coordinate
+ * @param x2 Ending X coordinate
+ * @param y Y coordinate (same for both endpoints)
+ * @param color RGBA color structure for the line
+ * 
+ * @note Optimized for horizontal lines
+ * @note Order of x1 and x2 doesn't matter (automatically handles swapping)
+ */
+void a_DrawHorizontalLine( const int x1, const int x2, const int y, const aColor_t color );
+
+/**
+ * @brief Draw a vertical line
+ * 
+ * Renders a vertical line between two Y coordinates at a fixed X position.
+ * 
+ * @param y1 Starting Y coordinate
+ * @param y2 Ending Y coordinate
+ * @param x X coordinate (same for both endpoints)
+ * @param color RGBA color structure for the line
+ * 
+ * @note Order of y1 and y2 doesn't matter (automatically handles swapping)
+ */
+void a_DrawVerticalLine( const int y1, const int y2, const int x, const aColor_t color );
+
+/**
+ * @brief Draw a circle outline
+ * 
+ * Renders the outline of a circle at the specified center position with the given radius.
+ * Uses Bresenham's circle algorithm for efficient pixel-perfect circle drawing.
+ * The rasterized outline is cached per radius and queued as a handful of
+ * row runs into the primitive batch.
+ * 
+ * @param posX Center X coordinate
+ * @param posY Center Y coordinate
+ * @param radius Circle radius in pixels
+ * @param color RGBA color structure for the circle outline
+ */
+void a_DrawCircle( const int posX, const int posY, const int radius, const aColor_t color );
+
+/**
+ * @brief Draw a filled circle
+ * 
+ * Renders a completely filled circle at the specified center position with the given radius.
+ * Uses an optimized scan-line filling algorithm for smooth, solid circles.
+ * Spans are computed once per radius and queued as one rect per run of
+ * equal-width rows, so each row is covered exactly once.
+ * 
+ * @param posX Center X coordinate
+ * @param posY Center Y coordinate
+ * @param radius Circle radius in pixels
+ * @param color RGBA color structure for the filled circle
+ * 
+ * @note Radii below 512 are cached until a_DrawCleanUp()
+ */
+void a_DrawFilledCircle( const int posX, const int posY, const int radius, const aColor_t color );
+
+/**
+ * @brief Draw many filled circles of mixed radii in one pass
+ * 
+ * All circles are queued into the primitive batch and reach the renderer
+ * together at the next flush.
+ * 
+ * @param circles Array of circles; x and y are the center, z is the radius
+ * @param colors Array of colors, one per circle
+ * @param count Number of circles
+ */
+void a_DrawFilledCircles( const aPoint3i_t* circles, const aColor_t* colors, const int count );
+
+/**
+ * @brief Draw a triangle outline
+ * 
+ * Renders the outline of a triangle by drawing three lines connecting the specified vertices.
+ * 
+ * @param x0 First vertex X coordinate
+ * @param y0 First vertex Y coordinate
+ * @param x1 Second vertex X coordinate
+ * @param y1 Second vertex Y coordinate
+ * @param x2 Third vertex X coordinate
+ * @param y2 Third vertex Y coordinate
+ * @param color RGBA color structure for the triangle outline
+ * 
+ * @note Vertices can be specified in any order (clockwise or counter-clockwise)
+ */
+void a_DrawTriangle( const int x0, const int y0, const int x1, const int y1, const int x2,
+                     const int y2, const aColor_t color );
+
+/**
+ * @brief Draw a filled triangle
+ * 
+ * Renders a completely filled triangle using the three specified vertices.
+ * The triangle is queued into the primitive batch and submitted with
+ * SDL_RenderGeometry() at the next flush.
+ * 
+ * @param x0 First vertex X coordinate
+ * @param y0 First vertex Y coordinate
+ * @param x1 Second vertex X coordinate
+ * @param y1 Second vertex Y coordinate
+ * @param x2 Third vertex X coordinate
+ * @param y2 Third vertex Y coordinate
+ * @param color RGBA color structure for the filled triangle
+ * 
+ * @note Vertices can be specified in any order (clockwise or counter-clockwise)
+ */
+void a_DrawFilledTriangle( const int x0, const int y0, const int x1, const int y1,
+                           const int x2, const int y2, const aColor_t color );
+
+/**
+ * @brief Draw a filled convex polygon
+ * 
+ * The polygon is triangulated as a fan around the first point and queued
+ * into the primitive batch, so any convex shape costs a single geometry call.
+ * 
+ * @param points Polygon vertices in order (either winding)
+ * @param count Number of vertices (at least 3)
+ * @param color RGBA color structure for the polygon
+ * 
+ * @note Concave polygons are not triangulated correctly
+ */
+void a_DrawFilledPolygon( const aPoint2f_t* points, const int count, const aColor_t color );
+
+/**
+ * @brief Rasterize a filled triangle directly into a surface on the CPU
+ * 
+ * Walks the triangle one scanline at a time using incremental edge functions
+ * and fills each row span with SIMD (AVX2 or SSE2, chosen at runtime) or a
+ * scalar fallback. Pixels whose centers fall inside are covered; shared edges
+ * follow the top-left rule so adjacent triangles never overlap.
+ * 
+ * @param surface 32-bit destination surface; its clip rect is honoured
+ * @param x0 First vertex X coordinate
+ * @param y0 First vertex Y coordinate
+ * @param x1 Second vertex X coordinate
+ * @param y1 Second vertex Y coordinate
+ * @param x2 Third vertex X coordinate
+ * @param y2 Third vertex Y coordinate
+ * @param color RGBA color; alpha below 255 is blended src-over
+ * 
+ * @note Locks the surface if required
+ */
+void a_DrawSurfaceFilledTriangle( SDL_Surface* surface, const int x0, const int y0,
+                                  const int x1, const int y1, const int x2, const int y2,
+                                  const aColor_t color );
+
+/**
+ * @brief Rasterize a filled convex polygon directly into a surface on the CPU
+ * 
+ * Fan-triangulates around the first point and rasterizes each triangle with
+ * a_DrawSurfaceFilledTriangle()'s rules; interior fan edges are filled once.
+ * 
+ * @param surface 32-bit destination surface; its clip rect is honoured
+ * @param points Polygon vertices in order (either winding), 1/16 pixel precision
+ * @param count Number of vertices (at least 3)
+ * @param color RGBA color; alpha below 255 is blended src-over
+ */
+void a_DrawSurfaceFilledPolygon( SDL_Surface* surface, const aPoint2f_t* points,
+                                 const int count, const aColor_t color );
+
+/**
+ * @brief Draw a rectangle outline
+ * 
+ * Renders the outline of a rectangle at the specified position and dimensions.
+ * 
+ * @param rect the rectangle to be drawn
+ * @param color (RGBA)
+ * 
+ */
+void a_DrawRect( const aRectf_t rect, const aColor_t color );
+
+/**
+ * @brief Draw a filled rectangle
+ * 
+ * Renders a completely filled rectangle at the specified position and dimensions.
+ * 
+ * @param rect the rectangle to be drawn
+ * @param color (RGBA)
+ * 
+ */
+void a_DrawFilledRect( const aRectf_t rect, const aColor_t color );
+
+/**
+ * @brief Render texture at position with original dimensions
+ *
+ * Renders texture at original size. For scaling, use a_BlitTextureRect().
+ *
+ * @param texture Texture to render
+ * @param x Screen X position
+ * @param y Screen Y position
+ *
+ * @note For scaling or clipping, use a_BlitTextureRect()
+ * @note Uses the size recorded in the image; the texture is never queried
+ */
+void a_Blit( aImage_t* img, int x, int y );
+
+/**
+ * @brief Render texture with scaling
+ *
+ * Renders texture at specified position and size with scaling factor.
+ * Matches the signature of a_BlitSurfaceRect() for consistency.
+ *
+ * @param texture Texture to render
+ * @param rect Destination rectangle (x, y, w, h)
+ * @param scale Scaling factor for the destination size
+ *
+ * @note src is relative to the image; NULL src copies the whole image and,
+ *       for images that own their texture, skips the source rect entirely
+ * @note NULL dest draws at (0,0) with the image's recorded size
+ */
+void a_BlitRect( aImage_t* img, aRectf_t* src, aRectf_t* dest, const float scale );
+
+/**
+ * @brief Blit an image's surface onto another image's surface, upscaled
+ *
+ * Nearest-neighbour integer upscale through a_BlitSurfaceScaled().
+ *
+ * @param src Image whose surface is drawn
+ * @param dest Image whose surface is drawn to
+ * @param dest_rect Position of the scaled image; a non-zero w/h also clips
+ *                  the blit to that area
+ * @param scale Integer scale factor (values below 1 draw unscaled)
+ *
+ * @note Only the surface changes; push it to the GPU with a_ImageUploadRect()
+ * @note Dropped surfaces are decoded again through a_ImageGetSurface()
+ */
+void a_BlitSurfaceToSurfaceScaled( aImage_t* src, aImage_t* dest,
+                                   aRectf_t dest_rect, int scale );
+
+/**
+ * @brief Nearest-neighbour integer upscale from one surface to another
+ *
+ * Each source row is widened once with SIMD (AVX2 for factors up to 8,
+ * SSE2 for 2x/3x/4x) and then written to all `scale` destination rows.
+ * Honours the destination clip rect; sources with SDL_BLENDMODE_BLEND and
+ * an alpha channel are composited src-over like SDL_BlitSurface(), even
+ * onto destinations without alpha. Anything else is copied.
+ *
+ * @param src Source surface, converted to the destination's channel order if needed
+ * @param src_rect Region of src to draw, or NULL for all of it
+ * @param dest 32-bit destination surface
+ * @param x Destination X of the scaled region's top-left corner
+ * @param y Destination Y of the scaled region's top-left corner
+ * @param scale Integer scale factor (values below 1 draw unscaled)
+ * @return 0 on success, 1 on failure
+ */
+int a_BlitSurfaceScaled( SDL_Surface* src, const SDL_Rect* src_rect, SDL_Surface* dest,
+                         const int x, const int y, const int scale );
+
+/**
+ * @brief Create an integer-upscaled copy of a surface
+ *
+ * @param src Surface to scale; non-32-bit surfaces come back as ARGB8888
+ * @param scale Integer scale factor, at least 1
+ * @return New surface of src->w * scale by src->h * scale, or NULL on failure
+ */
+SDL_Surface* a_SurfaceScale( SDL_Surface* src, const int scale );
+
+/**
+ * Update the window title text
+ *
+ * Changes the text displayed in the window's title bar
+ *
+ * @param title Source of new Title
+ *
+ */
+void a_UpdateTitle( const char *title );
+
+/**
+ * @brief Write a single pixel to a surface
+ *
+ * The color is mapped through the surface's own pixel format.
+ *
+ * @param surface Destination surface
+ * @param x Pixel X coordinate
+ * @param y Pixel Y coordinate
+ * @param c Color to store (alpha is stored, not blended)
+ *
+ * @note Locks the surface for every call; open an aPixels_t session with
+ *       a_PixelsBegin() for anything more than a handful of pixels
+ */
+void a_SetPixel( SDL_Surface *surface, int x, int y, aColor_t c );
+
+/*
+---------------------------------------------------------------
+---                         Pixels                          ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Start a bulk editing session on a surface
+ *
+ * Locks the surface once (if it needs locking) for every write that
+ * follows. All session writes honour the surface's pixel format and clip
+ * rect and grow `px->dirty`, ready for a_ImageUploadRect().
+ *
+ * @param px Session to initialise
+ * @param surface Surface to edit
+ * @return 0 on success, 1 if the surface could not be locked
+ */
+int a_PixelsBegin( aPixels_t* px, SDL_Surface* surface );
+
+/**
+ * @brief End a session and unlock its surface
+ *
+ * @param px Session to close; `dirty` is kept for the upload
+ */
+void a_PixelsEnd( aPixels_t* px );
+
+/**
+ * @brief Map a color to the session surface's pixel format
+ *
+ * @param px Open session
+ * @param color Color to map
+ * @return Pixel value, suitable for a_PixelsCopySpan() source buffers
+ */
+uint32_t a_PixelsMapColor( const aPixels_t* px, const aColor_t color );
+
+/**
+ * @brief Store one pixel
+ *
+ * @param px Open session
+ * @param x Pixel X coordinate
+ * @param y Pixel Y coordinate
+ * @param color Color to store (alpha is stored, not blended)
+ */
+void a_PixelsWrite( aPixels_t* px, const int x, const int y, const aColor_t color );
+
+/**
+ * @brief Store a run of colors along a row
+ *
+ * @param px Open session
+ * @param x First pixel X coordinate
+ * @param y Row
+ * @param colors One color per pixel
+ * @param count Number of pixels
+ */
+void a_PixelsWriteSpan( aPixels_t* px, const int x, const int y,
+                        const aColor_t* colors, const int count );
+
+/**
+ * @brief Fill part of a row with one color
+ *
+ * @param px Open session
+ * @param x First pixel X coordinate
+ * @param y Row
+ * @param count Number of pixels
+ * @param color Color to store (alpha is stored, not blended)
+ */
+void a_PixelsFillRow( aPixels_t* px, const int x, const int y, const int count,
+                      const aColor_t color );
+
+/**
+ * @brief Fill a rectangle with one color
+ *
+ * @param px Open session
+ * @param rect Rectangle in surface coordinates
+ * @param color Color to store (alpha is stored, not blended)
+ */
+void a_PixelsFillRect( aPixels_t* px, const aRecti_t rect, const aColor_t color );
+
+/**
+ * @brief Blend one color src-over part of a row
+ *
+ * @param px Open session
+ * @param x First pixel X coordinate
+ * @param y Row
+ * @param count Number of pixels
+ * @param color Color; its alpha is the blend factor
+ */
+void a_PixelsBlendRow( aPixels_t* px, const int x, const int y, const int count,
+                       const aColor_t color );
+
+/**
+ * @brief Blend one color src-over a rectangle
+ *
+ * @param px Open session
+ * @param rect Rectangle in surface coordinates
+ * @param color Color; its alpha is the blend factor
+ */
+void a_PixelsBlendRect( aPixels_t* px, const aRecti_t rect, const aColor_t color );
+
+/**
+ * @brief Copy raw pixels into a row
+ *
+ * @param px Open session
+ * @param x First pixel X coordinate
+ * @param y Row
+ * @param src Pixels already in the surface's format
+ * @param count Number of pixels
+ */
+void a_PixelsCopySpan( aPixels_t* px, const int x, const int y, const void* src, const int count );
+
+/**
+ * @brief Blend raw pixels src-over a row using their own alpha
+ *
+ * @param px Open session
+ * @param x First pixel X coordinate
+ * @param y Row
+ * @param src Pixels already in the surface's format
+ * @param count Number of pixels
+ *
+ * @note Surfaces without an alpha channel get a plain copy
+ */
+void a_PixelsBlendSpan( aPixels_t* px, const int x, const int y, const void* src, const int count );
+
+/**
+ * @brief Fill a 32-bit span (AVX2/SSE2/scalar, chosen at runtime)
+ *
+ * @param dst First pixel
+ * @param count Number of pixels
+ * @param pixel Value to store
+ */
+void a_PixelsFill32( uint32_t* dst, const int count, const uint32_t pixel );
+
+/**
+ * @brief Copy a 32-bit span; overlapping spans are allowed
+ *
+ * @param dst First destination pixel
+ * @param src First source pixel
+ * @param count Number of pixels
+ */
+void a_PixelsCopy32( uint32_t* dst, const uint32_t* src, const int count );
+
+/**
+ * @brief Blend one pixel value src-over a 32-bit 8888 span
+ *
+ * @param dst First pixel
+ * @param count Number of pixels
+ * @param pixel Mapped color with its alpha byte (if any) set to 255
+ * @param alpha Blend factor
+ */
+void a_PixelsBlendColor32( uint32_t* dst, const int count, const uint32_t pixel, const uint8_t alpha );
+
+/**
+ * @brief Blend a 32-bit 8888 span src-over another using per-pixel alpha
+ *
+ * @param dst First destination pixel
+ * @param src First source pixel, same layout as dst
+ * @param count Number of pixels
+ * @param alpha_shift Bit position of the alpha byte (SDL_PixelFormat::Ashift)
+ */
+void a_PixelsBlend32( uint32_t* dst, const uint32_t* src, const int count, const int alpha_shift );
+
+/*
+---------------------------------------------------------------
+---                          Image                          ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Initialize the image cache system
+ *
+ * Allocates the image cache, a hash table keyed by file path that grows
+ * as images are added, and prepares it for use.
+ * Must be called before any image loading operations.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int a_ImageInit( void );
+
+/**
+ * @brief Load an image from disk with automatic caching
+ *
+ * Loads an SDL_Surface from the specified file path. If the image
+ * has been loaded before, returns the cached version instead of
+ * reloading from disk; a repeat load costs one hash probe.
+ *
+ * Every successful load takes a reference; hand it back with
+ * a_ImageRelease() once the image is no longer drawn.
+ *
+ * @param filename Path to the image file to load
+ * @return Pointer to SDL_Surface, or NULL on failure
+ */
+aImage_t* a_ImageLoad( const char *filename );
+
+/**
+ * @brief Load an image from disk with load flags
+ *
+ * Same as a_ImageLoad(), but IMAGE_LOAD_ATLAS packs images up to
+ * ATLAS_MAX_IMAGE_SIZE on a side into a shared atlas page. Atlased images
+ * point at the page texture and their sub-rect in `rect`; the blit functions
+ * handle this transparently.
+ *
+ * @param filename Path to the image file to load
+ * @param flags Bitwise OR of aImageLoadFlags_t values
+ * @return Pointer to the cached image, or NULL on failure
+ *
+ * @note Flags only apply the first time a file is loaded
+ */
+aImage_t* a_ImageLoadEx( const char *filename, const int flags );
+
+/**
+ * @brief Register a set of images into the atlas up front
+ *
+ * Decodes every file, sorts them tallest first for tighter packing and
+ * loads them with IMAGE_LOAD_ATLAS. Prints page occupancy when done.
+ *
+ * @param filenames Array of image paths
+ * @param count Number of paths
+ * @return 0 on success, 1 if any image failed to load
+ */
+int a_ImageLoadAtlas( const char** filenames, const int count );
+
+/**
+ * @brief Wrap an already decoded surface in a cached aImage_t
+ *
+ * @param filename Cache key for the image
+ * @param surface Decoded surface; ownership passes to the image
+ * @param flags Bitwise OR of aImageLoadFlags_t values
+ * @return Pointer to the new image holding one reference, or NULL on failure
+ *
+ * @note If filename is already cached, an unreferenced image is replaced.
+ *       One still in use keeps its slot, and the new image stays out of
+ *       the cache until its last a_ImageRelease() frees it
+ */
+aImage_t* a_ImageCreate( const char* filename, SDL_Surface* surface, const int flags );
+
+/**
+ * @brief Load an image without blocking the frame
+ *
+ * Returns straight away with a cached image that acts as a placeholder:
+ * it has no texture, draws nothing and reports IMAGE_STATE_PENDING. A
+ * worker thread decodes the file; a_ImageAsyncUpdate() then uploads it
+ * on the main thread, within the per-frame upload budget, and fills the
+ * same aImage_t in place. A later a_ImageLoad() of the same file waits
+ * for it instead of decoding it twice.
+ *
+ * @param filename Path to the image file to load
+ * @param flags Bitwise OR of aImageLoadFlags_t values, applied at upload
+ * @param callback Called on the main thread once the image is ready or has
+ *                 failed, straight away if it already was; may be NULL
+ * @param user Passed through to callback
+ * @return The image holding one reference, or NULL on failure
+ */
+aImage_t* a_ImageLoadAsync( const char* filename, const int flags,
+                            aImageLoadCallback_t callback, void* user );
+
+/**
+ * @brief Check whether an a_ImageLoadAsync() image can be drawn yet
+ *
+ * @param img Image to check
+ * @return 1 once the image is uploaded, 0 while pending or if it failed
+ */
+int a_ImageIsReady( const aImage_t* img );
+
+/**
+ * @brief Upload images the workers have finished decoding
+ *
+ * Creates textures for decoded images, oldest first, until the per-frame
+ * upload budget is spent (at least one image always goes through), then
+ * runs their callbacks.
+ *
+ * @note Called automatically by a_PrepareScene()
+ */
+void a_ImageAsyncUpdate( void );
+
+/**
+ * @brief Set how many decoded bytes a_ImageAsyncUpdate() uploads per frame
+ *
+ * @param bytes Upload budget, 0 for no limit (default IMAGE_ASYNC_UPLOAD_BUDGET)
+ */
+void a_ImageAsyncSetUploadBudget( const size_t bytes );
+
+/**
+ * @brief Count asynchronous loads that haven't been uploaded yet
+ *
+ * @return Images queued, decoding or waiting for upload
+ */
+int a_ImageAsyncPending( void );
+
+/**
+ * @brief Stop the decode workers and drop any unfinished loads
+ *
+ * Images still pending stay in the cache as empty placeholders.
+ *
+ * @note Called automatically by a_Quit()
+ */
+void a_ImageAsyncCleanUp( void );
+
+/**
+ * @brief Decode a cached image's file again and swap the pixels in place
+ *
+ * The file is re-read from disk (never from a pack) on a loader thread and
+ * uploaded by a_ImageAsyncUpdate(). The aImage_t keeps its address, so
+ * sprites, animations and widgets pick the new pixels up on their next
+ * draw. An atlased image is rewritten in its slot when the size hasn't
+ * changed; otherwise it moves to a texture of its own. If the new file
+ * can't be decoded the old pixels stay.
+ *
+ * @param filename Path the image was loaded with
+ * @return 0 if a reload was queued, 1 if the image isn't cached and ready
+ *
+ * @note Called automatically by a_HotReloadPoll() for changed images
+ */
+int a_ImageReload( const char* filename );
+
+/**
+ * @brief Take another reference to a cached image
+ *
+ * An image with references is never evicted.
+ *
+ * @param img Image to reference, may be NULL
+ * @return img
+ */
+aImage_t* a_ImageAcquire( aImage_t* img );
+
+/**
+ * @brief Drop a reference taken by a_ImageLoad() or a_ImageAcquire()
+ *
+ * When the last reference goes the image stays cached but becomes an
+ * eviction candidate, least recently released first, whenever the cache
+ * is over its byte budget. Atlased images are kept until shutdown since
+ * their page space can't be handed back.
+ *
+ * @param img Image to release, may be NULL
+ */
+void a_ImageRelease( aImage_t* img );
+
+/**
+ * @brief Turn a source rect relative to an image into texture pixels
+ *
+ * @param img Image the rect belongs to
+ * @param src Source rect relative to the image, or NULL for the whole image
+ *
+ * @return The rect on img's texture, which is an atlas page for packed images
+ *
+ * @note Used by the engine wherever an image is sampled from a sub-rect
+ */
+aRectf_t a_ImageSourceRect( const aImage_t* img, const aRectf_t* src );
+
+/**
+ * @brief Set the byte budget for cached surfaces and textures
+ *
+ * Evicts unreferenced images straight away if the cache is already over.
+ * Referenced images can still push the total past the budget.
+ *
+ * @param bytes Budget in bytes, 0 for no limit (default IMAGE_CACHE_DEFAULT_BUDGET)
+ */
+void a_ImageCacheSetBudget( const size_t bytes );
+
+/**
+ * @brief Read the cache's counters and what it holds resident
+ *
+ * Hits and misses count a_ImageLoad*() calls; loads, decode_ms and
+ * upload_ms count the decodes that actually happened, on any thread.
+ *
+ * @param stats Filled with the current totals
+ */
+void a_ImageCacheGetStats( aImageCacheStats_t* stats );
+
+/**
+ * @brief Print the cache counters and every cached image to stdout
+ *
+ * Images are listed largest first with their surface and texture bytes,
+ * size, references, the frame they were last used on and their last
+ * decode and upload times. Big images that are rarely used are the ones
+ * to atlas, pack or let go.
+ *
+ * @param max_rows Most images to list, 0 for all of them
+ */
+void a_ImageCacheDump( const int max_rows );
+
+/**
+ * @brief Draw the cache counters and largest images as an on-screen table
+ *
+ * Same columns as a_ImageCacheDump(), in the code page 437 font over a
+ * dark panel. Call it last in the draw delegate so it sits on top.
+ *
+ * @param x Left edge of the panel
+ * @param y Top edge of the panel
+ * @param max_rows Most images to list, 0 for all of them
+ */
+void a_ImageCacheDrawStats( const int x, const int y, const int max_rows );
+
+/**
+ * @brief Decode an image file to a new surface
+ *
+ * Takes the pixels from a mounted asset pack when one holds the path,
+ * otherwise decodes the file with SDL_image. Safe to call from any thread.
+ *
+ * @param filename Path to the image file
+ * @return New surface the caller frees, or NULL on failure
+ */
+SDL_Surface* a_ImageDecode( const char* filename );
+
+/**
+ * @brief Get an image's CPU-side surface, decoding it again if it was dropped
+ *
+ * Images loaded with IMAGE_LOAD_DROP_SURFACE keep only their texture. The
+ * first CPU-side use reads the file back in and the surface stays until
+ * the image is evicted or the cache is cleaned up. Use img->rect for the
+ * image size instead of calling this just to read w/h.
+ *
+ * @param img Image to get the surface of
+ * @return The surface, or NULL if it can't be decoded
+ */
+SDL_Surface* a_ImageGetSurface( aImage_t* img );
+
+/**
+ * @brief Push a region of an image's surface to its texture
+ *
+ * Call after editing img->surface (e.g. with a_Pixels* and the session's
+ * dirty rect). Converts the region if the texture uses a different pixel
+ * format, and offsets into the page for atlased images.
+ *
+ * @param img Image with both a surface and a texture
+ * @param rect Region in image coordinates, or NULL for the whole image
+ * @return 0 on success, 1 on failure
+ */
+int a_ImageUploadRect( aImage_t* img, const aRecti_t* rect );
+
+/**
+ * @brief Clean up and free all cached images
+ *
+ * Frees every cached image along with its surface and texture, then
+ * empties the table. Should be called during shutdown.
+ *
+ * @return 0 on success, 1 if cache is NULL
+ */
+int a_ImageCacheCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                          Atlas                          ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Pack an image's surface into an atlas page
+ *
+ * Finds room with a skyline bottom-left packer, uploads the pixels once and
+ * points the image at the page texture and sub-rect.
+ *
+ * @param img Image with a valid surface and no texture yet
+ * @return 0 on success, 1 if the image is too large or no page has room
+ */
+int a_AtlasAddImage( aImage_t* img );
+
+/**
+ * @brief Report atlas page count and occupancy
+ *
+ * @param stats Filled with the current page statistics
+ */
+void a_AtlasGetStats( aAtlasStats_t* stats );
+
+/**
+ * @brief Print atlas page count and per-page occupancy to stdout
+ */
+void a_AtlasPrintStats( void );
+
+/**
+ * @brief Destroy all atlas page textures
+ *
+ * @note Called automatically by a_Quit() after the image cache is freed
+ */
+void a_AtlasCleanUp( void );
+
+/**
+ * @brief Capture the current renderer contents to a PNG file
+ *
+ * Reads pixels from the renderer and saves them as a PNG image
+ * to the specified filename.
+ *
+ * @param renderer The SDL renderer to capture from
+ * @param filename Path where the PNG file should be saved
+ * @return 1 on success, 0 on failure
+ */
+int a_ScreenshotSave( SDL_Renderer *renderer, const char *filename );
+
+/**
+ * @brief Read the current render output into a new surface
+ *
+ * Works with a window or headless; use it for benchmarks and golden-image
+ * comparisons.
+ *
+ * @return New ARGB8888 surface the caller must free, or NULL on failure
+ */
+SDL_Surface* a_FramebufferCapture( void );
+
+/*
+---------------------------------------------------------------
+---                       Asset Pack                        ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Map a pack built by a_PackWrite() and serve its images
+ *
+ * Once mounted, a_ImageLoad(), a_ImageLoadAsync() and PNG fonts read
+ * packed paths straight from the pack instead of decoding the file.
+ * Later mounts take precedence over earlier ones. Mount packs before
+ * loading anything that should come from them.
+ *
+ * @param filename Path of the .apak file
+ * @return 0 on success, 1 if the pack can't be opened or is malformed
+ */
+int a_PackMount( const char* filename );
+
+/**
+ * @brief Check whether a mounted pack holds a path
+ *
+ * @param path Image path, exactly as it was given to a_PackWrite()
+ * @return 1 if packed, 0 otherwise
+ */
+int a_PackContains( const char* path );
+
+/**
+ * @brief Make a surface from a packed image
+ *
+ * Uncompressed blocks are wrapped in place with no copy; compressed ones
+ * are expanded into a new surface. Safe to call from loader threads.
+ *
+ * @param path Image path, exactly as it was given to a_PackWrite()
+ * @return New surface the caller frees, or NULL if no pack holds the path
+ */
+SDL_Surface* a_PackLoadSurface( const char* path );
+
+/**
+ * @brief Decode images and bake them into an asset pack
+ *
+ * Pixels are converted to the renderer's native ARGB8888 and stored
+ * under the paths exactly as given, so pass the same strings the game
+ * loads. Duplicate paths are stored once.
+ *
+ * @param filename Pack to create
+ * @param paths Image files to pack
+ * @param count Number of paths
+ * @param flags PACK_WRITE_COMPRESS to LZ-compress blocks that shrink
+ * @return 0 on success, 1 if any image or the pack couldn't be written
+ */
+int a_PackWrite( const char* filename, const char** paths, const int count, const int flags );
+
+/**
+ * @brief Unmap every mounted pack
+ *
+ * @note Called automatically by a_Quit() after the image cache is freed,
+ *       since uncompressed images point into the mapping
+ */
+void a_PackCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                        Hot Reload                       ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Start watching asset files for changes (Linux only)
+ *
+ * Watches the directories of every cached image and registered file,
+ * including those registered before this call. Changed images are
+ * reloaded with a_ImageReload(); other files run their callback. Meant
+ * for development builds.
+ *
+ * @return 0 on success, 1 if inotify isn't available
+ */
+int a_HotReloadInit( void );
+
+/**
+ * @brief Register a file to be reloaded when it changes on disk
+ *
+ * Registrations made before a_HotReloadInit() are kept until it runs.
+ * Registering the same path, callback and user again does nothing.
+ *
+ * @param path File to watch, spelled the way it is loaded
+ * @param callback Called on the main thread from a_HotReloadPoll(); NULL
+ *                 only watches the file's directory, which is all a cached
+ *                 image needs
+ * @param user Passed through to callback
+ * @return 0 on success, 1 if the watch tables are full
+ */
+int a_HotReloadWatch( const char* path, aHotReloadCallback_t callback, void* user );
+
+/**
+ * @brief Reload whatever changed on disk since the last poll
+ *
+ * When nothing has changed this is a single non-blocking read. Each path
+ * is handled once per poll however many events a save produced.
+ *
+ * @note Called automatically by a_PrepareScene()
+ */
+void a_HotReloadPoll( void );
+
+/**
+ * @brief Stop watching and forget every registered file
+ *
+ * @note Called automatically by a_Quit()
+ */
+void a_HotReloadCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                         Preload                         ---
+---------------------------------------------------------------
+*/
+
+#define PRELOAD_MAX_WORKERS 4
+
+typedef enum
+{
+  PRELOAD_IMAGE,
+  PRELOAD_SOUND,
+  PRELOAD_WIDGETS
+} aPreloadType_t;
+
+typedef enum
+{
+  PRELOAD_PENDING,
+  PRELOAD_DONE,
+  PRELOAD_FAILED
+} aPreloadState_t;
+
+typedef struct _aPreload_t aPreload_t;
+
+typedef struct
+{
+  char path[MAX_FILENAME_LENGTH];
+  int type;               // aPreloadType_t
+  int state;              // aPreloadState_t
+  float decode_ms;        // Reading and decoding; 0 for images that were already cached
+  float upload_ms;        // Main-thread work: texture upload or widget creation
+  float done_ms;          // When it finished, counted from a_Preload()
+  aImage_t* image;        // PRELOAD_IMAGE; one reference held until a_PreloadFree()
+  aSoundEffect_t sound;   // PRELOAD_SOUND; owned until a_PreloadTakeSound()
+  aPreload_t* preload;    // Owner, for the image loader callback
+} aPreloadAsset_t;
+
+typedef void ( *aPreloadProgress_t )( aPreload_t* preload, aPreloadAsset_t* asset, void* user );
+
+struct _aPreload_t
+{
+  aPreloadAsset_t* assets;
+  int count;
+  int done;               // Finished or failed, each reported once to progress
+  int failed;
+  float total_ms;         // Set once everything is done
+  aPreloadProgress_t progress;
+  void* user;
+
+  Uint64 start;
+  int queueing;           // Inside a_Preload(), where cached images finish immediately
+  int widgets_left;       // Widget files wait for the images they reference
+
+  SDL_Thread* workers[PRELOAD_MAX_WORKERS];
+  int worker_count;
+  SDL_atomic_t next;      // Next asset index a worker claims
+  SDL_atomic_t cancel;
+  SDL_mutex* lock;
+  int* finished;          // Sounds the workers are done with (-1 - index if failed), guarded by lock
+  int finished_count;
+  int finished_read;      // Main thread's place in finished
+};
+
+/**
+ * @brief Load a level's images, sounds and widget files in one go
+ *
+ * The manifest is either an .auf file whose sections list paths by kind:
+ *
+ *   [PRELOAD.level1]
+ *   images:["resources/assets/a.png","resources/assets/b.png"]
+ *   sounds:["resources/soundeffects/hit.wav"]
+ *   widgets:["resources/widgets/world.auf"]
+ *
+ * or a plain text file with one path per line (blank lines and lines
+ * starting with '#' are skipped), sorted by extension. Every file is
+ * handed to the kernel for read-ahead up front. Images decode on the
+ * image loader threads and upload under a_ImageAsyncUpdate()'s budget;
+ * sounds decode on preload threads. Widget files are applied with
+ * a_WidgetsInit() last, in manifest order, once their images are in.
+ *
+ * @param manifest Path of the .auf or plain list
+ * @param image_flags aImageLoadFlags_t applied to every image
+ * @param progress Called on the main thread as each asset finishes; may be NULL
+ * @param user Passed through to progress
+ * @return New preload to drive with a_PreloadUpdate(), or NULL on failure
+ */
+aPreload_t* a_Preload( const char* manifest, const int image_flags,
+                       aPreloadProgress_t progress, void* user );
+
+/**
+ * @brief Same as a_Preload(), from a list of paths instead of a file
+ *
+ * @param paths Files to load, kind taken from the extension
+ * @param count Number of paths
+ * @param image_flags aImageLoadFlags_t applied to every image
+ * @param progress Called on the main thread as each asset finishes; may be NULL
+ * @param user Passed through to progress
+ * @return New preload to drive with a_PreloadUpdate(), or NULL on failure
+ */
+aPreload_t* a_PreloadList( const char** paths, const int count, const int image_flags,
+                           aPreloadProgress_t progress, void* user );
+
+/**
+ * @brief Collect finished sounds and apply widget files; call once a frame
+ *
+ * Images report in from a_PrepareScene() on their own; this handles the
+ * rest. `preload->done` out of `preload->count` drives a loading bar.
+ *
+ * @param preload Preload to advance
+ * @return 1 once every asset has finished or failed, 0 otherwise
+ */
+int a_PreloadUpdate( aPreload_t* preload );
+
+/**
+ * @brief Block until every asset in the preload has finished
+ *
+ * Uploads outstanding images right away, ignoring the per-frame budget.
+ *
+ * @param preload Preload to finish
+ * @return 0 if everything loaded, 1 if any asset failed
+ */
+int a_PreloadWait( aPreload_t* preload );
+
+/**
+ * @brief Take ownership of a preloaded sound
+ *
+ * @param preload Preload holding the sound
+ * @param filename Path as listed in the manifest
+ * @param sound Receives the sound; free it with a_AudioFreeSound()
+ * @return 0 on success, 1 if the sound isn't loaded or was already taken
+ */
+int a_PreloadTakeSound( aPreload_t* preload, const char* filename, aSoundEffect_t* sound );
+
+/**
+ * @brief Print each asset's decode, upload and finish times, slowest first
+ *
+ * @param preload Preload to report on
+ * @param max_rows Rows to print, 0 for all
+ */
+void a_PreloadReport( const aPreload_t* preload, const int max_rows );
+
+/**
+ * @brief Finish, then free a preload
+ *
+ * Drops the preload's image references (the images stay cached until
+ * evicted, so a_ImageLoad() them first to keep them) and frees sounds that
+ * weren't taken.
+ *
+ * @param preload Preload to free, may be NULL
+ */
+void a_PreloadFree( aPreload_t* preload );
+
+/*
+---------------------------------------------------------------
+---                         Capture                         ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Queue a screenshot of the current render output
+ *
+ * Reads the output back into a pre-allocated surface and returns; a
+ * worker thread does the encoding and the file write. Files ending in
+ * ".qoi" are written as QOI, anything else as PNG.
+ *
+ * @param filename Path where the image should be saved
+ * @return 0 if the capture was queued, 1 if it failed or was dropped
+ *
+ * @note Call before a_PresentScene(); the back buffer is undefined after
+ *       presenting
+ */
+int a_CaptureScreenshot( const char* filename );
+
+/**
+ * @brief Dump the next frames as a numbered image sequence
+ *
+ * Every a_PresentScene() captures one frame to "<prefix>000000.png",
+ * "<prefix>000001.png" and so on until frames have been written.
+ *
+ * @param prefix Path prefix for the sequence, e.g. "capture/frame_"
+ * @param frames Number of frames to record
+ * @param format CAPTURE_FORMAT_PNG or CAPTURE_FORMAT_QOI
+ * @return 0 on success, 1 on invalid arguments
+ *
+ * @note Frames dropped because the encoder fell behind are not numbered,
+ *       so the sequence has no gaps but may skip game frames
+ */
+int a_CaptureRecordStart( const char* prefix, const int frames, const int format );
+
+/**
+ * @brief Stop a recording started with a_CaptureRecordStart()
+ *
+ * @note Frames already captured are still written
+ */
+void a_CaptureRecordStop( void );
+
+/**
+ * @brief Check whether a recording is in progress
+ *
+ * @return 1 while frames are being recorded, 0 otherwise
+ */
+int a_CaptureIsRecording( void );
+
+/**
+ * @brief Capture this frame if a recording is in progress
+ *
+ * @note Called automatically by a_PresentScene()
+ */
+void a_CaptureFrame( void );
+
+/**
+ * @brief Number of captures waiting for the encoder
+ *
+ * @return Captures queued or being encoded; a value that keeps climbing
+ *         means the encoder is falling behind
+ */
+int a_CaptureBacklog( void );
+
+/**
+ * @brief Read the capture pipeline counters
+ *
+ * @param stats Filled with the backlog, ring capacity, files written and
+ *              captures dropped
+ */
+void a_CaptureGetStats( aCaptureStats_t* stats );
+
+/**
+ * @brief Finish pending captures and free the capture ring
+ *
+ * @note Called automatically by a_Quit(); blocks until queued files are written
+ */
+void a_CaptureCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                       Initialize                        ---
+---------------------------------------------------------------
+*/
+
+extern aApp_t app;
+
+/**
+ * @brief Initialize the Archimedes framework and SDL subsystems
+ * 
+ * Sets up SDL (video, audio, timer), IMG (PNG support), TTF (font rendering),
+ * creates the window and renderer, and initializes the global app state including
+ * mouse tracking, timing system, image cache, and RNG seeding.
+ * 
+ * Must be called before any other Archimedes functions.
+ * 
+ * @param width Window width in pixels (must be > 0)
+ * @param height Window height in pixels (must be > 0)
+ * @param title Window title string (must not be NULL)
+ * @return InitStatus_t error code:
+ *         - INIT_SUCCESS (0): Initialization successful
+ *         - INIT_ERROR_SDL (-1): SDL subsystem initialization failed
+ *         - INIT_ERROR_IMG (-2): SDL_image initialization failed
+ *         - INIT_ERROR_TTF (-3): SDL_ttf initialization failed
+ *         - INIT_ERROR_WINDOW (-4): Window/renderer creation failed
+ * 
+ * @note Populates global `app` structure with initialized state
+ * @note Automatically cleans up subsystems on failure
+ * @see a_Quit()
+ */
+int a_Init( const int width, const int height, const char *title );
+
+/**
+ * @brief Initialize the framework with explicit options
+ * 
+ * Same as a_Init(), plus window flags and a headless mode for machines
+ * without a display or GPU. Headless runs use SDL's dummy video and audio
+ * drivers (unless SDL_VIDEODRIVER / SDL_AUDIODRIVER are already set, e.g.
+ * to "offscreen") and a software renderer that draws into
+ * `app.framebuffer`; `app.window` stays NULL.
+ * 
+ * @param options Window size, title, flags and headless switch
+ * @return Same InitStatus_t codes as a_Init()
+ * 
+ * @note Read frames back with a_FramebufferCapture() or straight from
+ *       app.framebuffer after a_PresentScene()
+ */
+int a_InitEx( const aInitOptions_t* options );
+
+/**
+ * @brief Cleans up all Archimedes resources and shuts down SDL.
+ *
+ * This function performs complete cleanup of the Archimedes framework by
+ * calling the optional onExit delegate callback, destroying the renderer
+ * and window, cleaning up the image cache, and shutting down SDL subsystems.
+ * Should be called before program termination to ensure proper resource cleanup.
+ *
+ * The cleanup sequence includes:
+ * - Calling the optional onExit delegate callback if set
+ * - Destroying the SDL renderer
+ * - Destroying the SDL window
+ * - Cleaning up the image cache and freeing memory
+ * - Shutting down TTF, IMG, and SDL subsystems
+ * - Resetting the app running state
+ */
+void a_Quit( void );
+
+
+/*
+---------------------------------------------------------------
+---                          Input                          ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Processes all pending SDL events and dispatches them to appropriate handlers.
+ *
+ * This function continuously polls for SDL events (keyboard, mouse, quit, text input)
+ * using `SDL_PollEvent` and dispatches them to internal static functions (`a_DoKeyDown`,
+ * `a_DoKeyUp`, `a_DoMouseDown`, `a_DoMouseUp`, `a_DoMouseWheel`, `a_DoMouseMotion`).
+ * It updates the global `app` state based on these events, managing the game's input.
+ * Unknown event types are silently ignored.
+ *
+ */
+void a_DoInput( void );
+
+/*
+---------------------------------------------------------------
+---                     Render State                        ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Set the renderer draw color, skipping the SDL call if it is unchanged
+ * 
+ * @param color Color used by SDL_RenderClear and the primitive queue flush
+ * 
+ * @note app.render_state.skipped / applied count elided and issued changes
+ */
+void a_RenderStateSetDrawColor( const aColor_t color );
+
+/**
+ * @brief Set the renderer draw blend mode, skipping the SDL call if it is unchanged
+ * 
+ * @param mode SDL blend mode for untextured drawing
+ */
+void a_RenderStateSetBlendMode( const SDL_BlendMode mode );
+
+/**
+ * @brief Set a texture's color modulation, skipping the SDL call if it is unchanged
+ * 
+ * @param texture Texture to modulate
+ * @param r Red modulation (0-255)
+ * @param g Green modulation (0-255)
+ * @param b Blue modulation (0-255)
+ */
+void a_RenderStateSetTextureColorMod( SDL_Texture* texture, const uint8_t r,
+                                      const uint8_t g, const uint8_t b );
+
+/**
+ * @brief Set a texture's alpha modulation, skipping the SDL call if it is unchanged
+ * 
+ * @param texture Texture to modulate
+ * @param a Alpha modulation (0-255)
+ */
+void a_RenderStateSetTextureAlphaMod( SDL_Texture* texture, const uint8_t a );
+
+/**
+ * @brief Set a texture's blend mode, skipping the SDL call if it is unchanged
+ * 
+ * @param texture Texture whose blend mode is set
+ * @param mode Blend mode used when the texture is drawn
+ */
+void a_RenderStateSetTextureBlendMode( SDL_Texture* texture, const SDL_BlendMode mode );
+
+/**
+ * @brief Get a texture's blend mode, asking SDL only if it isn't cached yet
+ * 
+ * @param texture Texture to query
+ * @return The texture's blend mode, or SDL_BLENDMODE_NONE for NULL
+ */
+SDL_BlendMode a_RenderStateGetTextureBlendMode( SDL_Texture* texture );
+
+/**
+ * @brief Drop everything the shadow state knows about the renderer
+ * 
+ * Call this after changing renderer or texture state with raw SDL calls,
+ * after switching render targets, or after recreating the renderer, so the
+ * next setter call reaches SDL.
+ */
+void a_RenderStateInvalidate( void );
+
+/**
+ * @brief Forget the cached modulation and blend mode of a texture that is about to be destroyed
+ * 
+ * Prevents a new texture allocated at the same address from inheriting
+ * stale modulation or blend mode values.
+ * 
+ * @param texture Texture being destroyed
+ */
+void a_RenderStateForgetTexture( SDL_Texture* texture );
+
+/*
+---------------------------------------------------------------
+---                      Render Stats                       ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Read the counters of the last presented frame
+ *
+ * Counters reset in a_PrepareScene() and are snapshotted in
+ * a_PresentScene().
+ *
+ * @param stats Filled with the last frame's counters (zeros when disabled)
+ * @return 0 on success, 1 if the engine was built without
+ *         ARCHIMEDES_RENDER_STATS
+ */
+int a_RenderStatsGet( aRenderStats_t* stats );
+
+/**
+ * @brief Reset the counters for a new frame
+ *
+ * @note Called automatically by a_PrepareScene()
+ */
+void a_RenderStatsBegin( void );
+
+/**
+ * @brief Snapshot the counters of the frame being presented
+ *
+ * @note Called automatically by a_PresentScene()
+ */
+void a_RenderStatsEnd( void );
+
+/**
+ * @brief Get the counters of the frame being drawn
+ *
+ * @return The live counters; scratch space nobody reads when the engine
+ *         was built without ARCHIMEDES_RENDER_STATS
+ *
+ * @note Used by the engine through RENDER_STATS_ADD()
+ */
+aRenderStats_t* a_RenderStatsCounters( void );
+
+/**
+ * @brief Count one draw call and detect texture changes
+ *
+ * @param texture Texture sampled by the call, or NULL for untextured draws
+ * @param vertices Vertices submitted by the call
+ *
+ * @note Used by the engine through RENDER_STATS_DRAW()
+ */
+void a_RenderStatsDraw( SDL_Texture* texture, const int vertices );
+
+/*
+---------------------------------------------------------------
+---                          Layer                          ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Create an offscreen layer for content that rarely changes
  * 
- * @param x1 Starting X coordinate
- * @param y1 Starting Y coordinate
- * @param x2 Ending X coordinate
- * @param y2 Ending Y coordinate
- * @param color RGBA color structure for the line
+ * Layers start dirty. Typical use:
+ * @code
+ * if ( a_LayerBegin( hud ) )
+ * {
+ *   a_DrawFilledRect( ... );   // coordinates are relative to the layer
+ *   a_DrawText( ... );
+ *   a_LayerEnd( hud );
+ * }
+ * a_BlitLayer( hud, 0, 0 );
+ * @endcode
  * 
+ * @param w Layer width in pixels
+ * @param h Layer height in pixels
+ * @return New layer, or NULL if render targets are unsupported or creation failed
  */
-void a_DrawLine( const int x1, const int y1, const int x2, const int y2, const aColor_t color );
+aLayer_t* a_LayerCreate( const int w, const int h );
 
 /**
- * @brief Draw a horizontal line
- * 
- * Renders a horizontal line between two X coordinates at a fixed Y position.
+ * @brief Destroy a layer and its texture
  * 
- * @param x1 Starting X coordinate
- * @param x2 Ending X coordinate
- * @param y Y coordinate (same for both endpoints)
- * @param color RGBA color structure for the line
- * 
- * @note Optimized for horizontal lines
- * @note Order of x1 and x2 doesn't matter (automatically handles swapping)
+ * @param layer Layer to destroy (NULL is ignored)
  */
-void a_DrawHorizontalLine( const int x1, const int x2, const int y, const aColor_t color );
+void a_LayerDestroy( aLayer_t* layer );
 
 /**
- * @brief Draw a vertical line
- * 
- * Renders a vertical line between two Y coordinates at a fixed X position.
+ * @brief Mark a layer for redrawing
  * 
- * @param y1 Starting Y coordinate
- * @param y2 Ending Y coordinate
- * @param x X coordinate (same for both endpoints)
- * @param color RGBA color structure for the line
+ * The next a_LayerBegin() on it returns 1.
  * 
- * @note Order of y1 and y2 doesn't matter (automatically handles swapping)
+ * @param layer Layer whose content changed
  */
-void a_DrawVerticalLine( const int y1, const int y2, const int x, const aColor_t color );
+void a_LayerInvalidate( aLayer_t* layer );
 
 /**
- * @brief Draw a circle outline
- * 
- * Renders the outline of a circle at the specified center position with the given radius.
- * Uses Bresenham's circle algorithm for efficient pixel-perfect circle drawing.
+ * @brief Mark every layer for redrawing
  * 
- * @param posX Center X coordinate
- * @param posY Center Y coordinate
- * @param radius Circle radius in pixels
- * @param color RGBA color structure for the circle outline
+ * @note Called automatically on SDL_RENDER_TARGETS_RESET
  */
-void a_DrawCircle( const int posX, const int posY, const int radius, const aColor_t color );
+void a_LayerInvalidateAll( void );
 
 /**
- * @brief Draw a filled circle
- * 
- * Renders a completely filled circle at the specified center position with the given radius.
- * Uses an optimized scan-line filling algorithm for smooth, solid circles.
- * 
- * @param posX Center X coordinate
- * @param posY Center Y coordinate
- * @param radius Circle radius in pixels
- * @param color RGBA color structure for the filled circle
+ * @brief Recreate every layer texture and mark them all for redrawing
  * 
+ * @note Called automatically on SDL_RENDER_DEVICE_RESET
  */
-void a_DrawFilledCircle( const int posX, const int posY, const int radius, const aColor_t color );
+void a_LayerRecreateAll( void );
 
 /**
- * @brief Draw a triangle outline
+ * @brief Start redrawing a layer if it is dirty
  * 
- * Renders the outline of a triangle by drawing three lines connecting the specified vertices.
+ * Flushes queued primitives, binds the layer as the render target and
+ * clears it to transparent. Every a_Draw*, a_Blit* and a_DrawText call
+ * until a_LayerEnd() lands in the layer.
  * 
- * @param x0 First vertex X coordinate
- * @param y0 First vertex Y coordinate
- * @param x1 Second vertex X coordinate
- * @param y1 Second vertex Y coordinate
- * @param x2 Third vertex X coordinate
- * @param y2 Third vertex Y coordinate
- * @param color RGBA color structure for the triangle outline
+ * @param layer Layer to draw into
+ * @return 1 if the layer was bound and must be redrawn, 0 if it is clean
  * 
- * @note Vertices can be specified in any order (clockwise or counter-clockwise)
+ * @note Layers do not nest; finish any sprite batch before calling
  */
-void a_DrawTriangle( const int x0, const int y0, const int x1, const int y1, const int x2,
-                     const int y2, const aColor_t color );
+int a_LayerBegin( aLayer_t* layer );
 
 /**
- * @brief Draw a filled triangle
- * 
- * Renders a completely filled triangle using the three specified vertices.
- * The implementation uses barycentric coordinate filling for accurate results.
- * 
- * @param x0 First vertex X coordinate
- * @param y0 First vertex Y coordinate
- * @param x1 Second vertex X coordinate
- * @param y1 Second vertex Y coordinate
- * @param x2 Third vertex X coordinate
- * @param y2 Third vertex Y coordinate
- * @param color RGBA color structure for the filled triangle
+ * @brief Finish redrawing a layer and restore the previous render target
  * 
- * @note Currently implementation is disabled
+ * @param layer Layer passed to the matching a_LayerBegin()
  */
-void a_DrawFilledTriangle( const int x0, const int y0, const int x1, const int y1,
-                           const int x2, const int y2, const aColor_t color );
+void a_LayerEnd( aLayer_t* layer );
 
 /**
- * @brief Draw a rectangle outline
- * 
- * Renders the outline of a rectangle at the specified position and dimensions.
- * 
- * @param rect the rectangle to be drawn
- * @param color (RGBA)
+ * @brief Composite a layer onto the current render target
  * 
+ * @param layer Layer to draw
+ * @param x Destination X of the layer's top-left corner
+ * @param y Destination Y of the layer's top-left corner
  */
-void a_DrawRect( const aRectf_t rect, const aColor_t color );
+void a_BlitLayer( aLayer_t* layer, const int x, const int y );
 
 /**
- * @brief Draw a filled rectangle
- * 
- * Renders a completely filled rectangle at the specified position and dimensions.
- * 
- * @param rect the rectangle to be drawn
- * @param color (RGBA)
+ * @brief Destroy every remaining layer
  * 
+ * @note Called automatically by a_Quit()
  */
-void a_DrawFilledRect( const aRectf_t rect, const aColor_t color );
+void a_LayerCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                        Particles                        ---
+---------------------------------------------------------------
+*/
 
 /**
- * @brief Render texture at position with original dimensions
+ * @brief Draw a set of square particles in one call
  *
- * Renders texture at original size. For scaling, use a_BlitTextureRect().
+ * Expands x[] / y[] into quads (four particles per SSE2 step), resolves
+ * colors and submits everything with a single SDL_RenderGeometryRaw()
+ * call. Solid particles use alpha blending; textured ones sample the
+ * same image region and use the texture's blend mode.
  *
- * @param texture Texture to render
- * @param x Screen X position
- * @param y Screen Y position
+ * @param particles Particle arrays and shared settings
  *
- * @note For scaling or clipping, use a_BlitTextureRect()
+ * @note Flushes queued primitives first so they stay underneath
  */
-void a_Blit( aImage_t* img, int x, int y );
+void a_DrawParticles( const aParticles_t* particles );
 
 /**
- * @brief Render texture with scaling
+ * @brief Free the particle vertex buffers
  *
- * Renders texture at specified position and size with scaling factor.
- * Matches the signature of a_BlitSurfaceRect() for consistency.
- *
- * @param texture Texture to render
- * @param rect Destination rectangle (x, y, w, h)
- * @param scale Scaling factor for the destination size
+ * @note Called automatically by a_Quit()
  */
-void a_BlitRect( aImage_t* img, aRectf_t* src, aRectf_t* dest, const float scale );
+void a_ParticlesCleanUp( void );
+
+/*
+---------------------------------------------------------------
+---                        Draw List                        ---
+---------------------------------------------------------------
+*/
 
 /**
- * @brief Blit a rectangular region of a surface to another surface
- *
- * @param surf Source SDL surface to draw from
- * @param dest Destination SDL surface to draw to
- * @param dest_rect Destination rect
- * @param scale Scaling factor for the destination size
+ * @brief Start recording draw commands for this frame
  *
+ * Commands recorded until a_DrawListEnd() are given a 64-bit sort key
+ * (layer, blend mode, texture, depth), radix-sorted once and submitted
+ * with one SDL_RenderGeometry() call per run of commands that share a
+ * texture and blend mode.
  */
-void a_BlitSurfaceToSurfaceScaled( aImage_t* src, aImage_t* dest,
-                                   aRectf_t dest_rect, int scale );
+void a_DrawListBegin( void );
 
 /**
- * Update the window title text
- *
- * Changes the text displayed in the window's title bar
- *
- * @param title Source of new Title
+ * @brief Check whether a draw list is currently recording
  *
+ * @return 1 between a_DrawListBegin() and a_DrawListEnd(), 0 otherwise
  */
-void a_UpdateTitle( const char *title );
-
-void a_SetPixel( SDL_Surface *surface, int x, int y, aColor_t c );
-
-/*
----------------------------------------------------------------
----                          Image                          ---
----------------------------------------------------------------
-*/
+int a_DrawListIsActive( void );
 
 /**
- * @brief Initialize the image cache system
+ * @brief Record a textured quad
  *
- * Allocates memory for the image cache and prepares it for use.
- * Must be called before any image loading operations.
+ * @param img Image whose texture is sampled
+ * @param src Source rect relative to the image, or NULL for the whole image
+ * @param dest Destination rect in screen pixels, or NULL for src size at (0,0)
+ * @param color Vertex color; multiplies the texture (use white for none)
+ * @param angle Clockwise rotation in degrees around the center of dest
+ * @param flip SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL and/or SDL_FLIP_VERTICAL
+ * @param layer Draw layer; lower layers are drawn first (-32768 to 32767)
+ * @param blend Blend mode the quad is drawn with
+ * @param depth Order within a layer, blend mode and texture (0 to 2^24 - 1)
  *
- * @return 0 on success, 1 on failure
+ * @note Commands with equal keys are drawn in the order they were recorded
  */
-int a_ImageInit( void );
+void a_DrawListSprite( aImage_t* img, const aRectf_t* src, const aRectf_t* dest,
+                       const aColor_t color, const float angle, const SDL_RendererFlip flip,
+                       const int layer, const SDL_BlendMode blend, const uint32_t depth );
 
 /**
- * @brief Load an image from disk with automatic caching
+ * @brief Record a solid colored rectangle
  *
- * Loads an SDL_Surface from the specified file path. If the image
- * has been loaded before, returns the cached version instead of
- * reloading from disk.
+ * @param rect Rectangle in screen pixels
+ * @param color Fill color
+ * @param layer Draw layer; lower layers are drawn first (-32768 to 32767)
+ * @param blend Blend mode the rectangle is drawn with
+ * @param depth Order within a layer and blend mode (0 to 2^24 - 1)
  *
- * @param filename Path to the image file to load
- * @return Pointer to SDL_Surface, or NULL on failure
+ * @note Untextured commands sort ahead of textured ones with the same
+ *       layer and blend mode
  */
-aImage_t* a_ImageLoad( const char *filename );
+void a_DrawListFilledRect( const aRectf_t rect, const aColor_t color, const int layer,
+                           const SDL_BlendMode blend, const uint32_t depth );
 
 /**
- * @brief Clean up and free all cached images
+ * @brief Sort and draw every command recorded since a_DrawListBegin()
  *
- * Frees all SDL_Surfaces stored in the image cache and resets
- * the cache structure. Should be called during shutdown.
+ * @return Number of SDL_RenderGeometry() calls issued
  *
- * @return 0 on success, 1 if cache is NULL
+ * @note Flushes queued primitives first so they stay underneath the list
  */
-int a_ImageCacheCleanUp( void );
+int a_DrawListEnd( void );
 
 /**
- * @brief Capture the current renderer contents to a PNG file
+ * @brief Free the draw list storage
  *
- * Reads pixels from the renderer and saves them as a PNG image
- * to the specified filename.
- *
- * @param renderer The SDL renderer to capture from
- * @param filename Path where the PNG file should be saved
- * @return 1 on success, 0 on failure
+ * @note Called automatically by a_Quit()
  */
-int a_ScreenshotSave( SDL_Renderer *renderer, const char *filename );
+void a_DrawListCleanUp( void );
 
 /*
 ---------------------------------------------------------------
----                       Initialize                        ---
+---                      Sprite Batch                       ---
 ---------------------------------------------------------------
 */
 
-extern aApp_t app;
-
 /**
- * @brief Initialize the Archimedes framework and SDL subsystems
+ * @brief Start collecting sprites for a batched draw
  * 
- * Sets up SDL (video, audio, timer), IMG (PNG support), TTF (font rendering),
- * creates the window and renderer, and initializes the global app state including
- * mouse tracking, timing system, image cache, and RNG seeding.
+ * Sprites submitted until a_SpriteBatchEnd() are held back, sorted and drawn
+ * with one SDL_RenderGeometry() call per run of sprites that share a texture.
+ */
+void a_SpriteBatchBegin( void );
+
+/**
+ * @brief Queue a sprite into the current batch
  * 
- * Must be called before any other Archimedes functions.
+ * @param img Image whose texture is sampled
+ * @param src Source rect in texture pixels, or NULL for the whole texture
+ * @param dest Destination rect in screen pixels, or NULL for src size at (0,0)
+ * @param color Vertex color; multiplies the texture (use white for none)
+ * @param angle Clockwise rotation in degrees around the center of dest
+ * @param flip SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL and/or SDL_FLIP_VERTICAL
+ * @param layer Draw layer; lower layers are drawn first
  * 
- * @param width Window width in pixels (must be > 0)
- * @param height Window height in pixels (must be > 0)
- * @param title Window title string (must not be NULL)
- * @return InitStatus_t error code:
- *         - INIT_SUCCESS (0): Initialization successful
- *         - INIT_ERROR_SDL (-1): SDL subsystem initialization failed
- *         - INIT_ERROR_IMG (-2): SDL_image initialization failed
- *         - INIT_ERROR_TTF (-3): SDL_ttf initialization failed
- *         - INIT_ERROR_WINDOW (-4): Window/renderer creation failed
+ * @note Within one layer, sprites are grouped by texture (in the order each
+ *       texture was first submitted) and keep submission order per texture
+ */
+void a_SpriteBatchSubmit( aImage_t* img, const aRectf_t* src, const aRectf_t* dest,
+                          const aColor_t color, const float angle,
+                          const SDL_RendererFlip flip, const int layer );
+
+/**
+ * @brief Sort and draw every sprite submitted since a_SpriteBatchBegin()
  * 
- * @note Populates global `app` structure with initialized state
- * @note Automatically cleans up subsystems on failure
- * @see a_Quit()
+ * @note Flushes queued primitives first so they stay underneath the batch
  */
-int a_Init( const int width, const int height, const char *title );
+void a_SpriteBatchEnd( void );
 
 /**
- * @brief Cleans up all Archimedes resources and shuts down SDL.
+ * @brief Write the four vertices of a textured quad
  *
- * This function performs complete cleanup of the Archimedes framework by
- * calling the optional onExit delegate callback, destroying the renderer
- * and window, cleaning up the image cache, and shutting down SDL subsystems.
- * Should be called before program termination to ensure proper resource cleanup.
+ * @param v Four vertices, top-left, top-right, bottom-right, bottom-left
+ * @param src Source rect in texture pixels
+ * @param tex_w Texture width, greater than 0
+ * @param tex_h Texture height, greater than 0
+ * @param dest Destination rect in screen pixels
+ * @param color Vertex color
+ * @param angle Clockwise rotation in degrees around the center of dest
+ * @param flip SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL and/or SDL_FLIP_VERTICAL
  *
- * The cleanup sequence includes:
- * - Calling the optional onExit delegate callback if set
- * - Destroying the SDL renderer
- * - Destroying the SDL window
- * - Cleaning up the image cache and freeing memory
- * - Shutting down TTF, IMG, and SDL subsystems
- * - Resetting the app running state
+ * @note Used by the engine for the sprite batch and the draw list
  */
-void a_Quit( void );
-
-
-/*
----------------------------------------------------------------
----                          Input                          ---
----------------------------------------------------------------
-*/
+void a_SpriteBatchQuad( SDL_Vertex* v, const aRectf_t src, const int tex_w, const int tex_h,
+                        const aRectf_t dest, const aColor_t color, const float angle,
+                        const int flip );
 
 /**
- * @brief Processes all pending SDL events and dispatches them to appropriate handlers.
+ * @brief Fill quad indices for quads first to last - 1
  *
- * This function continuously polls for SDL events (keyboard, mouse, quit, text input)
- * using `SDL_PollEvent` and dispatches them to internal static functions (`a_DoKeyDown`,
- * `a_DoKeyUp`, `a_DoMouseDown`, `a_DoMouseUp`, `a_DoMouseWheel`, `a_DoMouseMotion`).
- * It updates the global `app` state based on these events, managing the game's input.
- * Unknown event types are silently ignored.
+ * Each quad i is the two triangles (4i, 4i+1, 4i+2) and (4i, 4i+2, 4i+3),
+ * matching the vertex order written by a_SpriteBatchQuad().
  *
+ * @param indices Index buffer with room for at least last * 6 entries
+ * @param first First quad to fill
+ * @param last One past the last quad to fill
+ *
+ * @note Used by the engine when growing its quad index buffers
  */
-void a_DoInput( void );
+void a_SpriteBatchQuadIndices( int* indices, const int first, const int last );
+
+/**
+ * @brief Free the sprite batch storage
+ * 
+ * @note Called automatically by a_Quit()
+ */
+void a_SpriteBatchCleanUp( void );
 
 /*
 ---------------------------------------------------------------
@@ -1236,6 +2881,8 @@ SDL_Texture* a_GetTextTexture( char* text, int font_type );
  * - resources/fonts/font.png (32pt)
  *
  * If font loading fails, the program will exit with an error message.
+ * Each font file is registered with a_HotReloadWatch(); an edited font is
+ * rebuilt in place, and one that fails to load keeps its old glyphs.
  */
 void a_InitFonts( void );
 
@@ -1271,6 +2918,15 @@ int a_GetGlyphOrFallback(int font_type, unsigned int codepoint);
 */
 
 SDL_Texture* a_TextureLoad( const char* filename );
+
+/**
+ * @brief Upload a surface to a new texture on the app renderer
+ *
+ * @param surf Surface to upload
+ * @param destroy Non-zero to free the surface after uploading
+ * @return The new texture, or NULL on failure (the surface is still freed
+ *         when destroy is set)
+ */
 SDL_Texture* a_SurfaceToTexture( SDL_Surface* surf, int destroy );
 void a_TexturesInit( void );
 
@@ -1356,8 +3012,23 @@ aContainerWidget_t* a_GetContainerFromWidget( const char* name );
  * filename.
  *
  * @param filename The path to the file containing widget configuration data.
+ *
+ * @note The file is registered with a_HotReloadWatch(), which calls
+ *       a_WidgetsReload() when it changes.
  */
 void a_WidgetsInit( const char* filename );
+
+/**
+ * @brief Rebuild the widgets from their file, keeping what game code set
+ *
+ * Actions assigned after a_WidgetsInit() are carried over to the new
+ * widgets with the same name, as is app.active_widget. The widgets
+ * themselves are new, so fetch them again with a_GetWidget() rather than
+ * keeping old aWidget_t pointers.
+ *
+ * @param filename The path to the file containing widget configuration data.
+ */
+void a_WidgetsReload( const char* filename );
 int a_WidgetCacheFree( void );
 aWidget_t a_WidgetGetHeadWidget( void );
 
@@ -2080,5 +3751,77 @@ aAnimation_t* a_AnimationCreate( const char* filename, const float w,
 void a_AnimationFree( aAnimation_t* animation );
 void a_AnimationPlay( aPoint2f_t pos, aAnimation_t* animtion );
 
+/**
+ * @brief Create an animation from one defined in a sprite sheet
+ *
+ * The animation points into the sheet's frame table, so the sheet must
+ * outlive it. It takes its own reference to the sheet image.
+ *
+ * @param sheet Sheet from a_SpriteSheetLoad()
+ * @param name Name of an [ANIM.name] section in the sheet
+ * @return New animation, or NULL if the sheet has no such animation
+ */
+aAnimation_t* a_AnimationCreateFromSheet( aSpriteSheet_t* sheet, const char* name );
+
+/*
+---------------------------------------------------------------
+---                      Sprite Sheets                      ---
+---------------------------------------------------------------
+*/
+
+/**
+ * @brief Load a sprite sheet descriptor and its image
+ *
+ * The descriptor is an .auf file. A SHEET section names the image and
+ * lists its frames, one per line, as x, y, w, h on the image plus an
+ * optional pivot and trim offset, both in the untrimmed frame:
+ *
+ *   [SHEET.player]
+ *   image:"resources/assets/player.png"
+ *   idle_0:[0,0,24,32,12,31]
+ *   run_0:[24,0,20,30,12,31,2,2]
+ *
+ *   [ANIM.idle]
+ *   frames:["idle_0","idle_1"]
+ *   duration:120
+ *   loop:1
+ *
+ * Every rect and offset is worked out here once, so playing an
+ * animation is a table lookup.
+ *
+ * @param filename Path to the .auf descriptor
+ * @return New sprite sheet, or NULL on failure
+ */
+aSpriteSheet_t* a_SpriteSheetLoad( const char* filename );
+
+/**
+ * @brief Free a sprite sheet and release its image
+ *
+ * @param sheet Sheet to free, may be NULL
+ *
+ * @note Free animations created from the sheet first
+ */
+void a_SpriteSheetFree( aSpriteSheet_t* sheet );
+
+/**
+ * @brief Look up a frame by name
+ *
+ * @param sheet Sheet to search
+ * @param name Frame name as written in the descriptor
+ * @return Index into sheet->frames, or -1 if there's no such frame
+ */
+int a_SpriteSheetFindFrame( const aSpriteSheet_t* sheet, const char* name );
+
+/**
+ * @brief Draw a single frame with its pivot at pos
+ *
+ * @param sheet Sheet holding the frame
+ * @param frame Index from a_SpriteSheetFindFrame()
+ * @param pos Where the frame's pivot lands
+ * @param scale Scale applied to the frame and its offset
+ */
+void a_SpriteSheetBlit( const aSpriteSheet_t* sheet, const int frame,
+                        const aPoint2f_t pos, const float scale );
+
 #endif
 
@@ -35,6 +35,11 @@ aAUF_t* a_AUFParser( const char* filename )
   aAUF_t* new_root = a_AUFCreation();
 
   file_string = a_ReadFile( filename, &file_size );
+  if ( file_string == NULL )
+  {
+    free( new_root );
+    return NULL;
+  }
 
   newline_count = a_CountNewLines( file_string, file_size );
 
@@ -68,7 +73,7 @@ static int ParserLineToRoot( aAUF_t* root, char** line, int nl_count )
           printf( "Failed to add %s to root\n", new_AUF->string );
         }
 
-        if ( strcmp( new_AUF->string, "WT_CONTAINER" ) == 0 )
+        if ( new_AUF->string != NULL && strcmp( new_AUF->string, "WT_CONTAINER" ) == 0 )
         {
           if ( g_container != NULL )
           {
@@ -88,10 +93,9 @@ static int ParserLineToRoot( aAUF_t* root, char** line, int nl_count )
 
 static int ParserWidgetToNode( aAUFNode_t* node, char** line, int nl_count, int idx )
 {
-  int count = 0;
   for ( int i = idx; i < nl_count; i++ )
   {
-    if ( line[i] != NULL && count < MAX_WIDGET_COUNT )
+    if ( line[i] != NULL )
     {
       char* string = line[i];
       int str_len  = strlen( string );
@@ -133,19 +137,17 @@ static int ParserWidgetToNode( aAUFNode_t* node, char** line, int nl_count, int
 
       return i;
       
+      // Only sections count towards MAX_WIDGET_COUNT, so long frame
+      // lists in a sprite sheet don't trip it
       case '(':
       handle_parenthesis( node, string, str_len );
-      widget_count++;
       continue;
 
       default:
       handle_char( node, string, str_len );
-      widget_count++;
       continue;
       }
     }
-
-    count = i;
   }
 
   if ( widget_count >= MAX_WIDGET_COUNT )
@@ -155,7 +157,9 @@ static int ParserWidgetToNode( aAUFNode_t* node, char** line, int nl_count, int
     exit(1);
   }
 
-  return count;
+  // Ran off the end of the file; anything smaller sends the caller back
+  // over lines it has already parsed
+  return nl_count;
 }
 
 static int handle_parenthesis( aAUFNode_t* root, char* string, int str_len )
@@ -193,6 +197,9 @@ static int handle_parenthesis( aAUFNode_t* root, char* string, int str_len )
     y_AUF->value_int = atoi( y_value );
   }
 
+  free( x_value );
+  free( y_value );
+
   if ( a_AUFNodeAddChild( root, x_AUF ) < 0 )
   {
     printf( "Failed to add %s to root\n", x_AUF->string );
@@ -247,7 +254,11 @@ static int handle_char( aAUFNode_t* root, char* string, int str_len )
             str_value[str_len] = '\0';
             i += str_len;
             
-            if ( strchr( str_value, ',') ) continue;
+            if ( strchr( str_value, ',') )
+            {
+              free( str_value );
+              continue;
+            }
 
             aAUFNode_t* new_num = a_AUFNodeCreation();
             
@@ -305,6 +316,8 @@ static int handle_char( aAUFNode_t* root, char* string, int str_len )
               new_num->value_int = atoi( num_value );
             }
 
+            free( num_value );
+
             a_AUFNodeAddChild( new_AUF, new_num );
             count++;
 
@@ -343,6 +356,12 @@ static int handle_char( aAUFNode_t* root, char* string, int str_len )
 
 static int GetType( char* type )
 {
+  // Sections for other systems (e.g. preload manifests) aren't widgets
+  if ( strncmp( type, "WT_", 3 ) != 0 )
+  {
+    return WT_UNKNOWN;
+  }
+
   if ( strcmp( type, "WT_BUTTON" ) == 0 )
   {
     return WT_BUTTON;
@@ -380,8 +399,10 @@ static int GetType( char* type )
 
 static void handle_widget_definition( aAUFNode_t* node, const char* string )
 {
-  const char* start = strstr( string, "WT_" );
-  if ( !start ) return;
+  // Any "[TYPE.name]" header, child "[[...]]" ones included
+  const char* start = string;
+  while ( *start == '[' || *start == ' ' || *start == '\t' ) start++;
+  if ( *start == '\0' ) return;
 
   const char* dot = strchr( start, '.' );
   if ( !dot ) return;
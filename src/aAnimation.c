@@ -1,6 +1,7 @@
 #include <SDL2/SDL_render.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "Archimedes.h"
 
@@ -8,20 +9,86 @@ aAnimation_t* a_AnimationCreate( const char* filename, const float w,
                                  const float h, const int frame_count,
                                  const uint32_t frame_duration )
 {
+  if ( frame_count <= 0 )
+  {
+    LOG( "Animation needs at least one frame" );
+    return NULL;
+  }
+
   aAnimation_t* new_animation = malloc( sizeof( aAnimation_t ) );
   if ( new_animation == NULL )
   {
     printf( "Failed to allocate memory for animation: %s, %d\n", __FILE__, __LINE__ );
     return NULL;
   }
+
+  // A strip is just a sheet with every frame the same size, side by side
+  new_animation->frames = malloc( sizeof( aSpriteFrame_t ) * frame_count );
+  if ( new_animation->frames == NULL )
+  {
+    printf( "Failed to allocate memory for animation frames: %s, %d\n", __FILE__, __LINE__ );
+    free( new_animation );
+    return NULL;
+  }
+
+  for ( int i = 0; i < frame_count; i++ )
+  {
+    new_animation->frames[i] = (aSpriteFrame_t){ .rect = { i * w, 0, w, h } };
+  }
   
   new_animation->sprite_sheet = a_ImageLoad( filename );
   new_animation->animation_timer = a_TimerCreate();
   new_animation->frame_count = frame_count;
   new_animation->frame_duration = frame_duration;
   new_animation->frame_index = 0;
-  new_animation->sprite_rect = (aRectf_t){ .x = 0, .y = 0,
-                                           .w = w, .h = h };
+  new_animation->sprite_rect = new_animation->frames[0].rect;
+  new_animation->sheet = NULL;
+  new_animation->loop = 1;
+
+  return new_animation;
+}
+
+aAnimation_t* a_AnimationCreateFromSheet( aSpriteSheet_t* sheet, const char* name )
+{
+  if ( sheet == NULL || name == NULL ) return NULL;
+
+  const aSpriteSheetAnim_t* anim = NULL;
+  for ( int i = 0; i < sheet->anim_count; i++ )
+  {
+    if ( strcmp( sheet->anims[i].name, name ) == 0 )
+    {
+      anim = &sheet->anims[i];
+      break;
+    }
+  }
+
+  if ( anim == NULL || anim->frame_count == 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Sprite sheet has no animation %s",
+             log_level_strings[new_error.error_type], name );
+    LOG( new_error.error_msg );
+    return NULL;
+  }
+
+  aAnimation_t* new_animation = malloc( sizeof( aAnimation_t ) );
+  if ( new_animation == NULL )
+  {
+    printf( "Failed to allocate memory for animation: %s, %d\n", __FILE__, __LINE__ );
+    return NULL;
+  }
+
+  // Released by a_AnimationFree() like any other animation's sheet
+  new_animation->sprite_sheet = a_ImageAcquire( sheet->image );
+  new_animation->animation_timer = a_TimerCreate();
+  new_animation->frames = &sheet->sequence[anim->first];
+  new_animation->frame_count = anim->frame_count;
+  new_animation->frame_duration = anim->frame_duration;
+  new_animation->frame_index = 0;
+  new_animation->sprite_rect = new_animation->frames[0].rect;
+  new_animation->sheet = sheet;
+  new_animation->loop = anim->loop;
 
   return new_animation;
 }
@@ -31,8 +98,15 @@ void a_AnimationFree( aAnimation_t* animation )
   if ( animation != NULL )
   {
     a_TimerFree( animation->animation_timer );
-    SDL_DestroyTexture( animation->sprite_sheet->texture );
-    SDL_FreeSurface( animation->sprite_sheet->surface );
+
+    // The sheet belongs to the image cache and may be shared
+    a_ImageRelease( animation->sprite_sheet );
+
+    if ( animation->sheet == NULL )
+    {
+      free( animation->frames );
+    }
+
     free( animation );
   }
 
@@ -44,36 +118,31 @@ void a_AnimationFree( aAnimation_t* animation )
 
 void a_AnimationPlay( aPoint2f_t pos, aAnimation_t* animation )
 {
-  aRectf_t dest = (aRectf_t){ .x = pos.x, .y = pos.y,
-                              .w = animation->sprite_rect.w,
-                              .h = animation->sprite_rect.h };
-
   if ( a_TimerOneshot( animation->animation_timer, animation->frame_duration ) )
   {
-    //increment frame_index
-    if ( animation->frame_index < animation->frame_count )
+    if ( animation->frame_index + 1 < animation->frame_count )
     {
       animation->frame_index++;
     }
 
-    else 
+    else if ( animation->loop )
     {
       animation->frame_index = 0;
     }
 
-    animation->sprite_rect.x = 0;
-    animation->sprite_rect.x += ( animation->frame_index * animation->sprite_rect.w );
-    if ( animation->sprite_rect.x >
-      ( animation->frame_count * animation->sprite_rect.w )
-      - animation->sprite_rect.w )
-    {
-      animation->sprite_rect.x -= animation->sprite_rect.w;
-    }
+    animation->sprite_rect = animation->frames[animation->frame_index].rect;
     
     a_TimerStop( animation->animation_timer );
   }
 
   //display frame
-  a_BlitRect( animation->sprite_sheet, &animation->sprite_rect, &dest, app.options.scale_factor );
-}
+  const aSpriteFrame_t* frame = &animation->frames[animation->frame_index];
+  const float scale = app.options.scale_factor;
 
+  aRectf_t dest = (aRectf_t){ .x = pos.x + frame->offset.x * scale,
+                              .y = pos.y + frame->offset.y * scale,
+                              .w = frame->rect.w,
+                              .h = frame->rect.h };
+
+  a_BlitRect( animation->sprite_sheet, &animation->sprite_rect, &dest, scale );
+}
@@ -0,0 +1,342 @@
+/*
+ * aAtlas.c:
+ *
+ * Texture atlas pages for small images. Images loaded with
+ * IMAGE_LOAD_ATLAS are packed into shared ARGB8888 pages with a skyline
+ * bottom-left packer at load time, so sprites and widget skins drawn
+ * together share one texture and batch into a single draw call.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Archimedes.h"
+
+typedef struct
+{
+  int x;
+  int y;
+  int w;
+} aSkylineNode_t;
+
+typedef struct
+{
+  SDL_Texture* texture;
+  aSkylineNode_t* skyline;
+  int node_count;
+  int size;
+  int used_area;
+  int image_count;
+} aAtlasPage_t;
+
+static aAtlasPage_t pages[ATLAS_MAX_PAGES];
+static int page_count = 0;
+
+static int AtlasPageCreate( void );
+static int SkylineFit( const aAtlasPage_t* page, const int index, const int w, const int h );
+static int SkylinePack( aAtlasPage_t* page, const int w, const int h, int* out_x, int* out_y );
+
+int a_AtlasAddImage( aImage_t* img )
+{
+  if ( img == NULL || img->surface == NULL ) return 1;
+
+  SDL_Surface* surface = img->surface;
+
+  if ( surface->w > ATLAS_MAX_IMAGE_SIZE || surface->h > ATLAS_MAX_IMAGE_SIZE )
+  {
+    return 1;
+  }
+
+  int w = surface->w + ATLAS_PADDING;
+  int h = surface->h + ATLAS_PADDING;
+  int page_index = -1;
+  int x = 0, y = 0;
+
+  // First fit across existing pages, then open a new one
+  for ( int i = 0; i < page_count; i++ )
+  {
+    if ( SkylinePack( &pages[i], w, h, &x, &y ) == 0 )
+    {
+      page_index = i;
+      break;
+    }
+  }
+
+  if ( page_index < 0 )
+  {
+    page_index = AtlasPageCreate();
+    if ( page_index < 0 || SkylinePack( &pages[page_index], w, h, &x, &y ) != 0 )
+    {
+      return 1;
+    }
+  }
+
+  SDL_Surface* converted = surface;
+  if ( surface->format->format != SDL_PIXELFORMAT_ARGB8888 )
+  {
+    converted = SDL_ConvertSurfaceFormat( surface, SDL_PIXELFORMAT_ARGB8888, 0 );
+    if ( converted == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to convert %s for the atlas: %s",
+               log_level_strings[new_error.error_type], img->filename, SDL_GetError() );
+      LOG( new_error.error_msg );
+      return 1;
+    }
+  }
+
+  aAtlasPage_t* page = &pages[page_index];
+  SDL_Rect region = { x, y, surface->w, surface->h };
+
+  if ( SDL_MUSTLOCK( converted ) ) SDL_LockSurface( converted );
+  int status = SDL_UpdateTexture( page->texture, &region, converted->pixels, converted->pitch );
+  if ( SDL_MUSTLOCK( converted ) ) SDL_UnlockSurface( converted );
+
+  if ( converted != surface )
+  {
+    SDL_FreeSurface( converted );
+  }
+
+  if ( status != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to upload %s to atlas page %d: %s",
+             log_level_strings[new_error.error_type], img->filename, page_index, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  page->used_area += surface->w * surface->h;
+  page->image_count++;
+
+  img->texture = page->texture;
+  img->rect = (aRecti_t){ x, y, surface->w, surface->h };
+  img->atlas_page = page_index;
+  img->w = page->size;
+  img->h = page->size;
+  img->format = SDL_PIXELFORMAT_ARGB8888;
+  img->access = SDL_TEXTUREACCESS_STATIC;
+
+  return 0;
+}
+
+void a_AtlasGetStats( aAtlasStats_t* stats )
+{
+  if ( stats == NULL ) return;
+
+  *stats = (aAtlasStats_t){ 0 };
+  stats->page_count = page_count;
+
+  long used = 0;
+  long total = 0;
+
+  for ( int i = 0; i < page_count; i++ )
+  {
+    long area = (long)pages[i].size * pages[i].size;
+
+    stats->image_count += pages[i].image_count;
+    stats->page_size[i] = pages[i].size;
+    stats->occupancy[i] = (float)pages[i].used_area / (float)area;
+
+    used  += pages[i].used_area;
+    total += area;
+  }
+
+  stats->total_occupancy = total ? (float)used / (float)total : 0.0f;
+}
+
+void a_AtlasPrintStats( void )
+{
+  aAtlasStats_t stats;
+  a_AtlasGetStats( &stats );
+
+  printf( "Atlas: %d image(s) in %d page(s), %.1f%% occupied\n",
+          stats.image_count, stats.page_count, stats.total_occupancy * 100.0f );
+
+  for ( int i = 0; i < stats.page_count; i++ )
+  {
+    printf( "  page %d: %dx%d, %d image(s), %.1f%% occupied\n", i,
+            stats.page_size[i], stats.page_size[i], pages[i].image_count,
+            stats.occupancy[i] * 100.0f );
+  }
+}
+
+void a_AtlasCleanUp( void )
+{
+  for ( int i = 0; i < page_count; i++ )
+  {
+    if ( pages[i].texture != NULL )
+    {
+      a_RenderStateForgetTexture( pages[i].texture );
+      SDL_DestroyTexture( pages[i].texture );
+    }
+
+    free( pages[i].skyline );
+    pages[i] = (aAtlasPage_t){ 0 };
+  }
+
+  page_count = 0;
+}
+
+static int AtlasPageCreate( void )
+{
+  if ( page_count == ATLAS_MAX_PAGES )
+  {
+    LOG( "Atlas is full, further images get their own texture" );
+    return -1;
+  }
+
+  int size = ATLAS_PAGE_SIZE;
+  SDL_RendererInfo info;
+  if ( SDL_GetRendererInfo( app.renderer, &info ) == 0 && info.max_texture_width > 0 )
+  {
+    size = MIN( size, MIN( info.max_texture_width, info.max_texture_height ) );
+  }
+
+  aAtlasPage_t* page = &pages[page_count];
+
+  page->texture = SDL_CreateTexture( app.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_STATIC, size, size );
+  if ( page->texture == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create atlas page: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return -1;
+  }
+
+  a_RenderStateSetTextureBlendMode( page->texture, SDL_BLENDMODE_BLEND );
+
+  // Static textures start undefined; clear once so padding stays transparent
+  void* clear = calloc( (size_t)size * size, 4 );
+  if ( clear != NULL )
+  {
+    SDL_UpdateTexture( page->texture, NULL, clear, size * 4 );
+    free( clear );
+  }
+
+  // A skyline never has more nodes than the page is wide
+  page->skyline = malloc( sizeof( aSkylineNode_t ) * ( size + 1 ) );
+  if ( page->skyline == NULL )
+  {
+    LOG( "Failed to allocate atlas skyline" );
+    SDL_DestroyTexture( page->texture );
+    page->texture = NULL;
+    return -1;
+  }
+
+  page->skyline[0] = (aSkylineNode_t){ 0, 0, size };
+  page->node_count = 1;
+  page->size = size;
+  page->used_area = 0;
+  page->image_count = 0;
+
+  return page_count++;
+}
+
+/*
+ * Returns the y at which a w x h rect rests when its left edge sits on
+ * skyline node `index`, or -1 if it does not fit on the page there.
+ */
+static int SkylineFit( const aAtlasPage_t* page, const int index, const int w, const int h )
+{
+  int x = page->skyline[index].x;
+  if ( x + w > page->size ) return -1;
+
+  int y = 0;
+  int width_left = w;
+
+  for ( int i = index; width_left > 0; i++ )
+  {
+    y = MAX( y, page->skyline[i].y );
+    if ( y + h > page->size ) return -1;
+    width_left -= page->skyline[i].w;
+  }
+
+  return y;
+}
+
+static int SkylinePack( aAtlasPage_t* page, const int w, const int h, int* out_x, int* out_y )
+{
+  int best_index = -1;
+  int best_top = page->size + 1;
+  int best_width = page->size + 1;
+  int best_y = 0;
+
+  // Bottom-left: lowest resulting top edge, ties go to the narrowest node
+  for ( int i = 0; i < page->node_count; i++ )
+  {
+    int y = SkylineFit( page, i, w, h );
+    if ( y < 0 ) continue;
+
+    if ( y + h < best_top || ( y + h == best_top && page->skyline[i].w < best_width ) )
+    {
+      best_index = i;
+      best_top = y + h;
+      best_width = page->skyline[i].w;
+      best_y = y;
+    }
+  }
+
+  if ( best_index < 0 ) return 1;
+
+  int x = page->skyline[best_index].x;
+  aSkylineNode_t* nodes = page->skyline;
+
+  // Insert the new top edge, then trim the nodes it now covers
+  for ( int i = page->node_count; i > best_index; i-- )
+  {
+    nodes[i] = nodes[i - 1];
+  }
+  nodes[best_index] = (aSkylineNode_t){ x, best_y + h, w };
+  page->node_count++;
+
+  for ( int i = best_index + 1; i < page->node_count; )
+  {
+    int prev_end = nodes[i - 1].x + nodes[i - 1].w;
+    if ( nodes[i].x >= prev_end ) break;
+
+    int shrink = prev_end - nodes[i].x;
+    nodes[i].x += shrink;
+    nodes[i].w -= shrink;
+
+    if ( nodes[i].w > 0 ) break;
+
+    for ( int j = i; j < page->node_count - 1; j++ )
+    {
+      nodes[j] = nodes[j + 1];
+    }
+    page->node_count--;
+  }
+
+  // Merge neighbours at the same height
+  for ( int i = 0; i < page->node_count - 1; )
+  {
+    if ( nodes[i].y == nodes[i + 1].y )
+    {
+      nodes[i].w += nodes[i + 1].w;
+      for ( int j = i + 1; j < page->node_count - 1; j++ )
+      {
+        nodes[j] = nodes[j + 1];
+      }
+      page->node_count--;
+    }
+    else
+    {
+      i++;
+    }
+  }
+
+  *out_x = x;
+  *out_y = best_y;
+
+  return 0;
+}
+
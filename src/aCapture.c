@@ -0,0 +1,480 @@
+/*
+ * aCapture.c:
+ *
+ * Asynchronous screenshots and frame dumps. The main thread only reads
+ * the render output back into one of a small ring of pre-allocated
+ * surfaces; a worker thread encodes (PNG or QOI) and writes the files in
+ * capture order. When the ring is full the capture is dropped rather
+ * than stalling the frame, and counted so callers can see it happen.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#define CAPTURE_RING_SIZE 8
+
+// Readback is opaque RGB, same as a_ScreenshotSave
+#define CAPTURE_PIXEL_FORMAT SDL_PIXELFORMAT_RGB888
+
+typedef struct
+{
+  SDL_Surface* surface;
+  char filename[MAX_FILENAME_LENGTH];
+  int format;
+} aCaptureSlot_t;
+
+static aCaptureSlot_t slots[CAPTURE_RING_SIZE];
+static int slot_head = 0;       // Next slot the worker encodes
+static int slot_tail = 0;       // Next slot the main thread fills
+static int slot_pending = 0;    // Queued or being encoded
+
+static SDL_Thread* worker = NULL;
+static SDL_mutex* capture_lock = NULL;
+static SDL_cond* capture_cond = NULL;
+static int capture_ready = 0;
+static int capture_quit = 0;
+
+static int capture_dropped = 0;
+static int capture_written = 0;
+
+static char record_prefix[MAX_FILENAME_LENGTH];
+static int record_format = CAPTURE_FORMAT_PNG;
+static int record_remaining = 0;
+static int record_index = 0;
+
+static uint8_t* qoi_buffer = NULL;
+static size_t qoi_buffer_size = 0;
+
+static int CaptureInit( void );
+static int CaptureWorker( void* data );
+static int CaptureEncode( aCaptureSlot_t* slot );
+static int CaptureWriteQOI( SDL_Surface* surface, const char* filename );
+static int CaptureFormatFromName( const char* filename );
+
+int a_CaptureScreenshot( const char* filename )
+{
+  if ( filename == NULL ) return 1;
+
+  if ( CaptureInit() != 0 ) return 1;
+
+  // Queued primitives must be on the target before we read it back
+  a_DrawFlush();
+
+  int w, h;
+  if ( SDL_GetRendererOutputSize( app.renderer, &w, &h ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to query renderer output size: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  SDL_LockMutex( capture_lock );
+  int full = ( slot_pending == CAPTURE_RING_SIZE );
+  if ( full ) capture_dropped++;
+  SDL_UnlockMutex( capture_lock );
+
+  if ( full ) return 1;
+
+  // The tail slot is ours until it is queued; the worker never touches it
+  aCaptureSlot_t* slot = &slots[slot_tail];
+
+  if ( slot->surface != NULL && ( slot->surface->w != w || slot->surface->h != h ) )
+  {
+    SDL_FreeSurface( slot->surface );
+    slot->surface = NULL;
+  }
+
+  if ( slot->surface == NULL )
+  {
+    slot->surface = SDL_CreateRGBSurfaceWithFormat( 0, w, h, 32, CAPTURE_PIXEL_FORMAT );
+    if ( slot->surface == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create capture surface %s",
+               log_level_strings[new_error.error_type], SDL_GetError() );
+      LOG( new_error.error_msg );
+      return 1;
+    }
+  }
+
+  if ( SDL_RenderReadPixels( app.renderer, NULL, slot->surface->format->format,
+                             slot->surface->pixels, slot->surface->pitch ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to read pixels from renderer: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  snprintf( slot->filename, MAX_FILENAME_LENGTH, "%s", filename );
+  slot->format = CaptureFormatFromName( filename );
+
+  // No worker (e.g. no thread support): encode inline, like a_ScreenshotSave
+  if ( worker == NULL )
+  {
+    int status = CaptureEncode( slot );
+    slot_tail = ( slot_tail + 1 ) % CAPTURE_RING_SIZE;
+    slot_head = slot_tail;
+    return status;
+  }
+
+  SDL_LockMutex( capture_lock );
+  slot_tail = ( slot_tail + 1 ) % CAPTURE_RING_SIZE;
+  slot_pending++;
+  SDL_CondBroadcast( capture_cond );
+  SDL_UnlockMutex( capture_lock );
+
+  return 0;
+}
+
+int a_CaptureRecordStart( const char* prefix, const int frames, const int format )
+{
+  if ( prefix == NULL || frames <= 0 ) return 1;
+
+  if ( CaptureInit() != 0 ) return 1;
+
+  snprintf( record_prefix, MAX_FILENAME_LENGTH, "%s", prefix );
+  record_format = format;
+  record_remaining = frames;
+  record_index = 0;
+
+  return 0;
+}
+
+void a_CaptureRecordStop( void )
+{
+  record_remaining = 0;
+}
+
+int a_CaptureIsRecording( void )
+{
+  return record_remaining > 0;
+}
+
+void a_CaptureFrame( void )
+{
+  if ( record_remaining <= 0 ) return;
+
+  char filename[MAX_FILENAME_LENGTH];
+  snprintf( filename, MAX_FILENAME_LENGTH, "%s%06d.%s", record_prefix, record_index,
+            record_format == CAPTURE_FORMAT_QOI ? "qoi" : "png" );
+
+  // Dropped frames don't count, so the sequence is always N frames long
+  if ( a_CaptureScreenshot( filename ) == 0 )
+  {
+    record_index++;
+    record_remaining--;
+  }
+}
+
+int a_CaptureBacklog( void )
+{
+  if ( capture_lock == NULL ) return 0;
+
+  SDL_LockMutex( capture_lock );
+  int pending = slot_pending;
+  SDL_UnlockMutex( capture_lock );
+
+  return pending;
+}
+
+void a_CaptureGetStats( aCaptureStats_t* stats )
+{
+  if ( stats == NULL ) return;
+
+  *stats = (aCaptureStats_t){ 0 };
+  stats->capacity = CAPTURE_RING_SIZE;
+
+  if ( capture_lock == NULL ) return;
+
+  SDL_LockMutex( capture_lock );
+  stats->backlog = slot_pending;
+  stats->written = capture_written;
+  stats->dropped = capture_dropped;
+  SDL_UnlockMutex( capture_lock );
+}
+
+void a_CaptureCleanUp( void )
+{
+  record_remaining = 0;
+
+  // The worker drains the queue before it exits, so no capture is lost
+  if ( worker != NULL )
+  {
+    SDL_LockMutex( capture_lock );
+    capture_quit = 1;
+    SDL_CondBroadcast( capture_cond );
+    SDL_UnlockMutex( capture_lock );
+
+    SDL_WaitThread( worker, NULL );
+    worker = NULL;
+  }
+
+  for ( int i = 0; i < CAPTURE_RING_SIZE; i++ )
+  {
+    if ( slots[i].surface != NULL )
+    {
+      SDL_FreeSurface( slots[i].surface );
+      slots[i].surface = NULL;
+    }
+  }
+
+  if ( capture_cond != NULL )
+  {
+    SDL_DestroyCond( capture_cond );
+    capture_cond = NULL;
+  }
+
+  if ( capture_lock != NULL )
+  {
+    SDL_DestroyMutex( capture_lock );
+    capture_lock = NULL;
+  }
+
+  free( qoi_buffer );
+  qoi_buffer = NULL;
+  qoi_buffer_size = 0;
+
+  slot_head = slot_tail = slot_pending = 0;
+  capture_dropped = capture_written = 0;
+  capture_quit = 0;
+  capture_ready = 0;
+}
+
+static int CaptureInit( void )
+{
+  if ( capture_ready ) return 0;
+
+  capture_lock = SDL_CreateMutex();
+  capture_cond = SDL_CreateCond();
+  if ( capture_lock == NULL || capture_cond == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create capture lock: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+
+    if ( capture_lock != NULL ) SDL_DestroyMutex( capture_lock );
+    if ( capture_cond != NULL ) SDL_DestroyCond( capture_cond );
+    capture_lock = NULL;
+    capture_cond = NULL;
+    return 1;
+  }
+
+  capture_quit = 0;
+  worker = SDL_CreateThread( CaptureWorker, "aCapture", NULL );
+  if ( worker == NULL )
+  {
+    LOG( "Failed to start capture thread, captures will be encoded synchronously" );
+  }
+
+  capture_ready = 1;
+
+  return 0;
+}
+
+static int CaptureWorker( void* data )
+{
+  (void)data;
+
+  SDL_LockMutex( capture_lock );
+
+  for ( ;; )
+  {
+    while ( slot_pending == 0 && !capture_quit )
+    {
+      SDL_CondWait( capture_cond, capture_lock );
+    }
+
+    if ( slot_pending == 0 ) break;
+
+    aCaptureSlot_t* slot = &slots[slot_head];
+    SDL_UnlockMutex( capture_lock );
+
+    CaptureEncode( slot );
+
+    SDL_LockMutex( capture_lock );
+    slot_head = ( slot_head + 1 ) % CAPTURE_RING_SIZE;
+    slot_pending--;
+  }
+
+  SDL_UnlockMutex( capture_lock );
+
+  return 0;
+}
+
+static int CaptureEncode( aCaptureSlot_t* slot )
+{
+  int status;
+
+  if ( slot->format == CAPTURE_FORMAT_QOI )
+  {
+    status = CaptureWriteQOI( slot->surface, slot->filename );
+  }
+  else
+  {
+    status = IMG_SavePNG( slot->surface, slot->filename ) != 0;
+  }
+
+  if ( status != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to save capture: %s, %s",
+             log_level_strings[new_error.error_type], slot->filename, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  if ( capture_lock != NULL ) SDL_LockMutex( capture_lock );
+  capture_written++;
+  if ( capture_lock != NULL ) SDL_UnlockMutex( capture_lock );
+
+  return 0;
+}
+
+/*
+ * QOI ("Quite OK Image") encoder. Several times faster than PNG for a
+ * comparable size on flat 2D frames, which is what keeps a recording
+ * from backing up the ring. Only the worker thread calls this.
+ */
+static int CaptureWriteQOI( SDL_Surface* surface, const char* filename )
+{
+  const int w = surface->w;
+  const int h = surface->h;
+  size_t max_size = (size_t)w * h * 4 + 14 + 8;
+
+  if ( max_size > qoi_buffer_size )
+  {
+    uint8_t* buffer = realloc( qoi_buffer, max_size );
+    if ( buffer == NULL ) return 1;
+    qoi_buffer = buffer;
+    qoi_buffer_size = max_size;
+  }
+
+  uint8_t* out = qoi_buffer;
+  size_t p = 0;
+
+  // Header: magic, big-endian size, 3 channels, sRGB
+  memcpy( out, "qoif", 4 );
+  out[4]  = (uint8_t)( w >> 24 ); out[5]  = (uint8_t)( w >> 16 );
+  out[6]  = (uint8_t)( w >> 8 );  out[7]  = (uint8_t)w;
+  out[8]  = (uint8_t)( h >> 24 ); out[9]  = (uint8_t)( h >> 16 );
+  out[10] = (uint8_t)( h >> 8 );  out[11] = (uint8_t)h;
+  out[12] = 3;
+  out[13] = 0;
+  p = 14;
+
+  uint32_t index[64] = { 0 };
+  uint32_t prev = 0xFF000000u;    // Spec starts from opaque black
+  int run = 0;
+
+  for ( int y = 0; y < h; y++ )
+  {
+    const uint32_t* row = (const uint32_t*)( (const uint8_t*)surface->pixels + (size_t)y * surface->pitch );
+
+    for ( int x = 0; x < w; x++ )
+    {
+      uint32_t px = row[x] | 0xFF000000u;
+
+      if ( px == prev )
+      {
+        run++;
+        if ( run == 62 )
+        {
+          out[p++] = 0xC0 | ( run - 1 );
+          run = 0;
+        }
+        continue;
+      }
+
+      if ( run > 0 )
+      {
+        out[p++] = 0xC0 | ( run - 1 );
+        run = 0;
+      }
+
+      uint8_t r = ( px >> 16 ) & 0xFF;
+      uint8_t g = ( px >> 8 ) & 0xFF;
+      uint8_t b = px & 0xFF;
+      int hash = ( r * 3 + g * 5 + b * 7 + 255 * 11 ) % 64;
+
+      if ( index[hash] == px )
+      {
+        out[p++] = (uint8_t)hash;
+      }
+      else
+      {
+        index[hash] = px;
+
+        int8_t dr = (int8_t)( r - ( ( prev >> 16 ) & 0xFF ) );
+        int8_t dg = (int8_t)( g - ( ( prev >> 8 ) & 0xFF ) );
+        int8_t db = (int8_t)( b - ( prev & 0xFF ) );
+        int8_t dr_dg = (int8_t)( dr - dg );
+        int8_t db_dg = (int8_t)( db - dg );
+
+        if ( dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2 )
+        {
+          out[p++] = 0x40 | ( ( dr + 2 ) << 4 ) | ( ( dg + 2 ) << 2 ) | ( db + 2 );
+        }
+        else if ( dg > -33 && dg < 32 && dr_dg > -9 && dr_dg < 8 && db_dg > -9 && db_dg < 8 )
+        {
+          out[p++] = 0x80 | ( dg + 32 );
+          out[p++] = (uint8_t)( ( ( dr_dg + 8 ) << 4 ) | ( db_dg + 8 ) );
+        }
+        else
+        {
+          out[p++] = 0xFE;
+          out[p++] = r;
+          out[p++] = g;
+          out[p++] = b;
+        }
+      }
+
+      prev = px;
+    }
+  }
+
+  if ( run > 0 )
+  {
+    out[p++] = 0xC0 | ( run - 1 );
+  }
+
+  static const uint8_t end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+  memcpy( out + p, end_marker, 8 );
+  p += 8;
+
+  FILE* file = fopen( filename, "wb" );
+  if ( file == NULL ) return 1;
+
+  size_t written = fwrite( out, 1, p, file );
+  fclose( file );
+
+  return written != p;
+}
+
+static int CaptureFormatFromName( const char* filename )
+{
+  const char* dot = strrchr( filename, '.' );
+
+  if ( dot != NULL && ( strcmp( dot, ".qoi" ) == 0 || strcmp( dot, ".QOI" ) == 0 ) )
+  {
+    return CAPTURE_FORMAT_QOI;
+  }
+
+  return CAPTURE_FORMAT_PNG;
+}
+
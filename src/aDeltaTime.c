@@ -3,6 +3,19 @@
 
 #include "Archimedes.h"
 
+// Below this much remaining frame time, spin instead of sleeping; SDL_Delay
+// can overshoot by a millisecond or more depending on the OS scheduler
+#define FRAME_PACE_SPIN_MS 2
+
+static int pace_mode = -1;      // app.options values the pacer last applied
+static int pace_fps = 0;
+static Uint64 pace_deadline = 0;
+static Uint64 pace_last = 0;
+static aFramePaceStats_t pace_stats;
+
+static void FramePaceApply( void );
+static void FramePaceSleepUntil( const Uint64 deadline, const Uint64 freq );
+
 float a_GetDeltaTime( void )
 {
   app.time.last_time = app.time.current_time;
@@ -21,3 +34,131 @@ void a_GetFPS( void )
   }
 }
 
+
+void a_FramePaceSetMode( const int mode, const int target_fps )
+{
+  app.options.frame_cap = mode;
+  if ( target_fps > 0 )
+  {
+    app.options.target_fps = target_fps;
+  }
+}
+
+void a_FramePaceWait( void )
+{
+  if ( app.options.frame_cap != pace_mode || app.options.target_fps != pace_fps )
+  {
+    FramePaceApply();
+  }
+
+  const Uint64 freq = SDL_GetPerformanceFrequency();
+  const Uint64 period = freq / MAX( pace_stats.target_fps, 1 );
+  Uint64 now = SDL_GetPerformanceCounter();
+
+#ifndef __EMSCRIPTEN__
+  // The browser schedules frames itself; never block its main loop
+  if ( pace_stats.mode == FRAME_PACE_CAP )
+  {
+    if ( pace_deadline == 0 )
+    {
+      pace_deadline = now + period;
+    }
+    else if ( now > pace_deadline )
+    {
+      pace_stats.missed++;
+
+      // Small overruns keep the cadence; long stalls restart it instead of
+      // rushing a burst of frames to catch up
+      pace_deadline = ( now - pace_deadline > period ) ? now + period : pace_deadline + period;
+    }
+    else
+    {
+      FramePaceSleepUntil( pace_deadline, freq );
+      pace_deadline += period;
+    }
+
+    now = SDL_GetPerformanceCounter();
+  }
+#endif
+
+  if ( pace_last != 0 )
+  {
+    float frame_ms = (float)( (double)( now - pace_last ) * 1000.0 / (double)freq );
+
+    // Vsync has no deadline of its own; a frame that spans more than one
+    // refresh missed it
+    if ( pace_stats.mode == FRAME_PACE_VSYNC && frame_ms > 1500.0f / pace_stats.target_fps )
+    {
+      pace_stats.missed++;
+    }
+
+    pace_stats.frame_ms = frame_ms;
+    pace_stats.worst_ms = MAX( pace_stats.worst_ms, frame_ms );
+  }
+
+  pace_stats.frames++;
+  pace_last = now;
+}
+
+void a_FramePaceGetStats( aFramePaceStats_t* stats )
+{
+  if ( stats == NULL ) return;
+
+  *stats = pace_stats;
+}
+
+static void FramePaceApply( void )
+{
+  int mode = app.options.frame_cap;
+  int fps = app.options.target_fps > 0 ? app.options.target_fps : FPS_CAP;
+
+  if ( mode == FRAME_PACE_VSYNC )
+  {
+    SDL_DisplayMode display;
+    if ( app.window != NULL &&
+         SDL_GetCurrentDisplayMode( SDL_GetWindowDisplayIndex( app.window ), &display ) == 0 &&
+         display.refresh_rate > 0 )
+    {
+      fps = display.refresh_rate;
+    }
+  }
+
+  if ( app.renderer != NULL &&
+       SDL_RenderSetVSync( app.renderer, mode == FRAME_PACE_VSYNC ) != 0 &&
+       mode == FRAME_PACE_VSYNC )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Renderer vsync unavailable, capping at %d fps: %s",
+             log_level_strings[new_error.error_type], fps, SDL_GetError() );
+    LOG( new_error.error_msg );
+    mode = FRAME_PACE_CAP;
+  }
+
+  pace_mode = app.options.frame_cap;
+  pace_fps = app.options.target_fps;
+  pace_deadline = 0;
+  pace_last = 0;
+
+  pace_stats = (aFramePaceStats_t){ 0 };
+  pace_stats.mode = mode;
+  pace_stats.target_fps = fps;
+}
+
+static void FramePaceSleepUntil( const Uint64 deadline, const Uint64 freq )
+{
+  const Uint64 spin = freq * FRAME_PACE_SPIN_MS / 1000;
+  Uint64 now = SDL_GetPerformanceCounter();
+
+  // Coarse sleep in whole milliseconds, leaving the spin margin untouched
+  while ( now < deadline && deadline - now > spin + freq / 1000 )
+  {
+    SDL_Delay( (Uint32)( ( deadline - now - spin ) * 1000 / freq ) );
+    now = SDL_GetPerformanceCounter();
+  }
+
+  while ( SDL_GetPerformanceCounter() < deadline )
+  {
+    // Spin out the last couple of milliseconds
+  }
+}
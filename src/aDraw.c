@@ -23,78 +23,274 @@
 
 #include "Archimedes.h"
 
+#define DRAW_BATCH_INITIAL_QUADS 1024
+
+/*
+ * Per-frame primitive queue. Points, lines and rects are appended as
+ * colored quads and submitted with a single SDL_RenderGeometry call
+ * whenever a_DrawFlush() runs (present, or before any immediate draw).
+ */
+typedef struct
+{
+  SDL_Vertex* vertices;
+  int* indices;
+  int num_vertices;
+  int num_indices;
+  int max_vertices;
+  int max_indices;
+} aDrawBatch_t;
+
+static aDrawBatch_t draw_batch = { 0 };
+
+#define CIRCLE_CACHE_MAX_RADIUS 512
+
+/*
+ * Rasterized circle for one radius, as runs of rows relative to the
+ * center. fill spans cover [-outer, outer]; outline spans cover
+ * [-outer, -inner] and [inner, outer].
+ */
+typedef struct
+{
+  int dy;
+  int h;
+  int inner;
+  int outer;
+} aCircleSpan_t;
+
+typedef struct
+{
+  aCircleSpan_t* fill;
+  aCircleSpan_t* outline;
+  int fill_count;
+  int outline_count;
+} aCircleSpans_t;
+
+static aCircleSpans_t* circle_cache[CIRCLE_CACHE_MAX_RADIUS] = { 0 };
+
+static int DrawBatchReserve( const int num_vertices, const int num_indices );
+static void DrawBatchQuad( const float x0, const float y0, const float x1, const float y1,
+                           const float x2, const float y2, const float x3, const float y3,
+                           const aColor_t color );
+static void DrawBatchRect( const float x, const float y, const float w, const float h,
+                           const aColor_t color );
+
 void a_PrepareScene( void )
 {
-  SDL_SetRenderDrawColor(app.renderer, app.background.r, app.background.g, app.background.b, app.background.a);
+  a_DrawFlush();
+  a_RenderStatsBegin();
+
+  // Images drawn or acquired from here on are stamped with the new frame
+  if ( app.img_cache != NULL ) app.img_cache->frame++;
+
+  // Changed files queue their reloads ahead of this frame's uploads
+  a_HotReloadPoll();
+
+  // Decoded in the background, uploaded here under the per-frame budget
+  a_ImageAsyncUpdate();
+
+  a_RenderStateSetDrawColor( app.background );
   SDL_RenderClear(app.renderer);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
+  RENDER_STATS_DRAW( NULL, 0 );
 }
 
 void a_PresentScene( void )
 {
+  a_DrawFlush();
+  a_RenderStatsEnd();
+
+  // Back buffer contents are undefined once presented
+  a_CaptureFrame();
+
   SDL_RenderPresent(app.renderer);
+
+  a_FramePaceWait();
+}
+
+void a_DrawFlush( void )
+{
+  if ( draw_batch.num_indices == 0 )
+  {
+    return;
+  }
+
+  a_RenderStateSetBlendMode( SDL_BLENDMODE_BLEND );
+  SDL_RenderGeometry( app.renderer, NULL, draw_batch.vertices, draw_batch.num_vertices,
+                      draw_batch.indices, draw_batch.num_indices );
+  RENDER_STATS_DRAW( NULL, draw_batch.num_vertices );
+
+  draw_batch.num_vertices = 0;
+  draw_batch.num_indices  = 0;
+}
+
+void a_DrawCleanUp( void )
+{
+  free( draw_batch.vertices );
+  free( draw_batch.indices );
+  draw_batch = (aDrawBatch_t){ 0 };
+
+  for ( int i = 0; i < CIRCLE_CACHE_MAX_RADIUS; i++ )
+  {
+    free( circle_cache[i] );
+    circle_cache[i] = NULL;
+  }
+}
+
+static int DrawBatchReserve( const int num_vertices, const int num_indices )
+{
+  if ( draw_batch.num_vertices + num_vertices <= draw_batch.max_vertices &&
+       draw_batch.num_indices + num_indices <= draw_batch.max_indices )
+  {
+    return 0;
+  }
+
+  int new_max_vertices = draw_batch.max_vertices ? draw_batch.max_vertices : DRAW_BATCH_INITIAL_QUADS * 4;
+  int new_max_indices  = draw_batch.max_indices  ? draw_batch.max_indices  : DRAW_BATCH_INITIAL_QUADS * 6;
+
+  while ( draw_batch.num_vertices + num_vertices > new_max_vertices ) new_max_vertices *= 2;
+  while ( draw_batch.num_indices + num_indices > new_max_indices )    new_max_indices  *= 2;
+
+  SDL_Vertex* vertices = realloc( draw_batch.vertices, sizeof( SDL_Vertex ) * new_max_vertices );
+  if ( vertices == NULL )
+  {
+    LOG( "Failed to grow the primitive batch vertex buffer" );
+    return 1;
+  }
+  draw_batch.vertices = vertices;
+  draw_batch.max_vertices = new_max_vertices;
+
+  int* indices = realloc( draw_batch.indices, sizeof( int ) * new_max_indices );
+  if ( indices == NULL )
+  {
+    LOG( "Failed to grow the primitive batch index buffer" );
+    return 1;
+  }
+  draw_batch.indices = indices;
+  draw_batch.max_indices = new_max_indices;
+
+  return 0;
+}
+
+static void DrawBatchQuad( const float x0, const float y0, const float x1, const float y1,
+                           const float x2, const float y2, const float x3, const float y3,
+                           const aColor_t color )
+{
+  if ( DrawBatchReserve( 4, 6 ) )
+  {
+    // Out of memory: submit what we have and reuse the existing storage
+    a_DrawFlush();
+    if ( draw_batch.max_vertices < 4 || draw_batch.max_indices < 6 ) return;
+  }
+
+  SDL_Color c = { color.r, color.g, color.b, color.a };
+  SDL_Vertex* v = &draw_batch.vertices[draw_batch.num_vertices];
+  int* i = &draw_batch.indices[draw_batch.num_indices];
+  int base = draw_batch.num_vertices;
+
+  v[0] = (SDL_Vertex){ { x0, y0 }, c, { 0, 0 } };
+  v[1] = (SDL_Vertex){ { x1, y1 }, c, { 0, 0 } };
+  v[2] = (SDL_Vertex){ { x2, y2 }, c, { 0, 0 } };
+  v[3] = (SDL_Vertex){ { x3, y3 }, c, { 0, 0 } };
+
+  i[0] = base;
+  i[1] = base + 1;
+  i[2] = base + 2;
+  i[3] = base;
+  i[4] = base + 2;
+  i[5] = base + 3;
+
+  draw_batch.num_vertices += 4;
+  draw_batch.num_indices  += 6;
+}
+
+static void DrawBatchRect( const float x, const float y, const float w, const float h,
+                           const aColor_t color )
+{
+  if ( w <= 0 || h <= 0 ) return;
+
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)( w * h ) );
+  DrawBatchQuad( x, y, x + w, y, x + w, y + h, x, y + h, color );
 }
 
 void a_DrawPoint( const int x, const int y, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawPoint(app.renderer, x, y);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  DrawBatchRect( x, y, 1, 1, color );
 }
 
 void a_DrawLine( const int x1, const int y1, const int x2, const int y2, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawLine(app.renderer, x1, y1, x2, y2);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  if ( y1 == y2 )
+  {
+    a_DrawHorizontalLine( x1, x2, y1, color );
+    return;
+  }
+
+  if ( x1 == x2 )
+  {
+    a_DrawVerticalLine( y1, y2, x1, color );
+    return;
+  }
+
+  // One pixel wide quad from pixel center to pixel center, extended by half
+  // a pixel at both ends so the endpoints are covered like SDL_RenderDrawLine
+  float dx = (float)( x2 - x1 );
+  float dy = (float)( y2 - y1 );
+  float len = SDL_sqrtf( dx * dx + dy * dy );
+  float ux = ( dx / len ) * 0.5f;
+  float uy = ( dy / len ) * 0.5f;
+
+  float ax = x1 + 0.5f - ux, ay = y1 + 0.5f - uy;
+  float bx = x2 + 0.5f + ux, by = y2 + 0.5f + uy;
+
+  DrawBatchQuad( ax + uy, ay - ux,
+                 bx + uy, by - ux,
+                 bx - uy, by + ux,
+                 ax - uy, ay + ux, color );
 }
 
 void a_DrawHorizontalLine( const int x1, const int x2, const int y, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawLine(app.renderer, x1, y, x2, y);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  int x = MIN( x1, x2 );
+  DrawBatchRect( x, y, MAX( x1, x2 ) - x + 1, 1, color );
 }
 
 void a_DrawVerticalLine( const int y1, const int y2, const int x, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawLine(app.renderer, x, y1, x, y2);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  int y = MIN( y1, y2 );
+  DrawBatchRect( x, y, 1, MAX( y1, y2 ) - y + 1, color );
 }
 
-void a_DrawCircle( const int posX, const int posY, const int radius, const aColor_t color )
+static aCircleSpans_t* CircleSpansBuild( const int radius )
 {
+  int rows = 2 * radius + 1;
+  int* outer = malloc( sizeof( int ) * rows * 2 );
+  if ( outer == NULL )
+  {
+    LOG( "Failed to allocate circle span scratch" );
+    return NULL;
+  }
+  int* inner = outer + rows;
+
+  for ( int i = 0; i < rows; i++ )
+  {
+    outer[i] = -1;
+    inner[i] = radius + 1;
+  }
+
+  // Midpoint circle; every step contributes |x| on rows +-y and |y| on rows +-x
   int x = 0;
   int y = radius;
   int decision = 5 - ( 4 * radius );
 
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor( app.renderer, color.r, color.g, color.b, color.a );
   while ( x <= y )
   {
-    SDL_RenderDrawPoint( app.renderer, posX + x, posY - y );
-    SDL_RenderDrawPoint( app.renderer, posX + x, posY + y );
-    SDL_RenderDrawPoint( app.renderer, posX - x, posY - y );
-    SDL_RenderDrawPoint( app.renderer, posX - x, posY + y );
-    SDL_RenderDrawPoint( app.renderer, posX + y, posY - x );
-    SDL_RenderDrawPoint( app.renderer, posX + y, posY + x );
-    SDL_RenderDrawPoint( app.renderer, posX - y, posY - x );
-    SDL_RenderDrawPoint( app.renderer, posX - y, posY + x );
-    SDL_SetRenderDrawColor( app.renderer, 255, 255, 255, 255 );
+    const int row[4] = { radius - y, radius + y, radius - x, radius + x };
+    const int col[4] = { x, x, y, y };
+
+    for ( int i = 0; i < 4; i++ )
+    {
+      outer[row[i]] = MAX( outer[row[i]], col[i] );
+      inner[row[i]] = MIN( inner[row[i]], col[i] );
+    }
 
     if ( decision > 0 )
     {
@@ -106,112 +302,230 @@ void a_DrawCircle( const int posX, const int posY, const int radius, const aColo
 
     decision += 8 * x + 4;
   }
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+
+  // Worst case one run per row for each list
+  aCircleSpans_t* spans = malloc( sizeof( aCircleSpans_t ) + sizeof( aCircleSpan_t ) * rows * 2 );
+  if ( spans == NULL )
+  {
+    LOG( "Failed to allocate circle spans" );
+    free( outer );
+    return NULL;
+  }
+  spans->fill = (aCircleSpan_t*)( spans + 1 );
+  spans->outline = spans->fill + rows;
+  spans->fill_count = 0;
+  spans->outline_count = 0;
+
+  // Consecutive rows with identical extents collapse into one taller span
+  for ( int i = 0; i < rows; i++ )
+  {
+    aCircleSpan_t* last = spans->fill_count ? &spans->fill[spans->fill_count - 1] : NULL;
+    if ( last && last->outer == outer[i] )
+    {
+      last->h++;
+    }
+    else
+    {
+      spans->fill[spans->fill_count++] = (aCircleSpan_t){ i - radius, 1, 0, outer[i] };
+    }
+
+    last = spans->outline_count ? &spans->outline[spans->outline_count - 1] : NULL;
+    if ( last && last->outer == outer[i] && last->inner == inner[i] )
+    {
+      last->h++;
+    }
+    else
+    {
+      spans->outline[spans->outline_count++] = (aCircleSpan_t){ i - radius, 1, inner[i], outer[i] };
+    }
+  }
+
+  free( outer );
+
+  return spans;
 }
 
-void a_DrawFilledCircle( const int posX, const int posY, const int radius, const aColor_t color )
+static aCircleSpans_t* CircleSpansGet( const int radius )
 {
-  int x = 0;
-  int y = radius;
-  int decision = 5 - ( 4 * radius );
+  if ( radius >= CIRCLE_CACHE_MAX_RADIUS )
+  {
+    return CircleSpansBuild( radius );
+  }
 
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  while ( x <= y )
+  if ( circle_cache[radius] == NULL )
   {
-    SDL_RenderDrawLine(app.renderer, posX - x, posY - y, posX + x, posY - y);
-    SDL_RenderDrawLine(app.renderer, posX - y, posY - x, posX + y, posY - x);
-    SDL_RenderDrawLine(app.renderer, posX - y, posY + x, posX + y, posY + x);
-    SDL_RenderDrawLine(app.renderer, posX - x, posY + y, posX + x, posY + y);
+    circle_cache[radius] = CircleSpansBuild( radius );
+  }
 
-    if ( decision > 0 )
+  return circle_cache[radius];
+}
+
+static void CircleSpansRelease( aCircleSpans_t* spans, const int radius )
+{
+  // Only radii too large for the cache own a temporary span list
+  if ( radius >= CIRCLE_CACHE_MAX_RADIUS )
+  {
+    free( spans );
+  }
+}
+
+static void DrawBatchFilledCircle( const int posX, const int posY, const int radius,
+                                   const aColor_t color )
+{
+  if ( radius < 0 ) return;
+
+  aCircleSpans_t* spans = CircleSpansGet( radius );
+  if ( spans == NULL ) return;
+
+  for ( int i = 0; i < spans->fill_count; i++ )
+  {
+    const aCircleSpan_t* span = &spans->fill[i];
+    DrawBatchRect( posX - span->outer, posY + span->dy,
+                   span->outer * 2 + 1, span->h, color );
+  }
+
+  CircleSpansRelease( spans, radius );
+}
+
+void a_DrawCircle( const int posX, const int posY, const int radius, const aColor_t color )
+{
+  if ( radius < 0 ) return;
+
+  aCircleSpans_t* spans = CircleSpansGet( radius );
+  if ( spans == NULL ) return;
+
+  for ( int i = 0; i < spans->outline_count; i++ )
+  {
+    const aCircleSpan_t* span = &spans->outline[i];
+    int w = span->outer - span->inner + 1;
+
+    if ( span->inner == 0 )
     {
-      y--;
-      decision -= 8 *  y;
+      // Top and bottom caps: both halves meet in the middle
+      DrawBatchRect( posX - span->outer, posY + span->dy, span->outer * 2 + 1, span->h, color );
+      continue;
     }
 
-    x++;
+    DrawBatchRect( posX - span->outer, posY + span->dy, w, span->h, color );
+    DrawBatchRect( posX + span->inner, posY + span->dy, w, span->h, color );
+  }
 
-    decision += 8 * x + 4;
+  CircleSpansRelease( spans, radius );
+}
+
+void a_DrawFilledCircle( const int posX, const int posY, const int radius, const aColor_t color )
+{
+  DrawBatchFilledCircle( posX, posY, radius, color );
+}
+
+void a_DrawFilledCircles( const aPoint3i_t* circles, const aColor_t* colors, const int count )
+{
+  if ( circles == NULL || colors == NULL ) return;
+
+  for ( int i = 0; i < count; i++ )
+  {
+    DrawBatchFilledCircle( circles[i].x, circles[i].y, circles[i].z, colors[i] );
   }
-  // Reset color to white after drawing is complete
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
 }
 
 void a_DrawTriangle( const int x0, const int y0, const int x1, const int y1,
                      const int x2, const int y2, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawLine(app.renderer, x0, y0, x1, y1);
-  SDL_RenderDrawLine(app.renderer, x1, y1, x2, y2);
-  SDL_RenderDrawLine(app.renderer, x2, y2, x0, y0);
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  a_DrawLine( x0, y0, x1, y1, color );
+  a_DrawLine( x1, y1, x2, y2, color );
+  a_DrawLine( x2, y2, x0, y0, color );
 }
 
-/*void a_DrawFilledTriangle( const int x0, const int y0, const int x1, const int y1,
+void a_DrawFilledTriangle( const int x0, const int y0, const int x1, const int y1,
                            const int x2, const int y2, const aColor_t color )
 {
-  int maxX = MAX(x0, MAX(x1, x2));
-  int minX = MIN(x0, MIN(x1, x2));
-  int maxY = MAX(y0, MAX(y1, y2));
-  int minY = MIN(y0, MIN(y1, y2));
+  const aPoint2f_t points[3] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+
+  a_DrawFilledPolygon( points, 3, color );
+}
 
-  dVec2_t v1 = {x1 - x0, y1 - y0};
-  dVec2_t v2 = {x2 - x0, y2 - y0};
+void a_DrawFilledPolygon( const aPoint2f_t* points, const int count, const aColor_t color )
+{
+  if ( points == NULL || count < 3 ) return;
 
-  for (int x = minX; x <= maxX; x++)
+  if ( DrawBatchReserve( count, ( count - 2 ) * 3 ) )
   {
-    for (int y = minY; y <= maxY; y++)
-    {
-      dVec2_t q = {x - x0, y - y0};
+    a_DrawFlush();
+    if ( draw_batch.max_vertices < count || draw_batch.max_indices < ( count - 2 ) * 3 ) return;
+  }
 
-      float s = d_CrossProductVec2f(q, v2) / d_CrossProductVec2f(v1, v2);
-      float t = d_CrossProductVec2f(v1, q) / d_CrossProductVec2f(v1, v2);
+  SDL_Color c = { color.r, color.g, color.b, color.a };
+  SDL_Vertex* v = &draw_batch.vertices[draw_batch.num_vertices];
+  int* i = &draw_batch.indices[draw_batch.num_indices];
+  int base = draw_batch.num_vertices;
 
-      if ( (s >= 0) && (t >= 0) && (s + t <= 1)) {
-        SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-        SDL_RenderDrawPoint(app.renderer, x, y);
-      }
-    }
+  for ( int j = 0; j < count; j++ )
+  {
+    v[j] = (SDL_Vertex){ { points[j].x, points[j].y }, c, { 0, 0 } };
+  }
+
+  // Triangle fan around the first vertex
+  for ( int j = 1; j < count - 1; j++ )
+  {
+    *i++ = base;
+    *i++ = base + j;
+    *i++ = base + j + 1;
   }
-}*/
+
+  draw_batch.num_vertices += count;
+  draw_batch.num_indices  += ( count - 2 ) * 3;
+}
 
 void a_DrawRect( const aRectf_t rect, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor( app.renderer, color.r, color.g, color.b, color.a );
-  SDL_Rect sdl_rect = (SDL_Rect){ rect.x, rect.y, rect.w, rect.h };
-  SDL_RenderDrawRect( app.renderer, &sdl_rect );
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  SDL_Rect r = (SDL_Rect){ rect.x, rect.y, rect.w, rect.h };
+
+  if ( r.w <= 0 || r.h <= 0 ) return;
+
+  // Same pixels as SDL_RenderDrawRect: top and bottom rows, then the sides
+  DrawBatchRect( r.x, r.y, r.w, 1, color );
+  if ( r.h > 1 )
+  {
+    DrawBatchRect( r.x, r.y + r.h - 1, r.w, 1, color );
+  }
+  if ( r.h > 2 )
+  {
+    DrawBatchRect( r.x, r.y + 1, 1, r.h - 2, color );
+    if ( r.w > 1 )
+    {
+      DrawBatchRect( r.x + r.w - 1, r.y + 1, 1, r.h - 2, color );
+    }
+  }
 }
 
 
 void a_DrawFilledRect( const aRectf_t rect, const aColor_t color )
 {
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor( app.renderer, color.r, color.g, color.b, color.a );
-  SDL_Rect sdl_rect = (SDL_Rect){ rect.x, rect.y, rect.w, rect.h };
-  SDL_RenderFillRect( app.renderer, &sdl_rect );
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  SDL_Rect r = (SDL_Rect){ rect.x, rect.y, rect.w, rect.h };
+  DrawBatchRect( r.x, r.y, r.w, r.h, color );
 }
 
 void a_Blit( aImage_t* img, int x, int y )
 {
-  if ( !img ) return;
+  // Images from a_ImageLoadAsync() have no texture until they're uploaded
+  if ( !img || !img->texture ) return;
 
-  SDL_Rect dest;
-  dest.x = x;
-  dest.y = y;
+  a_DrawFlush();
 
-  // Query texture for its original dimensions
-  SDL_QueryTexture( img->texture, NULL, NULL, &dest.w, &dest.h );
+  SDL_Rect dest = { x, y, img->rect.w, img->rect.h };
+
+  IMAGE_TOUCH( img );
+  RENDER_STATS_DRAW( img->texture, 4 );
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)dest.w * dest.h );
+
+  if ( img->atlas_page < 0 )
+  {
+    SDL_RenderCopy( app.renderer, img->texture, NULL, &dest );
+    return;
+  }
 
-  SDL_RenderCopy( app.renderer, img->texture, NULL, &dest );
+  SDL_Rect src = { img->rect.x, img->rect.y, img->rect.w, img->rect.h };
+  SDL_RenderCopy( app.renderer, img->texture, &src, &dest );
 }
 
 void a_BlitRect( aImage_t* img, aRectf_t* src, aRectf_t* dest, const float scale )
@@ -219,7 +533,9 @@ void a_BlitRect( aImage_t* img, aRectf_t* src, aRectf_t* dest, const float scale
   SDL_Rect temp_dest = {0};
   SDL_Rect temp_src = {0};
 
-  if ( !img ) return;
+  if ( !img || !img->texture ) return;
+
+  a_DrawFlush();
 
   if ( dest != NULL )
   {
@@ -231,72 +547,76 @@ void a_BlitRect( aImage_t* img, aRectf_t* src, aRectf_t* dest, const float scale
   
   else
   {
-    SDL_QueryTexture( img->texture, NULL, NULL, &temp_dest.w, &temp_dest.h );
+    temp_dest.w = img->rect.w;
+    temp_dest.h = img->rect.h;
   }
 
-  if ( src != NULL )
-  {
-    temp_src = (SDL_Rect){ .x = src->x,
-      .y = src->y,
-      .w = src->w,
-      .h = src->h };
-  }
-  
-  else
+  IMAGE_TOUCH( img );
+  RENDER_STATS_DRAW( img->texture, 4 );
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)temp_dest.w * temp_dest.h );
+
+  // Whole-texture copy: no source rect for SDL to clip or convert
+  if ( src == NULL && img->atlas_page < 0 )
   {
-    SDL_QueryTexture( img->texture, NULL, NULL, &temp_src.w, &temp_src.h );
+    SDL_RenderCopy( app.renderer, img->texture, NULL, &temp_dest );
+    return;
   }
 
+  aRectf_t s = a_ImageSourceRect( img, src );
+  temp_src = (SDL_Rect){ s.x, s.y, s.w, s.h };
+
   SDL_RenderCopy( app.renderer, img->texture, &temp_src, &temp_dest );
 }
 
 void a_BlitSurfaceToSurfaceScaled( aImage_t* src, aImage_t* dest,
                                    aRectf_t dest_rect, int scale )
 {
-  SDL_Rect temp_rect = (SDL_Rect){
-    .x = dest_rect.x,
-    .y = dest_rect.y,
-    .w = dest_rect.w * scale,
-    .h = dest_rect.h * scale,
-  };
-
-  if ( scale )
+  if ( src == NULL || dest == NULL ) return;
+
+  SDL_Surface* src_surface = a_ImageGetSurface( src );
+  SDL_Surface* surface = a_ImageGetSurface( dest );
+  if ( src_surface == NULL || surface == NULL ) return;
+
+  SDL_Rect old_clip;
+  int limited = ( dest_rect.w > 0 && dest_rect.h > 0 );
+
+  // A sized dest_rect bounds the scaled image; clip to it for this blit only
+  if ( limited )
   {
-    temp_rect.w *= scale;
-    temp_rect.h *= scale;
+    SDL_Rect limit = { (int)dest_rect.x, (int)dest_rect.y, (int)dest_rect.w, (int)dest_rect.h };
+    SDL_GetClipRect( surface, &old_clip );
+    SDL_IntersectRect( &limit, &old_clip, &limit );
+    SDL_SetClipRect( surface, &limit );
   }
 
-  SDL_BlitSurface( src->surface, NULL, dest->surface, &temp_rect );
+  a_BlitSurfaceScaled( src_surface, NULL, surface, (int)dest_rect.x, (int)dest_rect.y, scale );
+
+  if ( limited )
+  {
+    SDL_SetClipRect( surface, &old_clip );
+  }
 }
 
 void a_UpdateTitle( const char *title )
 {
+  if ( app.window == NULL ) return;
+
   SDL_SetWindowTitle( app.window, title );
 }
 
 void a_SetPixel( SDL_Surface *surface, int x, int y, aColor_t c )
 {
-  if (x < 0 || x >= surface->w || y < 0 || y >= surface->h) {
+  if ( surface == NULL || x < 0 || x >= surface->w || y < 0 || y >= surface->h )
+  {
     return;
   }
-  
-  uint32_t color;
-  color = ( c.a << 24 ) | ( c.r << 16 ) | ( c.g << 8 ) | c.b;
 
-  if (SDL_MUSTLOCK(surface)) {
-    if (SDL_LockSurface(surface) < 0) {
-      return;
-    }
-  }
-
-  Uint8 *pixel_address = (Uint8 *)surface->pixels + y * surface->pitch 
-                         + x * surface->format->BytesPerPixel;
+  // One-off writes; anything bigger should hold a session for the whole edit
+  aPixels_t px;
+  if ( a_PixelsBegin( &px, surface ) != 0 ) return;
 
-  *(Uint32 *)pixel_address = color;
-
-  if (SDL_MUSTLOCK(surface)) {
-    SDL_UnlockSurface(surface);
-  }
+  a_PixelsWrite( &px, x, y, c );
+  a_PixelsEnd( &px );
 }
 
 /**
@@ -0,0 +1,413 @@
+/*
+ * aDrawList.c:
+ *
+ * Recorded draw commands with a 64-bit sort key. Everything recorded
+ * between a_DrawListBegin() and a_DrawListEnd() is LSD radix-sorted by
+ *   layer | blend mode | texture | depth
+ * and submitted as one SDL_RenderGeometry call per run of commands that
+ * share a texture and blend mode. Radix sorting is stable, so commands
+ * with equal keys keep the order they were recorded in.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#define DRAW_LIST_INITIAL_SIZE  1024
+#define DRAW_LIST_MAX_TEXTURES  4096
+
+#define DRAW_KEY_LAYER_SHIFT    48
+#define DRAW_KEY_BLEND_SHIFT    44
+#define DRAW_KEY_TEXTURE_SHIFT  24
+#define DRAW_KEY_DEPTH_MASK     0xFFFFFFu
+
+typedef struct
+{
+  SDL_Vertex v[4];
+  SDL_Texture* texture;
+  SDL_BlendMode blend;
+} aDrawCommand_t;
+
+static aDrawCommand_t* commands = NULL;
+static uint64_t* keys = NULL;
+static uint64_t* keys_tmp = NULL;
+static uint32_t* order = NULL;
+static uint32_t* order_tmp = NULL;
+static int command_count = 0;
+static int command_max = 0;
+
+static SDL_Vertex* vertices = NULL;
+static int* indices = NULL;
+
+static SDL_Texture** textures = NULL;
+static SDL_BlendMode* texture_blends = NULL;   // Each texture's own mode, put back after the list
+static int texture_count = 0;
+static int texture_max = 0;
+static int texture_last = -1;
+
+static int list_active = 0;
+
+static int DrawListGrow( void );
+static int DrawListTextureId( SDL_Texture* texture );
+static uint64_t DrawListKey( const int layer, const SDL_BlendMode blend,
+                             const int texture_id, const uint32_t depth );
+static aDrawCommand_t* DrawListPush( SDL_Texture* texture, const SDL_BlendMode blend,
+                                     const int layer, const uint32_t depth );
+static void DrawListRadixSort( void );
+static int DrawListEmit( void );
+
+void a_DrawListBegin( void )
+{
+  command_count = 0;
+  texture_count = 0;
+  texture_last = -1;
+  list_active = 1;
+}
+
+int a_DrawListIsActive( void )
+{
+  return list_active;
+}
+
+void a_DrawListSprite( aImage_t* img, const aRectf_t* src, const aRectf_t* dest,
+                       const aColor_t color, const float angle, const SDL_RendererFlip flip,
+                       const int layer, const SDL_BlendMode blend, const uint32_t depth )
+{
+  if ( img == NULL || img->texture == NULL || img->w <= 0 || img->h <= 0 ) return;
+
+  aDrawCommand_t* cmd = DrawListPush( img->texture, blend, layer, depth );
+  if ( cmd == NULL ) return;
+
+  IMAGE_TOUCH( img );
+
+  aRectf_t s = a_ImageSourceRect( img, src );
+  aRectf_t d = dest ? *dest : (aRectf_t){ 0, 0, s.w, s.h };
+
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)( d.w * d.h ) );
+
+  a_SpriteBatchQuad( cmd->v, s, img->w, img->h, d, color, angle, flip );
+}
+
+void a_DrawListFilledRect( const aRectf_t rect, const aColor_t color, const int layer,
+                           const SDL_BlendMode blend, const uint32_t depth )
+{
+  if ( rect.w <= 0 || rect.h <= 0 ) return;
+
+  aDrawCommand_t* cmd = DrawListPush( NULL, blend, layer, depth );
+  if ( cmd == NULL ) return;
+
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)( rect.w * rect.h ) );
+
+  SDL_Color c = { color.r, color.g, color.b, color.a };
+
+  cmd->v[0] = (SDL_Vertex){ { rect.x,          rect.y          }, c, { 0, 0 } };
+  cmd->v[1] = (SDL_Vertex){ { rect.x + rect.w, rect.y          }, c, { 0, 0 } };
+  cmd->v[2] = (SDL_Vertex){ { rect.x + rect.w, rect.y + rect.h }, c, { 0, 0 } };
+  cmd->v[3] = (SDL_Vertex){ { rect.x,          rect.y + rect.h }, c, { 0, 0 } };
+}
+
+int a_DrawListEnd( void )
+{
+  if ( !list_active ) return 0;
+
+  list_active = 0;
+
+  if ( command_count == 0 ) return 0;
+
+  // Primitives queued before the list must land underneath it
+  a_DrawFlush();
+
+  DrawListRadixSort();
+
+  int calls = DrawListEmit();
+
+  command_count = 0;
+
+  return calls;
+}
+
+void a_DrawListCleanUp( void )
+{
+  free( commands );
+  free( keys );
+  free( keys_tmp );
+  free( order );
+  free( order_tmp );
+  free( vertices );
+  free( indices );
+  free( textures );
+  free( texture_blends );
+
+  commands = NULL;
+  keys = keys_tmp = NULL;
+  order = order_tmp = NULL;
+  vertices = NULL;
+  indices = NULL;
+  textures = NULL;
+  texture_blends = NULL;
+  command_count = command_max = 0;
+  texture_count = texture_max = 0;
+  texture_last = -1;
+  list_active = 0;
+}
+
+static aDrawCommand_t* DrawListPush( SDL_Texture* texture, const SDL_BlendMode blend,
+                                     const int layer, const uint32_t depth )
+{
+  if ( !list_active )
+  {
+    LOG( "a_DrawList command recorded outside a_DrawListBegin/End" );
+    return NULL;
+  }
+
+  int texture_id = DrawListTextureId( texture );
+  if ( texture_id < 0 )
+  {
+    // Texture table is full: draw what we have and start a new list
+    a_DrawListEnd();
+    a_DrawListBegin();
+    texture_id = DrawListTextureId( texture );
+  }
+
+  if ( command_count == command_max && DrawListGrow() )
+  {
+    return NULL;
+  }
+
+  aDrawCommand_t* cmd = &commands[command_count];
+  cmd->texture = texture;
+  cmd->blend = blend;
+
+  keys[command_count]  = DrawListKey( layer, blend, texture_id, depth );
+  order[command_count] = (uint32_t)command_count;
+  command_count++;
+
+  return cmd;
+}
+
+/*
+ * Ids follow first use within the list; 0 is reserved for untextured
+ * commands so they sort ahead of textured ones in the same blend group.
+ */
+static int DrawListTextureId( SDL_Texture* texture )
+{
+  if ( texture == NULL ) return 0;
+
+  // Runs of the same texture are the common case
+  if ( texture_last >= 0 && textures[texture_last] == texture ) return texture_last + 1;
+
+  for ( int i = texture_count - 1; i >= 0; i-- )
+  {
+    if ( textures[i] == texture )
+    {
+      texture_last = i;
+      return i + 1;
+    }
+  }
+
+  if ( texture_count == DRAW_LIST_MAX_TEXTURES ) return -1;
+
+  if ( texture_count == texture_max )
+  {
+    int new_max = texture_max ? texture_max * 2 : 64;
+    SDL_Texture** new_textures = realloc( textures, sizeof( SDL_Texture* ) * new_max );
+    if ( new_textures != NULL ) textures = new_textures;
+
+    SDL_BlendMode* new_blends = realloc( texture_blends, sizeof( SDL_BlendMode ) * new_max );
+    if ( new_blends != NULL ) texture_blends = new_blends;
+
+    if ( new_textures == NULL || new_blends == NULL )
+    {
+      LOG( "Failed to grow the draw list texture table" );
+      return -1;
+    }
+    texture_max = new_max;
+  }
+
+  textures[texture_count] = texture;
+  texture_last = texture_count;
+
+  return ++texture_count;
+}
+
+static uint64_t DrawListKey( const int layer, const SDL_BlendMode blend,
+                             const int texture_id, const uint32_t depth )
+{
+  uint64_t blend_index;
+
+  switch ( blend )
+  {
+    case SDL_BLENDMODE_NONE:  blend_index = 0;  break;
+    case SDL_BLENDMODE_BLEND: blend_index = 1;  break;
+    case SDL_BLENDMODE_ADD:   blend_index = 2;  break;
+    case SDL_BLENDMODE_MOD:   blend_index = 3;  break;
+    case SDL_BLENDMODE_MUL:   blend_index = 4;  break;
+    default:                  blend_index = 15; break;   // Custom modes
+  }
+
+  // Bias the signed layer so negative layers sort first
+  int clamped = MAX( -32768, MIN( layer, 32767 ) );
+  uint64_t biased = (uint64_t)( clamped + 32768 );
+
+  return ( biased << DRAW_KEY_LAYER_SHIFT ) |
+         ( blend_index << DRAW_KEY_BLEND_SHIFT ) |
+         ( (uint64_t)texture_id << DRAW_KEY_TEXTURE_SHIFT ) |
+         ( MIN( depth, DRAW_KEY_DEPTH_MASK ) );
+}
+
+static int DrawListGrow( void )
+{
+  int new_max = command_max ? command_max * 2 : DRAW_LIST_INITIAL_SIZE;
+
+  aDrawCommand_t* new_commands = realloc( commands, sizeof( aDrawCommand_t ) * new_max );
+  if ( new_commands == NULL )
+  {
+    LOG( "Failed to grow the draw list" );
+    return 1;
+  }
+  commands = new_commands;
+
+  uint64_t* new_keys = realloc( keys, sizeof( uint64_t ) * new_max );
+  uint64_t* new_keys_tmp = realloc( keys_tmp, sizeof( uint64_t ) * new_max );
+  if ( new_keys != NULL ) keys = new_keys;
+  if ( new_keys_tmp != NULL ) keys_tmp = new_keys_tmp;
+
+  uint32_t* new_order = realloc( order, sizeof( uint32_t ) * new_max );
+  uint32_t* new_order_tmp = realloc( order_tmp, sizeof( uint32_t ) * new_max );
+  if ( new_order != NULL ) order = new_order;
+  if ( new_order_tmp != NULL ) order_tmp = new_order_tmp;
+
+  SDL_Vertex* new_vertices = realloc( vertices, sizeof( SDL_Vertex ) * new_max * 4 );
+  if ( new_vertices != NULL ) vertices = new_vertices;
+
+  int* new_indices = realloc( indices, sizeof( int ) * new_max * 6 );
+  if ( new_indices != NULL ) indices = new_indices;
+
+  if ( !new_keys || !new_keys_tmp || !new_order || !new_order_tmp || !new_vertices || !new_indices )
+  {
+    LOG( "Failed to grow the draw list" );
+    return 1;
+  }
+
+  a_SpriteBatchQuadIndices( indices, command_max, new_max );
+
+  command_max = new_max;
+
+  return 0;
+}
+
+/*
+ * LSD radix sort of (key, command index) pairs, one byte per pass. All
+ * eight histograms are built in a single read, and passes where every
+ * key has the same byte (usually most of them) are skipped outright.
+ */
+static void DrawListRadixSort( void )
+{
+  const int n = command_count;
+  uint32_t histogram[8][256];
+
+  memset( histogram, 0, sizeof( histogram ) );
+
+  for ( int i = 0; i < n; i++ )
+  {
+    uint64_t k = keys[i];
+    for ( int pass = 0; pass < 8; pass++ )
+    {
+      histogram[pass][( k >> ( pass * 8 ) ) & 0xFF]++;
+    }
+  }
+
+  uint64_t* src_keys  = keys;
+  uint64_t* dst_keys  = keys_tmp;
+  uint32_t* src_order = order;
+  uint32_t* dst_order = order_tmp;
+
+  for ( int pass = 0; pass < 8; pass++ )
+  {
+    const int shift = pass * 8;
+    uint32_t* count = histogram[pass];
+
+    if ( count[( src_keys[0] >> shift ) & 0xFF] == (uint32_t)n ) continue;
+
+    uint32_t offset = 0;
+    for ( int b = 0; b < 256; b++ )
+    {
+      uint32_t c = count[b];
+      count[b] = offset;
+      offset += c;
+    }
+
+    for ( int i = 0; i < n; i++ )
+    {
+      uint32_t slot = count[( src_keys[i] >> shift ) & 0xFF]++;
+      dst_keys[slot]  = src_keys[i];
+      dst_order[slot] = src_order[i];
+    }
+
+    uint64_t* tk = src_keys;  src_keys = dst_keys;   dst_keys = tk;
+    uint32_t* to = src_order; src_order = dst_order; dst_order = to;
+  }
+
+  // Leave the result in the primary arrays
+  if ( src_keys != keys )
+  {
+    memcpy( keys, src_keys, sizeof( uint64_t ) * n );
+    memcpy( order, src_order, sizeof( uint32_t ) * n );
+  }
+}
+
+static int DrawListEmit( void )
+{
+  int calls = 0;
+  int run_start = 0;
+
+  // Texture blend mode is object state; plain blits expect it back afterwards
+  for ( int i = 0; i < texture_count; i++ )
+  {
+    texture_blends[i] = a_RenderStateGetTextureBlendMode( textures[i] );
+  }
+
+  for ( int i = 0; i < command_count; i++ )
+  {
+    const aDrawCommand_t* cmd = &commands[order[i]];
+
+    memcpy( &vertices[i * 4], cmd->v, sizeof( cmd->v ) );
+
+    int last = ( i + 1 == command_count );
+    if ( !last )
+    {
+      const aDrawCommand_t* next = &commands[order[i + 1]];
+      if ( next->texture == cmd->texture && next->blend == cmd->blend ) continue;
+    }
+
+    int run_count = i + 1 - run_start;
+
+    if ( cmd->texture == NULL )
+    {
+      a_RenderStateSetBlendMode( cmd->blend );
+    }
+    else
+    {
+      a_RenderStateSetTextureBlendMode( cmd->texture, cmd->blend );
+    }
+
+    SDL_RenderGeometry( app.renderer, cmd->texture, &vertices[run_start * 4], run_count * 4,
+                        indices, run_count * 6 );
+    RENDER_STATS_DRAW( cmd->texture, run_count * 4 );
+    calls++;
+
+    run_start = i + 1;
+  }
+
+  for ( int i = 0; i < texture_count; i++ )
+  {
+    a_RenderStateSetTextureBlendMode( textures[i], texture_blends[i] );
+  }
+
+  return calls;
+}
+
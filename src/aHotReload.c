@@ -0,0 +1,299 @@
+/*
+ * aHotReload.c:
+ *
+ * Development-time asset reloading. An inotify descriptor watches the
+ * directories holding cached images and registered files; a_HotReloadPoll()
+ * drains it once per frame. Changed images are decoded again on the loader
+ * threads and swapped in place behind the existing aImage_t, so nothing
+ * holding the pointer notices. Other files (fonts, widget layouts) run the
+ * callback they were registered with.
+ *
+ * Only IN_CLOSE_WRITE and IN_MOVED_TO are watched: editors either rewrite
+ * a file and close it or write a temp file and rename it over the original,
+ * and both land after the file is complete.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define HOT_RELOAD_EVENTS    ( IN_CLOSE_WRITE | IN_MOVED_TO )
+#define HOT_RELOAD_MAX_BATCH 32   // Distinct paths handled per poll
+
+typedef struct
+{
+  char dir[MAX_FILENAME_LENGTH];
+  int wd;                         // -1 until the service is running
+} aHotReloadDir_t;
+
+typedef struct
+{
+  char path[MAX_FILENAME_LENGTH];
+  aHotReloadCallback_t callback;
+  void* user;
+} aHotReloadFile_t;
+
+static int notify_fd = -1;
+
+static aHotReloadDir_t dirs[HOT_RELOAD_MAX_DIRS];
+static int dir_count = 0;
+
+static aHotReloadFile_t files[HOT_RELOAD_MAX_FILES];
+static int file_count = 0;
+
+static int HotReloadAddDir( const char* path );
+static void HotReloadAddWatch( aHotReloadDir_t* dir );
+static void HotReloadQueue( char batch[][MAX_FILENAME_LENGTH], int* count,
+                            const char* dir, const char* name );
+
+int a_HotReloadInit( void )
+{
+  if ( notify_fd >= 0 ) return 0;
+
+  notify_fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  if ( notify_fd < 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to start hot reload: %s",
+             log_level_strings[new_error.error_type], strerror( errno ) );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  // Everything registered before now
+  for ( int i = 0; i < dir_count; i++ )
+  {
+    HotReloadAddWatch( &dirs[i] );
+  }
+
+  return 0;
+}
+
+int a_HotReloadWatch( const char* path, aHotReloadCallback_t callback, void* user )
+{
+  if ( path == NULL || path[0] == '\0' ) return 1;
+
+  if ( HotReloadAddDir( path ) != 0 ) return 1;
+
+  if ( callback == NULL ) return 0;
+
+  for ( int i = 0; i < file_count; i++ )
+  {
+    if ( files[i].callback == callback && files[i].user == user &&
+         strcmp( files[i].path, path ) == 0 )
+    {
+      return 0;
+    }
+  }
+
+  if ( file_count == HOT_RELOAD_MAX_FILES )
+  {
+    LOG( "Too many hot reload files, raise HOT_RELOAD_MAX_FILES" );
+    return 1;
+  }
+
+  aHotReloadFile_t* file = &files[file_count++];
+  STRNCPY( file->path, path, MAX_FILENAME_LENGTH );
+  file->callback = callback;
+  file->user = user;
+
+  return 0;
+}
+
+void a_HotReloadPoll( void )
+{
+  if ( notify_fd < 0 ) return;
+
+  char buffer[4096] __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+  char batch[HOT_RELOAD_MAX_BATCH][MAX_FILENAME_LENGTH];
+  int count = 0;
+
+  // Nothing changed costs exactly this one read, which fails with EAGAIN
+  ssize_t length;
+  while ( ( length = read( notify_fd, buffer, sizeof( buffer ) ) ) > 0 )
+  {
+    for ( char* p = buffer; p < buffer + length; )
+    {
+      const struct inotify_event* event = (const struct inotify_event*)p;
+      p += sizeof( struct inotify_event ) + event->len;
+
+      if ( event->mask & IN_Q_OVERFLOW )
+      {
+        LOG( "Hot reload queue overflowed, some changes were missed" );
+        continue;
+      }
+
+      if ( event->len == 0 || !( event->mask & HOT_RELOAD_EVENTS ) ) continue;
+
+      // The same directory spelled two ways shares a watch descriptor
+      for ( int i = 0; i < dir_count; i++ )
+      {
+        if ( dirs[i].wd == event->wd )
+        {
+          HotReloadQueue( batch, &count, dirs[i].dir, event->name );
+        }
+      }
+    }
+  }
+
+  // Saves usually arrive as several events; each path is handled once
+  for ( int i = 0; i < count; i++ )
+  {
+    a_ImageReload( batch[i] );
+
+    // Callbacks may register more files, so file_count is read every pass
+    for ( int j = 0; j < file_count; j++ )
+    {
+      if ( strcmp( files[j].path, batch[i] ) == 0 )
+      {
+        files[j].callback( batch[i], files[j].user );
+      }
+    }
+  }
+}
+
+void a_HotReloadCleanUp( void )
+{
+  if ( notify_fd >= 0 )
+  {
+    // Closing the descriptor drops every watch on it
+    close( notify_fd );
+    notify_fd = -1;
+  }
+
+  dir_count = 0;
+  file_count = 0;
+}
+
+static int HotReloadAddDir( const char* path )
+{
+  char dir[MAX_FILENAME_LENGTH];
+  const char* slash = strrchr( path, '/' );
+
+  if ( slash == NULL )
+  {
+    STRNCPY( dir, ".", MAX_FILENAME_LENGTH );
+  }
+  else
+  {
+    // Keep the slash for files in the root, "/" rather than ""
+    size_t length = ( slash == path ) ? 1 : (size_t)( slash - path );
+    if ( length >= MAX_FILENAME_LENGTH ) return 1;
+
+    memcpy( dir, path, length );
+    dir[length] = '\0';
+  }
+
+  for ( int i = 0; i < dir_count; i++ )
+  {
+    if ( strcmp( dirs[i].dir, dir ) == 0 ) return 0;
+  }
+
+  if ( dir_count == HOT_RELOAD_MAX_DIRS )
+  {
+    // Every cached image registers its directory; only complain when it matters
+    if ( notify_fd >= 0 )
+    {
+      LOG( "Too many hot reload directories, raise HOT_RELOAD_MAX_DIRS" );
+    }
+    return 1;
+  }
+
+  aHotReloadDir_t* entry = &dirs[dir_count++];
+  STRNCPY( entry->dir, dir, MAX_FILENAME_LENGTH );
+  entry->wd = -1;
+
+  if ( notify_fd >= 0 )
+  {
+    HotReloadAddWatch( entry );
+  }
+
+  return 0;
+}
+
+static void HotReloadAddWatch( aHotReloadDir_t* dir )
+{
+  dir->wd = inotify_add_watch( notify_fd, dir->dir, HOT_RELOAD_EVENTS );
+  if ( dir->wd < 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to watch %s: %s",
+             log_level_strings[new_error.error_type], dir->dir, strerror( errno ) );
+    LOG( new_error.error_msg );
+  }
+}
+
+/*
+ * Rebuilds the path the way it was registered ("dir/name", or just "name"
+ * for the working directory) so it matches the image cache key exactly.
+ */
+static void HotReloadQueue( char batch[][MAX_FILENAME_LENGTH], int* count,
+                            const char* dir, const char* name )
+{
+  char path[MAX_FILENAME_LENGTH];
+  int length;
+
+  if ( strcmp( dir, "." ) == 0 )
+  {
+    length = snprintf( path, sizeof( path ), "%s", name );
+  }
+  else if ( strcmp( dir, "/" ) == 0 )
+  {
+    length = snprintf( path, sizeof( path ), "/%s", name );
+  }
+  else
+  {
+    length = snprintf( path, sizeof( path ), "%s/%s", dir, name );
+  }
+
+  if ( length < 0 || length >= (int)sizeof( path ) ) return;
+
+  for ( int i = 0; i < *count; i++ )
+  {
+    if ( strcmp( batch[i], path ) == 0 ) return;
+  }
+
+  // Anything past the batch is picked up by the next save
+  if ( *count == HOT_RELOAD_MAX_BATCH ) return;
+
+  memcpy( batch[( *count )++], path, (size_t)length + 1 );
+}
+
+#else
+
+int a_HotReloadInit( void )
+{
+  LOG( "Hot reload is only available on Linux" );
+  return 1;
+}
+
+int a_HotReloadWatch( const char* path, aHotReloadCallback_t callback, void* user )
+{
+  (void)path;
+  (void)callback;
+  (void)user;
+
+  return 0;
+}
+
+void a_HotReloadPoll( void )
+{
+}
+
+void a_HotReloadCleanUp( void )
+{
+}
+
+#endif
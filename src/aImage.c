@@ -10,153 +10,1528 @@
  *                    Mathew Storm <smattymat@gmail.com>
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <SDL2/SDL_image.h>
 
 #include "Archimedes.h"
 
-static int a_CacheImage( aImageCache_t* head, aImage_t* img );
-static aImage_t* a_GetImageFromCacheByFilename( aImageCache_t* head,
+#define IMAGE_CACHE_INITIAL_SIZE 64
+#define IMAGE_CACHE_MAX_LOAD     70  // Percent full before the table doubles
+
+typedef struct _aImageJob_t
+{
+  aImage_t* img;                        // Main thread only; workers read filename
+  char filename[MAX_FILENAME_LENGTH];
+  int flags;
+  SDL_Surface* surface;                 // Set by the worker, NULL if decoding failed
+  float decode_ms;
+  int reload;                           // Hot reload of a ready image; see a_ImageReload()
+  aImageLoadCallback_t callback;
+  void* user;
+  struct _aImageJob_t* next;
+} aImageJob_t;
+
+// Jobs move from the decode queue to the done queue under async_lock
+static aImageJob_t* decode_head = NULL;
+static aImageJob_t* decode_tail = NULL;
+static aImageJob_t* done_head = NULL;
+static aImageJob_t* done_tail = NULL;
+static aImageJob_t* waiters = NULL;     // Extra callbacks on pending images, main thread only
+
+static SDL_Thread* async_workers[IMAGE_ASYNC_MAX_WORKERS];
+static int async_worker_count = 0;
+static SDL_mutex* async_lock = NULL;
+static SDL_cond* async_work_cond = NULL;
+static SDL_cond* async_done_cond = NULL;
+static int async_ready = 0;
+static int async_quit = 0;
+static int async_pending = 0;
+static size_t async_upload_budget = IMAGE_ASYNC_UPLOAD_BUDGET;
+
+static int ImageAsyncInit( void );
+static int ImageAsyncWorker( void* data );
+static int ImageAsyncQueue( aImage_t* img, const int flags, const int reload,
+                            aImageLoadCallback_t callback, void* user );
+static void ImageAsyncDecode( aImageJob_t* job );
+static float ImageElapsedMs( const Uint64 start );
+static void ImageAsyncWait( aImage_t* img );
+static void ImageAsyncFinish( aImageJob_t* job );
+static void ImageSwap( aImage_t* img, SDL_Surface* surface );
+static void ImageSetup( aImage_t* img, SDL_Surface* surface, const int flags );
+static void ImageRetry( aImage_t* img, SDL_Surface* surface, const int flags );
+static void ImageLruPush( aImageCache_t* cache, aImage_t* img );
+static void ImageLruUnlink( aImageCache_t* cache, aImage_t* img );
+static int ImageCacheGrow( aImageCache_t* cache );
+static void ImageCacheEvict( aImageCache_t* cache );
+static void ImageFree( aImage_t* img );
+static size_t ImageBytes( const aImage_t* img );
+static size_t ImageSurfaceBytes( const aImage_t* img );
+static size_t ImageTextureBytes( const aImage_t* img );
+static void ImageCacheCountLoad( const aImage_t* img );
+static int ImageCacheSorted( aImageCache_t* cache, aImage_t*** sorted );
+static int ImageBytesCompare( const void* a, const void* b );
+static void ImageCacheFormatRow( char* line, const size_t size, const aImage_t* img );
+static int a_CacheImage( aImageCache_t* cache, aImage_t* img );
+static aImage_t* a_GetImageFromCacheByFilename( aImageCache_t* cache,
                                                    const char* filename );
 
-int a_ImageInit( void )
-{
-  app.img_cache = ( aImageCache_t* )malloc( sizeof( aImageCache_t ) );
-  if ( app.img_cache == NULL )
+int a_ImageInit( void )
+{
+  app.img_cache = ( aImageCache_t* )malloc( sizeof( aImageCache_t ) );
+  if ( app.img_cache == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = FATAL;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to allocate memory for cache",
+              log_level_strings[new_error.error_type] );
+    LOG( new_error.error_msg );
+
+    return 1;
+  }
+
+  *app.img_cache = (aImageCache_t){ 0 };
+  app.img_cache->budget = IMAGE_CACHE_DEFAULT_BUDGET;
+
+  return ImageCacheGrow( app.img_cache );
+}
+
+aImage_t* a_ImageLoad( const char *filename )
+{
+  return a_ImageLoadEx( filename, IMAGE_LOAD_DEFAULT );
+}
+
+aImage_t* a_ImageLoadEx( const char *filename, const int flags )
+{
+  aImage_t *img = NULL;
+
+  img = a_GetImageFromCacheByFilename( app.img_cache, filename );
+
+  // Already on its way in the background; finish that rather than decode twice
+  if ( img != NULL && img->state == IMAGE_STATE_PENDING )
+  {
+    ImageAsyncWait( img );
+  }
+
+  if ( img != NULL && ( img->surface != NULL || img->texture != NULL ) )
+  {
+    app.img_cache->hits++;
+    return a_ImageAcquire( img );
+  }
+
+  if ( app.img_cache != NULL ) app.img_cache->misses++;
+
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  SDL_Surface* surface = a_ImageDecode( filename );
+  if ( surface == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = FATAL;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to load image: %s, %s",
+             log_level_strings[new_error.error_type], filename, SDL_GetError() );
+    LOG( new_error.error_msg );
+
+    return NULL;
+  }
+
+  float decode_ms = ImageElapsedMs( start );
+
+  // A failed async load left a placeholder that callers may already hold
+  if ( img != NULL )
+  {
+    a_ImageAcquire( img );
+    ImageRetry( img, surface, flags );
+  }
+  else
+  {
+    img = a_ImageCreate( filename, surface, flags );
+  }
+
+  if ( img != NULL )
+  {
+    img->decode_ms = decode_ms;
+    ImageCacheCountLoad( img );
+  }
+
+  return img;
+}
+
+static int ImageHeightCompare( const void* a, const void* b )
+{
+  const SDL_Surface* sa = *(SDL_Surface* const*)a;
+  const SDL_Surface* sb = *(SDL_Surface* const*)b;
+
+  if ( sa == NULL || sb == NULL ) return ( sa == NULL ) - ( sb == NULL );
+
+  return sb->h - sa->h;
+}
+
+int a_ImageLoadAtlas( const char** filenames, const int count )
+{
+  if ( filenames == NULL || count <= 0 ) return 1;
+
+  // Surfaces and names travel together so the sort keeps them paired
+  struct { SDL_Surface* surface; const char* filename; float decode_ms; }* entries =
+    malloc( sizeof( *entries ) * count );
+  if ( entries == NULL )
+  {
+    LOG( "Failed to allocate memory for atlas registration" );
+    return 1;
+  }
+
+  int failed = 0;
+  for ( int i = 0; i < count; i++ )
+  {
+    entries[i].filename = filenames[i];
+    entries[i].surface = NULL;
+
+    // Listed twice: the first entry already decodes it
+    int seen = 0;
+    for ( int j = 0; j < i && !seen; j++ )
+    {
+      seen = ( strcmp( filenames[j], filenames[i] ) == 0 );
+    }
+    if ( seen ) continue;
+
+    aImage_t* cached = a_GetImageFromCacheByFilename( app.img_cache, filenames[i] );
+    if ( cached != NULL && cached->state == IMAGE_STATE_PENDING )
+    {
+      ImageAsyncWait( cached );
+    }
+
+    if ( cached != NULL && ( cached->surface != NULL || cached->texture != NULL ) )
+    {
+      app.img_cache->hits++;
+      continue;
+    }
+
+    if ( app.img_cache != NULL ) app.img_cache->misses++;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    entries[i].surface = a_ImageDecode( filenames[i] );
+    entries[i].decode_ms = ImageElapsedMs( start );
+
+    if ( entries[i].surface == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to load image: %s, %s",
+               log_level_strings[new_error.error_type], filenames[i], SDL_GetError() );
+      LOG( new_error.error_msg );
+      failed = 1;
+    }
+  }
+
+  // Tallest first packs noticeably tighter on a skyline
+  qsort( entries, count, sizeof( *entries ), ImageHeightCompare );
+
+  for ( int i = 0; i < count; i++ )
+  {
+    if ( entries[i].surface == NULL ) continue;
+
+    // Nobody holds these yet; the atlas keeps them resident regardless
+    aImage_t* img = a_GetImageFromCacheByFilename( app.img_cache, entries[i].filename );
+    if ( img != NULL )
+    {
+      // A failed async placeholder; fill it rather than displace it
+      a_ImageAcquire( img );
+      ImageRetry( img, entries[i].surface, IMAGE_LOAD_ATLAS );
+    }
+    else
+    {
+      img = a_ImageCreate( entries[i].filename, entries[i].surface, IMAGE_LOAD_ATLAS );
+    }
+
+    if ( img == NULL )
+    {
+      failed = 1;
+    }
+    else
+    {
+      img->decode_ms = entries[i].decode_ms;
+      ImageCacheCountLoad( img );
+    }
+
+    a_ImageRelease( img );
+  }
+
+  free( entries );
+
+  a_AtlasPrintStats();
+
+  return failed;
+}
+
+aImage_t* a_ImageCreate( const char* filename, SDL_Surface* surface, const int flags )
+{
+  aImage_t* img = malloc( sizeof( aImage_t ) );
+  if ( img == NULL )
+  {
+    LOG( "Failed to allocate memory for img" );
+    SDL_FreeSurface( surface );
+    return NULL;
+  }
+
+  *img = (aImage_t){ 0 };
+  img->filename = strndup( filename, MAX_FILENAME_LENGTH );
+  img->atlas_page = -1;
+  img->refcount = 1;
+
+  ImageSetup( img, surface, flags );
+
+  if ( app.img_cache != NULL && a_CacheImage( app.img_cache, img ) == 0 )
+  {
+    app.img_cache->resident_bytes += img->bytes;
+    ImageCacheEvict( app.img_cache );
+  }
+
+  return img;
+}
+
+/*
+ * Gives a fresh (or placeholder) image its texture. Main thread only, as
+ * SDL_CreateTextureFromSurface must be.
+ */
+static void ImageSetup( aImage_t* img, SDL_Surface* surface, const int flags )
+{
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  img->surface = surface;
+  img->texture = NULL;
+  img->rect = (aRecti_t){ 0, 0, surface->w, surface->h };
+  img->atlas_page = -1;
+
+  img->w = 0;
+  img->h = 0;
+  img->format = SDL_PIXELFORMAT_UNKNOWN;
+  img->access = SDL_TEXTUREACCESS_STATIC;
+  img->state = IMAGE_STATE_READY;
+
+  if ( !( flags & IMAGE_LOAD_ATLAS ) || a_AtlasAddImage( img ) != 0 )
+  {
+    img->texture = a_SurfaceToTexture( surface, 0 );
+
+    // The only query this texture ever gets; blits read the cached fields
+    if ( img->texture != NULL )
+    {
+      SDL_QueryTexture( img->texture, &img->format, &img->access, &img->w, &img->h );
+    }
+  }
+
+  // The texture (or atlas page) holds the pixels now; a_ImageGetSurface()
+  // brings the surface back from disk if anything on the CPU needs it
+  if ( ( flags & IMAGE_LOAD_DROP_SURFACE ) && img->texture != NULL )
+  {
+    SDL_FreeSurface( img->surface );
+    img->surface = NULL;
+  }
+
+  img->bytes = ImageBytes( img );
+  img->upload_ms = ImageElapsedMs( start );
+}
+
+/*
+ * Loads into a cached IMAGE_STATE_FAILED placeholder instead of creating
+ * a second image, so handles already given out turn READY with it.
+ */
+static void ImageRetry( aImage_t* img, SDL_Surface* surface, const int flags )
+{
+  ImageSetup( img, surface, flags );
+
+  if ( app.img_cache != NULL )
+  {
+    app.img_cache->resident_bytes += img->bytes;
+    ImageCacheEvict( app.img_cache );
+  }
+}
+
+aImage_t* a_ImageLoadAsync( const char* filename, const int flags,
+                            aImageLoadCallback_t callback, void* user )
+{
+  if ( filename == NULL ) return NULL;
+
+  aImage_t* img = a_GetImageFromCacheByFilename( app.img_cache, filename );
+
+  if ( img != NULL && img->state != IMAGE_STATE_FAILED )
+  {
+    app.img_cache->hits++;
+    a_ImageAcquire( img );
+
+    if ( img->state == IMAGE_STATE_READY )
+    {
+      if ( callback != NULL ) callback( img, user );
+      return img;
+    }
+
+    // Already decoding; only the callback needs to ride along
+    if ( callback != NULL )
+    {
+      aImageJob_t* waiter = calloc( 1, sizeof( aImageJob_t ) );
+      if ( waiter == NULL )
+      {
+        LOG( "Failed to allocate memory for an image load callback" );
+        return img;
+      }
+
+      waiter->img = img;
+      waiter->callback = callback;
+      waiter->user = user;
+      waiter->next = waiters;
+      waiters = waiter;
+    }
+
+    return img;
+  }
+
+  if ( app.img_cache != NULL ) app.img_cache->misses++;
+
+  if ( img != NULL )
+  {
+    // Failed before; try the file again in place
+    a_ImageAcquire( img );
+  }
+  else
+  {
+    img = malloc( sizeof( aImage_t ) );
+    if ( img == NULL )
+    {
+      LOG( "Failed to allocate memory for img" );
+      return NULL;
+    }
+
+    *img = (aImage_t){ 0 };
+    img->filename = strndup( filename, MAX_FILENAME_LENGTH );
+    img->atlas_page = -1;
+    img->refcount = 1;
+
+    // Cached right away so repeat requests find the placeholder
+    if ( a_CacheImage( app.img_cache, img ) != 0 )
+    {
+      free( img->filename );
+      free( img );
+      return NULL;
+    }
+  }
+
+  img->state = IMAGE_STATE_PENDING;
+
+  if ( ImageAsyncQueue( img, flags, 0, callback, user ) != 0 )
+  {
+    img->state = IMAGE_STATE_FAILED;
+    if ( callback != NULL ) callback( img, user );
+  }
+
+  return img;
+}
+
+int a_ImageIsReady( const aImage_t* img )
+{
+  return img != NULL && img->state == IMAGE_STATE_READY && img->texture != NULL;
+}
+
+int a_ImageReload( const char* filename )
+{
+  if ( filename == NULL || app.img_cache == NULL ) return 1;
+
+  aImage_t* img = a_GetImageFromCacheByFilename( app.img_cache, filename );
+
+  // Never loaded, or still on its first trip through the loader
+  if ( img == NULL || img->state != IMAGE_STATE_READY ) return 1;
+
+  // Held by the job so eviction can't free it mid-decode
+  a_ImageAcquire( img );
+
+  if ( ImageAsyncQueue( img, 0, 1, NULL, NULL ) != 0 )
+  {
+    a_ImageRelease( img );
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Puts freshly decoded pixels behind an image that is already in use, so
+ * every sprite, animation and widget holding the aImage_t picks them up on
+ * its next draw. An atlased image of the same size is rewritten in place
+ * on its page; anything else gets its own texture, replacing the old one.
+ */
+static void ImageSwap( aImage_t* img, SDL_Surface* surface )
+{
+  SDL_Surface* old_surface = img->surface;
+  img->surface = surface;
+
+  int uploaded = 0;
+  if ( img->atlas_page >= 0 && img->rect.w == surface->w && img->rect.h == surface->h )
+  {
+    uploaded = ( a_ImageUploadRect( img, NULL ) == 0 );
+  }
+
+  if ( !uploaded )
+  {
+    SDL_Texture* texture = a_SurfaceToTexture( surface, 0 );
+    if ( texture == NULL )
+    {
+      SDL_FreeSurface( surface );
+      img->surface = old_surface;
+      return;
+    }
+
+    // An outgrown atlas slot just sits unused until a_AtlasCleanUp()
+    if ( img->texture != NULL && img->atlas_page < 0 )
+    {
+      a_RenderStateForgetTexture( img->texture );
+      SDL_DestroyTexture( img->texture );
+    }
+
+    img->texture = texture;
+    img->atlas_page = -1;
+    img->rect = (aRecti_t){ 0, 0, surface->w, surface->h };
+    SDL_QueryTexture( img->texture, &img->format, &img->access, &img->w, &img->h );
+  }
+
+  // Kept even for IMAGE_LOAD_DROP_SURFACE images: a_ImageGetSurface() would
+  // otherwise bring back the stale copy from a mounted pack
+  SDL_FreeSurface( old_surface );
+
+  size_t bytes = ImageBytes( img );
+  app.img_cache->resident_bytes += bytes - img->bytes;
+  img->bytes = bytes;
+}
+
+void a_ImageAsyncUpdate( void )
+{
+  if ( !async_ready ) return;
+
+  size_t spent = 0;
+
+  for ( ;; )
+  {
+    SDL_LockMutex( async_lock );
+
+    aImageJob_t* job = done_head;
+    if ( job != NULL )
+    {
+      size_t cost = job->surface ? (size_t)job->surface->pitch * job->surface->h : 0;
+
+      // Always let one through so a big image can't stall the queue
+      if ( spent > 0 && async_upload_budget > 0 && spent + cost > async_upload_budget )
+      {
+        job = NULL;
+      }
+      else
+      {
+        done_head = job->next;
+        if ( done_head == NULL ) done_tail = NULL;
+        spent += cost;
+      }
+    }
+
+    SDL_UnlockMutex( async_lock );
+
+    if ( job == NULL ) break;
+
+    ImageAsyncFinish( job );
+  }
+}
+
+void a_ImageAsyncSetUploadBudget( const size_t bytes )
+{
+  async_upload_budget = bytes;
+}
+
+int a_ImageAsyncPending( void )
+{
+  return async_pending;
+}
+
+void a_ImageAsyncCleanUp( void )
+{
+  if ( !async_ready ) return;
+
+  // Workers finish the file in hand and leave the rest of the queue
+  SDL_LockMutex( async_lock );
+  async_quit = 1;
+  SDL_CondBroadcast( async_work_cond );
+  SDL_UnlockMutex( async_lock );
+
+  for ( int i = 0; i < async_worker_count; i++ )
+  {
+    SDL_WaitThread( async_workers[i], NULL );
+    async_workers[i] = NULL;
+  }
+
+  aImageJob_t* lists[3] = { decode_head, done_head, waiters };
+  for ( int i = 0; i < 3; i++ )
+  {
+    aImageJob_t* job = lists[i];
+    while ( job != NULL )
+    {
+      aImageJob_t* next = job->next;
+      SDL_FreeSurface( job->surface );
+      free( job );
+      job = next;
+    }
+  }
+
+  decode_head = decode_tail = NULL;
+  done_head = done_tail = NULL;
+  waiters = NULL;
+
+  SDL_DestroyCond( async_work_cond );
+  SDL_DestroyCond( async_done_cond );
+  SDL_DestroyMutex( async_lock );
+  async_work_cond = NULL;
+  async_done_cond = NULL;
+  async_lock = NULL;
+
+  async_worker_count = 0;
+  async_pending = 0;
+  async_quit = 0;
+  async_ready = 0;
+}
+
+static int ImageAsyncInit( void )
+{
+  if ( async_ready ) return 0;
+
+  async_lock = SDL_CreateMutex();
+  async_work_cond = SDL_CreateCond();
+  async_done_cond = SDL_CreateCond();
+  if ( async_lock == NULL || async_work_cond == NULL || async_done_cond == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create image loader lock: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+
+    if ( async_lock != NULL ) SDL_DestroyMutex( async_lock );
+    if ( async_work_cond != NULL ) SDL_DestroyCond( async_work_cond );
+    if ( async_done_cond != NULL ) SDL_DestroyCond( async_done_cond );
+    async_lock = NULL;
+    async_work_cond = NULL;
+    async_done_cond = NULL;
+    return 1;
+  }
+
+  // Leave a core for the main thread
+  int wanted = SDL_GetCPUCount() - 1;
+  if ( wanted < 1 ) wanted = 1;
+  if ( wanted > IMAGE_ASYNC_MAX_WORKERS ) wanted = IMAGE_ASYNC_MAX_WORKERS;
+
+  async_quit = 0;
+  async_worker_count = 0;
+  for ( int i = 0; i < wanted; i++ )
+  {
+    SDL_Thread* worker = SDL_CreateThread( ImageAsyncWorker, "aImageLoad", NULL );
+    if ( worker == NULL ) break;
+
+    async_workers[async_worker_count++] = worker;
+  }
+
+  if ( async_worker_count == 0 )
+  {
+    LOG( "Failed to start image loader threads, images will be decoded synchronously" );
+  }
+
+  async_ready = 1;
+
+  return 0;
+}
+
+static int ImageAsyncWorker( void* data )
+{
+  (void)data;
+
+  SDL_LockMutex( async_lock );
+
+  for ( ;; )
+  {
+    while ( decode_head == NULL && !async_quit )
+    {
+      SDL_CondWait( async_work_cond, async_lock );
+    }
+
+    if ( async_quit ) break;
+
+    aImageJob_t* job = decode_head;
+    decode_head = job->next;
+    if ( decode_head == NULL ) decode_tail = NULL;
+    SDL_UnlockMutex( async_lock );
+
+    ImageAsyncDecode( job );
+    job->next = NULL;
+
+    SDL_LockMutex( async_lock );
+    if ( done_tail != NULL ) done_tail->next = job;
+    else done_head = job;
+    done_tail = job;
+    SDL_CondBroadcast( async_done_cond );
+  }
+
+  SDL_UnlockMutex( async_lock );
+
+  return 0;
+}
+
+static int ImageAsyncQueue( aImage_t* img, const int flags, const int reload,
+                            aImageLoadCallback_t callback, void* user )
+{
+  if ( ImageAsyncInit() != 0 ) return 1;
+
+  aImageJob_t* job = calloc( 1, sizeof( aImageJob_t ) );
+  if ( job == NULL )
+  {
+    LOG( "Failed to allocate memory for an image load" );
+    return 1;
+  }
+
+  job->img = img;
+  STRNCPY( job->filename, img->filename, MAX_FILENAME_LENGTH );
+  job->flags = flags;
+  job->reload = reload;
+  job->callback = callback;
+  job->user = user;
+
+  async_pending++;
+
+  // No workers (e.g. no thread support): decode now, upload on the usual schedule
+  if ( async_worker_count == 0 )
+  {
+    ImageAsyncDecode( job );
+  }
+
+  SDL_LockMutex( async_lock );
+
+  aImageJob_t** tail = ( async_worker_count == 0 ) ? &done_tail : &decode_tail;
+  aImageJob_t** head = ( async_worker_count == 0 ) ? &done_head : &decode_head;
+
+  if ( *tail != NULL ) ( *tail )->next = job;
+  else *head = job;
+  *tail = job;
+
+  SDL_CondSignal( async_work_cond );
+  SDL_UnlockMutex( async_lock );
+
+  return 0;
+}
+
+static void ImageAsyncDecode( aImageJob_t* job )
+{
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  // The file changed on disk, so a mounted pack holds the old pixels
+  job->surface = job->reload ? IMG_Load( job->filename ) : a_ImageDecode( job->filename );
+  job->decode_ms = ImageElapsedMs( start );
+}
+
+static float ImageElapsedMs( const Uint64 start )
+{
+  return (float)( ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() );
+}
+
+/*
+ * Pulls img's job out of whichever queue holds it, decoding it here if no
+ * worker has started on it, and finishes it immediately.
+ */
+static void ImageAsyncWait( aImage_t* img )
+{
+  if ( !async_ready ) return;
+
+  aImageJob_t* job = NULL;
+  int decode = 0;
+
+  SDL_LockMutex( async_lock );
+
+  while ( job == NULL )
+  {
+    aImageJob_t** heads[2] = { &done_head, &decode_head };
+    aImageJob_t** tails[2] = { &done_tail, &decode_tail };
+
+    for ( int q = 0; q < 2 && job == NULL; q++ )
+    {
+      aImageJob_t* prev = NULL;
+      for ( aImageJob_t* j = *heads[q]; j != NULL; prev = j, j = j->next )
+      {
+        if ( j->img != img || j->reload ) continue;
+
+        if ( prev != NULL ) prev->next = j->next;
+        else *heads[q] = j->next;
+        if ( *tails[q] == j ) *tails[q] = prev;
+
+        job = j;
+        decode = ( q == 1 );
+        break;
+      }
+    }
+
+    // In a worker's hands; it broadcasts when the file is decoded
+    if ( job == NULL )
+    {
+      SDL_CondWait( async_done_cond, async_lock );
+    }
+  }
+
+  SDL_UnlockMutex( async_lock );
+
+  if ( decode )
+  {
+    ImageAsyncDecode( job );
+  }
+
+  ImageAsyncFinish( job );
+}
+
+static void ImageAsyncFinish( aImageJob_t* job )
+{
+  aImage_t* img = job->img;
+
+  if ( job->reload )
+  {
+    async_pending--;
+
+    // A bad save (half-written, wrong format) keeps the pixels already up
+    if ( job->surface == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to reload image: %s",
+               log_level_strings[new_error.error_type], job->filename );
+      LOG( new_error.error_msg );
+    }
+    else
+    {
+      Uint64 start = SDL_GetPerformanceCounter();
+      ImageSwap( img, job->surface );
+      img->decode_ms = job->decode_ms;
+      img->upload_ms = ImageElapsedMs( start );
+      ImageCacheCountLoad( img );
+    }
+
+    free( job );
+
+    // Drops the hold a_ImageReload() took for the job
+    a_ImageRelease( img );
+    return;
+  }
+
+  if ( job->surface == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to load image: %s",
+             log_level_strings[new_error.error_type], job->filename );
+    LOG( new_error.error_msg );
+
+    img->state = IMAGE_STATE_FAILED;
+  }
+  else
+  {
+    ImageSetup( img, job->surface, job->flags );
+    img->decode_ms = job->decode_ms;
+    ImageCacheCountLoad( img );
+
+    if ( app.img_cache != NULL )
+    {
+      app.img_cache->resident_bytes += img->bytes;
+    }
+  }
+
+  async_pending--;
+
+  if ( job->callback != NULL ) job->callback( img, job->user );
+  free( job );
+
+  aImageJob_t** link = &waiters;
+  while ( *link != NULL )
+  {
+    aImageJob_t* waiter = *link;
+    if ( waiter->img != img )
+    {
+      link = &waiter->next;
+      continue;
+    }
+
+    *link = waiter->next;
+    waiter->callback( img, waiter->user );
+    free( waiter );
+  }
+
+  // Released while it was still loading
+  if ( img->refcount == 0 && app.img_cache != NULL && img->atlas_page < 0 )
+  {
+    ImageLruPush( app.img_cache, img );
+  }
+
+  if ( app.img_cache != NULL )
+  {
+    ImageCacheEvict( app.img_cache );
+  }
+}
+
+aImage_t* a_ImageAcquire( aImage_t* img )
+{
+  if ( img == NULL ) return NULL;
+
+  aImageCache_t* cache = app.img_cache;
+
+  // Back in use, so off the eviction list
+  if ( img->refcount == 0 && cache != NULL ) ImageLruUnlink( cache, img );
+
+  img->refcount++;
+  IMAGE_TOUCH( img );
+
+  return img;
+}
+
+aRectf_t a_ImageSourceRect( const aImage_t* img, const aRectf_t* src )
+{
+  // src is relative to the image, which may sit anywhere on an atlas page
+  if ( src == NULL )
+  {
+    return (aRectf_t){ img->rect.x, img->rect.y, img->rect.w, img->rect.h };
+  }
+
+  return (aRectf_t){ img->rect.x + src->x, img->rect.y + src->y, src->w, src->h };
+}
+
+void a_ImageRelease( aImage_t* img )
+{
+  if ( img == NULL ) return;
+
+  if ( img->refcount <= 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Released %s more times than it was acquired",
+             log_level_strings[new_error.error_type], img->filename );
+    LOG( new_error.error_msg );
+    return;
+  }
+
+  aImageCache_t* cache = app.img_cache;
+
+  if ( --img->refcount > 0 || cache == NULL ) return;
+
+  // Turned away by a_CacheImage() as a duplicate, so only its holders free it
+  if ( a_GetImageFromCacheByFilename( cache, img->filename ) != img )
+  {
+    ImageFree( img );
+    return;
+  }
+
+  if ( img->atlas_page >= 0 ) return;
+
+  // Its job still points at it; ImageAsyncFinish() lists it once it lands
+  if ( img->state == IMAGE_STATE_PENDING ) return;
+
+  ImageLruPush( cache, img );
+  ImageCacheEvict( cache );
+}
+
+static void ImageLruPush( aImageCache_t* cache, aImage_t* img )
+{
+  img->lru_prev = NULL;
+  img->lru_next = cache->lru_head;
+
+  if ( cache->lru_head != NULL ) cache->lru_head->lru_prev = img;
+  else cache->lru_tail = img;
+
+  cache->lru_head = img;
+}
+
+static void ImageLruUnlink( aImageCache_t* cache, aImage_t* img )
+{
+  if ( img->lru_prev == NULL && cache->lru_head != img ) return;
+
+  if ( img->lru_prev != NULL ) img->lru_prev->lru_next = img->lru_next;
+  else cache->lru_head = img->lru_next;
+
+  if ( img->lru_next != NULL ) img->lru_next->lru_prev = img->lru_prev;
+  else cache->lru_tail = img->lru_prev;
+
+  img->lru_prev = NULL;
+  img->lru_next = NULL;
+}
+
+void a_ImageCacheSetBudget( const size_t bytes )
+{
+  if ( app.img_cache == NULL ) return;
+
+  app.img_cache->budget = bytes;
+  ImageCacheEvict( app.img_cache );
+}
+
+void a_ImageCacheGetStats( aImageCacheStats_t* stats )
+{
+  if ( stats == NULL ) return;
+
+  *stats = (aImageCacheStats_t){ 0 };
+
+  aImageCache_t* cache = app.img_cache;
+  if ( cache == NULL ) return;
+
+  stats->images = cache->count;
+  stats->resident_bytes = cache->resident_bytes;
+  stats->budget = cache->budget;
+  stats->evictions = cache->evictions;
+  stats->hits = cache->hits;
+  stats->misses = cache->misses;
+  stats->loads = cache->loads;
+  stats->decode_ms = (float)cache->decode_ms;
+  stats->upload_ms = (float)cache->upload_ms;
+  stats->frame = cache->frame;
+
+  for ( aImage_t* img = cache->lru_head; img != NULL; img = img->lru_next )
+  {
+    stats->unreferenced++;
+  }
+
+  for ( int i = 0; i < cache->capacity; i++ )
+  {
+    const aImage_t* img = cache->entries[i].image;
+    if ( img == NULL ) continue;
+
+    stats->surface_bytes += ImageSurfaceBytes( img );
+    stats->texture_bytes += ImageTextureBytes( img );
+  }
+
+  aAtlasStats_t atlas;
+  a_AtlasGetStats( &atlas );
+
+  // Pages are always ARGB8888
+  for ( int i = 0; i < atlas.page_count; i++ )
+  {
+    stats->atlas_bytes += (size_t)atlas.page_size[i] * atlas.page_size[i] * 4;
+  }
+}
+
+void a_ImageCacheDump( const int max_rows )
+{
+  aImageCacheStats_t stats;
+  a_ImageCacheGetStats( &stats );
+
+  uint32_t lookups = stats.hits + stats.misses;
+
+  printf( "Image cache: %d image(s), %zu KB resident of %zu KB budget, frame %u\n",
+          stats.images, stats.resident_bytes / 1024, stats.budget / 1024, stats.frame );
+  printf( "  surfaces %zu KB, textures %zu KB, atlas pages %zu KB\n",
+          stats.surface_bytes / 1024, stats.texture_bytes / 1024, stats.atlas_bytes / 1024 );
+  printf( "  %u hit(s), %u miss(es), %.1f%% hit rate, %u eviction(s)\n", stats.hits,
+          stats.misses, lookups ? stats.hits * 100.0f / lookups : 0.0f, stats.evictions );
+  printf( "  %u load(s), %.1f ms decoding, %.1f ms uploading\n",
+          stats.loads, stats.decode_ms, stats.upload_ms );
+
+  aImage_t** sorted = NULL;
+  int count = ImageCacheSorted( app.img_cache, &sorted );
+  int rows = ( max_rows > 0 && max_rows < count ) ? max_rows : count;
+
+  char line[MAX_LINE_LENGTH];
+  printf( "  %8s %8s %9s %4s %8s %7s %7s  %s\n", "surf KB", "tex KB", "size", "refs",
+          "last use", "decode", "upload", "path" );
+
+  for ( int i = 0; i < rows; i++ )
+  {
+    ImageCacheFormatRow( line, sizeof( line ), sorted[i] );
+    printf( "  %s\n", line );
+  }
+
+  free( sorted );
+}
+
+void a_ImageCacheDrawStats( const int x, const int y, const int max_rows )
+{
+  aImageCacheStats_t stats;
+  a_ImageCacheGetStats( &stats );
+
+  aImage_t** sorted = NULL;
+  int count = ImageCacheSorted( app.img_cache, &sorted );
+  int rows = ( max_rows > 0 && max_rows < count ) ? max_rows : count;
+
+  // Three summary lines and the column titles above the rows
+  int line_count = rows + 4;
+  char ( *lines )[MAX_LINE_LENGTH] = malloc( sizeof( *lines ) * line_count );
+  if ( lines == NULL )
+  {
+    free( sorted );
+    return;
+  }
+
+  uint32_t lookups = stats.hits + stats.misses;
+
+  snprintf( lines[0], MAX_LINE_LENGTH, "%d images  %zu/%zu KB  surf %zu  tex %zu  atlas %zu",
+            stats.images, stats.resident_bytes / 1024, stats.budget / 1024,
+            stats.surface_bytes / 1024, stats.texture_bytes / 1024, stats.atlas_bytes / 1024 );
+  snprintf( lines[1], MAX_LINE_LENGTH, "%u hits  %u misses  %.1f%%  %u evicted  frame %u",
+            stats.hits, stats.misses, lookups ? stats.hits * 100.0f / lookups : 0.0f,
+            stats.evictions, stats.frame );
+  snprintf( lines[2], MAX_LINE_LENGTH, "%u loads  %.1f ms decode  %.1f ms upload",
+            stats.loads, stats.decode_ms, stats.upload_ms );
+  snprintf( lines[3], MAX_LINE_LENGTH, "%8s %8s %9s %4s %8s %7s %7s  %s", "surf KB", "tex KB",
+            "size", "refs", "last use", "decode", "upload", "path" );
+
+  for ( int i = 0; i < rows; i++ )
   {
-    aError_t new_error;
-    new_error.error_type = FATAL;
-    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to allocate memory for cache",
-              log_level_strings[new_error.error_type] );
-    LOG( new_error.error_msg );
+    ImageCacheFormatRow( lines[i + 4], MAX_LINE_LENGTH, sorted[i] );
+  }
 
-    return 1;
+  free( sorted );
+
+  // The font is fixed width, so measuring the widest line sizes the panel.
+  // Measured at app.font_scale, which is what a 1.0 style draws at
+  aTextStyle_t style = a_default_text_style;
+  style.scale = 1.0f;
+  float line_w = 0;
+  float line_h = 0;
+  float panel_w = 0;
+
+  for ( int i = 0; i < line_count; i++ )
+  {
+    a_CalcTextDimensions( lines[i], style.type, &line_w, &line_h );
+    if ( line_w > panel_w ) panel_w = line_w;
   }
 
-  app.img_cache->head = NULL;
-  return 0;
+  const int pad = 6;
+  aRectf_t panel = { x, y, panel_w + pad * 2, line_h * line_count + pad * 2 };
+  a_DrawFilledRect( panel, (aColor_t){ 0, 0, 0, 200 } );
+
+  for ( int i = 0; i < line_count; i++ )
+  {
+    a_DrawText( lines[i], x + pad, y + pad + (int)( line_h * i ), style );
+  }
+
+  free( lines );
 }
 
-aImage_t* a_ImageLoad( const char *filename )
+static size_t ImageBytes( const aImage_t* img )
 {
-  aImage_t *img = NULL;
+  return ImageSurfaceBytes( img ) + ImageTextureBytes( img );
+}
 
-  img = a_GetImageFromCacheByFilename( app.img_cache, filename );
-  
-  if ( img == NULL )
+static size_t ImageSurfaceBytes( const aImage_t* img )
+{
+  if ( img->surface == NULL ) return 0;
+
+  return (size_t)img->surface->pitch * img->surface->h;
+}
+
+static size_t ImageTextureBytes( const aImage_t* img )
+{
+  // Page textures are shared, so an atlased image only accounts for its surface
+  if ( img->texture == NULL || img->atlas_page >= 0 ) return 0;
+
+  int bpp = SDL_BYTESPERPIXEL( img->format );
+  return (size_t)img->w * img->h * ( bpp > 0 ? bpp : 4 );
+}
+
+static void ImageCacheCountLoad( const aImage_t* img )
+{
+  if ( app.img_cache == NULL ) return;
+
+  app.img_cache->loads++;
+  app.img_cache->decode_ms += img->decode_ms;
+  app.img_cache->upload_ms += img->upload_ms;
+}
+
+/*
+ * Every cached image, largest first. The caller frees the array; the
+ * images stay owned by the cache.
+ */
+static int ImageCacheSorted( aImageCache_t* cache, aImage_t*** sorted )
+{
+  *sorted = NULL;
+  if ( cache == NULL || cache->count == 0 ) return 0;
+
+  aImage_t** images = malloc( sizeof( aImage_t* ) * cache->count );
+  if ( images == NULL ) return 0;
+
+  int count = 0;
+  for ( int i = 0; i < cache->capacity && count < cache->count; i++ )
   {
-    img = malloc( sizeof( aImage_t ) );
-    if ( img == NULL )
-    {
-      LOG( "Failed to allocate memory for img" );
-    }
+    if ( cache->entries[i].image != NULL ) images[count++] = cache->entries[i].image;
+  }
+
+  qsort( images, count, sizeof( aImage_t* ), ImageBytesCompare );
+
+  *sorted = images;
+  return count;
+}
+
+static int ImageBytesCompare( const void* a, const void* b )
+{
+  const aImage_t* ia = *(const aImage_t* const*)a;
+  const aImage_t* ib = *(const aImage_t* const*)b;
+
+  return ( ia->bytes < ib->bytes ) - ( ia->bytes > ib->bytes );
+}
+
+static void ImageCacheFormatRow( char* line, const size_t size, const aImage_t* img )
+{
+  char dims[16];
+  snprintf( dims, sizeof( dims ), "%dx%d", img->rect.w, img->rect.h );
+
+  // Atlased images show the page they live on instead of texture bytes
+  char texture[16];
+  if ( img->atlas_page >= 0 )
+  {
+    snprintf( texture, sizeof( texture ), "page %d", img->atlas_page );
+  }
+  else
+  {
+    snprintf( texture, sizeof( texture ), "%zu", ImageTextureBytes( img ) / 1024 );
+  }
+
+  snprintf( line, size, "%8zu %8s %9s %4d %8u %7.2f %7.2f  %s%s", ImageSurfaceBytes( img ) / 1024,
+            texture, dims, img->refcount, img->last_use, img->decode_ms, img->upload_ms,
+            img->filename, img->state == IMAGE_STATE_PENDING ? " (loading)"
+                         : img->state == IMAGE_STATE_FAILED  ? " (failed)" : "" );
+}
+
+static void ImageFree( aImage_t* img )
+{
+  if ( img->surface != NULL )
+  {
+    SDL_FreeSurface( img->surface );
     img->surface = NULL;
-    img->texture = NULL;
-    img->filename = NULL;
   }
 
-  if ( img->surface == NULL )
+  // Atlas pages are shared and released by a_AtlasCleanUp()
+  if ( img->texture != NULL && img->atlas_page < 0 )
   {
-    //SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, "Loading %s", filename );
-    img->filename = strndup( filename, MAX_FILENAME_LENGTH );
-    img->surface = IMG_Load( filename );
-    img->texture = SDL_CreateTextureFromSurface( app.renderer, img->surface );
+    a_RenderStateForgetTexture( img->texture );
+    SDL_DestroyTexture( img->texture );
+    img->texture = NULL;
+  }
 
-    if ( img->surface == NULL )
-    {
-      aError_t new_error;
-      new_error.error_type = FATAL;
-      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to load image: %s, %s",
-               log_level_strings[new_error.error_type], filename, SDL_GetError() );
-      LOG( new_error.error_msg );
+  free( img->filename );
+  free( img );
+}
 
-      return NULL;
-    }
+SDL_Surface* a_ImageDecode( const char* filename )
+{
+  if ( filename == NULL ) return NULL;
+
+  // Packed images are already pixels: no PNG parsing, no inflate
+  SDL_Surface* surface = a_PackLoadSurface( filename );
+  if ( surface != NULL ) return surface;
+
+  return IMG_Load( filename );
+}
+
+SDL_Surface* a_ImageGetSurface( aImage_t* img )
+{
+  if ( img == NULL ) return NULL;
 
-    a_CacheImage( app.img_cache, img );
+  if ( img->surface != NULL || img->filename == NULL ) return img->surface;
+
+  img->surface = a_ImageDecode( img->filename );
+  if ( img->surface == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to decode %s again: %s",
+             log_level_strings[new_error.error_type], img->filename, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return NULL;
   }
 
-  return img;
+  // Keep the budget honest; the surface counts again while it's resident
+  size_t bytes = ImageBytes( img );
+  if ( app.img_cache != NULL )
+  {
+    app.img_cache->resident_bytes += bytes - img->bytes;
+  }
+  img->bytes = bytes;
+
+  return img->surface;
 }
 
-static int a_CacheImage( aImageCache_t* head, aImage_t* img )
+SDL_Texture* a_SurfaceToTexture( SDL_Surface* surf, int destroy )
 {
-  aImageCacheNode_t* new_bucket = ( aImageCacheNode_t* )malloc( sizeof( aImageCacheNode_t ) );
-  if ( new_bucket == NULL )
+  if ( surf == NULL ) return NULL;
+
+  SDL_Texture* texture = SDL_CreateTextureFromSurface( app.renderer, surf );
+  if ( texture == NULL )
   {
     aError_t new_error;
     new_error.error_type = FATAL;
-    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to allocate memory for a new bucket",
-             log_level_strings[new_error.error_type] );
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create texture from surface, %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
     LOG( new_error.error_msg );
+  }
 
-    return 1;
+  if ( destroy )
+  {
+    SDL_FreeSurface( surf );
+  }
+
+  return texture;
+}
+
+int a_ImageUploadRect( aImage_t* img, const aRecti_t* rect )
+{
+  if ( img == NULL || img->surface == NULL || img->texture == NULL ) return 1;
+
+  SDL_Surface* surface = img->surface;
+  SDL_Rect bounds = { 0, 0, surface->w, surface->h };
+  SDL_Rect region = bounds;
+
+  if ( rect != NULL )
+  {
+    SDL_Rect wanted = { rect->x, rect->y, rect->w, rect->h };
+    if ( !SDL_IntersectRect( &wanted, &bounds, &region ) ) return 0;
+  }
+
+  // Atlased images live at an offset inside their page
+  SDL_Rect dest = { img->rect.x + region.x, img->rect.y + region.y, region.w, region.h };
+
+  if ( SDL_MUSTLOCK( surface ) && SDL_LockSurface( surface ) != 0 ) return 1;
+
+  const int bpp = surface->format->BytesPerPixel;
+  const uint8_t* pixels = (const uint8_t*)surface->pixels + (size_t)region.y * surface->pitch
+                          + (size_t)region.x * bpp;
+  int status;
+
+  if ( surface->format->format == img->format )
+  {
+    status = SDL_UpdateTexture( img->texture, &dest, pixels, surface->pitch );
+  }
+  else
+  {
+    // Texture picked a different layout at creation; convert just the region
+    int pitch = region.w * SDL_BYTESPERPIXEL( img->format );
+    void* converted = malloc( (size_t)pitch * region.h );
+
+    status = -1;
+    if ( converted != NULL &&
+         SDL_ConvertPixels( region.w, region.h, surface->format->format, pixels, surface->pitch,
+                            img->format, converted, pitch ) == 0 )
+    {
+      status = SDL_UpdateTexture( img->texture, &dest, converted, pitch );
+    }
+
+    free( converted );
+  }
+
+  if ( SDL_MUSTLOCK( surface ) )
+  {
+    SDL_UnlockSurface( surface );
   }
 
-  new_bucket->image = malloc( sizeof( aImage_t ) );
-  if ( new_bucket->image == NULL )
+  if ( status != 0 )
   {
     aError_t new_error;
-    new_error.error_type = FATAL;
-    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to allocate memory for a new bucket",
-             log_level_strings[new_error.error_type] );
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to upload %s to its texture: %s",
+             log_level_strings[new_error.error_type], img->filename, SDL_GetError() );
     LOG( new_error.error_msg );
-    
     return 1;
   }
 
-  new_bucket->image->filename = malloc( MAX_FILENAME_LENGTH );
-  if ( new_bucket->image->filename == NULL )
+  return 0;
+}
+
+/*
+ * The cache is an open-addressing table with linear probing. Each slot
+ * holds the path's FNV-1a hash, an interned copy of the path owned by the
+ * table, and the image itself, so every load of the same file hands back
+ * the same aImage_t. The capacity is a power of two and doubles before
+ * the table passes IMAGE_CACHE_MAX_LOAD percent full.
+ */
+static uint64_t ImageCacheHash( const char* path )
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  for ( const unsigned char* c = (const unsigned char*)path; *c != '\0'; c++ )
+  {
+    hash ^= *c;
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+static aImageCacheEntry_t* ImageCacheFind( aImageCache_t* cache, const char* path,
+                                           const uint64_t hash )
+{
+  const int mask = cache->capacity - 1;
+
+  for ( int i = (int)( hash & mask ); ; i = ( i + 1 ) & mask )
+  {
+    aImageCacheEntry_t* entry = &cache->entries[i];
+
+    // Either the key's slot or the empty slot it would go into
+    if ( entry->path == NULL ) return entry;
+
+    if ( entry->hash == hash && strcmp( entry->path, path ) == 0 ) return entry;
+  }
+}
+
+static int ImageCacheGrow( aImageCache_t* cache )
+{
+  const int new_capacity = cache->capacity ? cache->capacity * 2 : IMAGE_CACHE_INITIAL_SIZE;
+  aImageCacheEntry_t* old_entries = cache->entries;
+  const int old_capacity = cache->capacity;
+
+  aImageCacheEntry_t* new_entries = calloc( new_capacity, sizeof( aImageCacheEntry_t ) );
+  if ( new_entries == NULL )
   {
     aError_t new_error;
     new_error.error_type = FATAL;
-    snprintf( new_error.error_msg, MAX_LINE_LENGTH,
-              "%s: Failed to allocate memory for new bucket's filename",
-              log_level_strings[new_error.error_type] );
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to grow the image cache to %d slots",
+             log_level_strings[new_error.error_type], new_capacity );
     LOG( new_error.error_msg );
-    
+
     return 1;
   }
 
-  new_bucket->image->surface = img->surface;
-  new_bucket->image->texture = img->texture;
-  STRNCPY( new_bucket->image->filename, img->filename, MAX_FILENAME_LENGTH );
-  new_bucket->next = NULL;
+  cache->entries = new_entries;
+  cache->capacity = new_capacity;
 
-  if ( head->head != NULL )
+  // Stored hashes mean rehashing never touches the strings
+  for ( int i = 0; i < old_capacity; i++ )
   {
+    if ( old_entries[i].path == NULL ) continue;
 
-    aImageCacheNode_t *current = head->head;
-    while ( current->next != NULL )
+    const int mask = new_capacity - 1;
+    int j = (int)( old_entries[i].hash & mask );
+    while ( new_entries[j].path != NULL )
     {
-      current = current->next;
+      j = ( j + 1 ) & mask;
     }
 
-    current = new_bucket;
+    new_entries[j] = old_entries[i];
   }
 
-  else
-  {
-    head->head = new_bucket;
-  }
+  free( old_entries );
 
   return 0;
 }
 
-static aImage_t* a_GetImageFromCacheByFilename( aImageCache_t* head, const char* filename )
+static int a_CacheImage( aImageCache_t* cache, aImage_t* img )
 {
-  aImageCacheNode_t* current;
+  if ( cache == NULL || img == NULL || img->filename == NULL ) return 1;
+
+  if ( ( cache->count + 1 ) * 100 > cache->capacity * IMAGE_CACHE_MAX_LOAD &&
+       ImageCacheGrow( cache ) != 0 )
+  {
+    return 1;
+  }
+
+  const uint64_t hash = ImageCacheHash( img->filename );
+  aImageCacheEntry_t* entry = ImageCacheFind( cache, img->filename, hash );
 
-  for ( current = head->head; current != NULL; current = current->next )
+  IMAGE_TOUCH( img );
+
+  if ( entry->path != NULL )
   {
-    if ( strcmp( current->image->filename, filename ) == 0 )
+    aImage_t* old = entry->image;
+
+    // Same path created again (e.g. by a_ImageCreate) while the first is in use
+    if ( old->refcount > 0 || old->state == IMAGE_STATE_PENDING )
     {
-      return current->image;
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: %s is already cached and in use, not caching the new image",
+               log_level_strings[new_error.error_type], img->filename );
+      LOG( new_error.error_msg );
+      return 1;
     }
+
+    // Nobody holds the old one, so the fresh image takes the slot
+    ImageLruUnlink( cache, old );
+    cache->resident_bytes -= old->bytes < cache->resident_bytes ? old->bytes : cache->resident_bytes;
+    ImageFree( old );
+
+    entry->image = img;
+    return 0;
+  }
+
+  entry->path = strndup( img->filename, MAX_FILENAME_LENGTH );
+  if ( entry->path == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = FATAL;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to intern image path %s",
+             log_level_strings[new_error.error_type], img->filename );
+    LOG( new_error.error_msg );
+
+    return 1;
+  }
+
+  entry->hash = hash;
+  entry->image = img;
+  cache->count++;
+
+  // Edits to the file land in this image once hot reload is running
+  a_HotReloadWatch( img->filename, NULL, NULL );
+
+  return 0;
+}
+
+static aImage_t* a_GetImageFromCacheByFilename( aImageCache_t* cache, const char* filename )
+{
+  if ( cache == NULL || filename == NULL || cache->count == 0 ) return NULL;
+
+  aImageCacheEntry_t* entry = ImageCacheFind( cache, filename, ImageCacheHash( filename ) );
+
+  return entry->image;
+}
+
+/*
+ * Backward-shift deletion: pull later members of the probe run into the
+ * hole so lookups never need tombstones.
+ */
+static void ImageCacheRemove( aImageCache_t* cache, const aImage_t* img )
+{
+  aImageCacheEntry_t* entry = ImageCacheFind( cache, img->filename, ImageCacheHash( img->filename ) );
+
+  // A reload may already have taken the slot over
+  if ( entry->path == NULL || entry->image != img ) return;
+
+  const int mask = cache->capacity - 1;
+  int hole = (int)( entry - cache->entries );
+
+  free( entry->path );
+  cache->entries[hole] = (aImageCacheEntry_t){ 0 };
+  cache->count--;
+
+  for ( int i = ( hole + 1 ) & mask; cache->entries[i].path != NULL; i = ( i + 1 ) & mask )
+  {
+    int home = (int)( cache->entries[i].hash & mask );
+
+    // Leave it if its home lies cyclically within ( hole, i ]
+    if ( ( ( i - home ) & mask ) < ( ( i - hole ) & mask ) ) continue;
+
+    cache->entries[hole] = cache->entries[i];
+    cache->entries[i] = (aImageCacheEntry_t){ 0 };
+    hole = i;
   }
+}
+
+static void ImageCacheEvict( aImageCache_t* cache )
+{
+  if ( cache->budget == 0 ) return;
+
+  while ( cache->resident_bytes > cache->budget && cache->lru_tail != NULL )
+  {
+    aImage_t* img = cache->lru_tail;
+
+    cache->lru_tail = img->lru_prev;
+    if ( cache->lru_tail != NULL ) cache->lru_tail->lru_next = NULL;
+    else cache->lru_head = NULL;
 
-  return NULL;
+    ImageCacheRemove( cache, img );
+
+    cache->resident_bytes -= img->bytes < cache->resident_bytes ? img->bytes : cache->resident_bytes;
+    cache->evictions++;
+
+    ImageFree( img );
+  }
 }
 
 int a_ImageCacheCleanUp( void )
@@ -172,53 +1547,29 @@ int a_ImageCacheCleanUp( void )
     return 1;
   }
 
-  if ( app.img_cache->head == NULL )
-  {
-      // FAIL: img_cache->head is NULL
-    aError_t new_error;
-    new_error.error_type = WARNING;
-    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: img_cache->head is NULL",
-             log_level_strings[new_error.error_type] );
-    LOG( new_error.error_msg );
-    return 0;
-  }
+  aImageCache_t* cache = app.img_cache;
 
-  else
+  for ( int i = 0; i < cache->capacity; i++ )
   {
-    aImageCacheNode_t* current = app.img_cache->head;
-    aImageCacheNode_t* next = NULL;
+    aImageCacheEntry_t* entry = &cache->entries[i];
+    if ( entry->path == NULL ) continue;
 
-    while ( current != NULL )
+    if ( entry->image != NULL )
     {
-      next = current->next;
-      if ( current->image->surface != NULL )
-      {
-        SDL_FreeSurface( current->image->surface );
-        current->image->surface = NULL;
-
-      }
-     
-      if ( current->image->filename != NULL )
-      {
-        free( current->image->filename );
-        current->image->filename = NULL;
-
-      }
-      
-      if ( current->image->texture != NULL )
-      {
-        SDL_DestroyTexture( current->image->texture );
-        current->image->texture = NULL;
-
-      }
-
-      free( current );
-      current = next;
+      ImageFree( entry->image );
     }
 
-    app.img_cache->head = NULL;
+    free( entry->path );
   }
 
+  free( cache->entries );
+  cache->entries = NULL;
+  cache->capacity = 0;
+  cache->count = 0;
+  cache->lru_head = NULL;
+  cache->lru_tail = NULL;
+  cache->resident_bytes = 0;
+
   return 0;
 }
 
@@ -227,6 +1578,9 @@ int a_ScreenshotSave( SDL_Renderer *renderer, const char *filename )
   SDL_Rect aViewport;
   SDL_Surface *aSurface = NULL;
 
+  // Queued primitives must be on the target before we read it back
+  a_DrawFlush();
+
   SDL_RenderGetViewport( renderer, &aViewport );
 
   aSurface = SDL_CreateRGBSurface( 0, aViewport.w, aViewport.h, 32, 0, 0, 0, 0 );
@@ -270,3 +1624,47 @@ int a_ScreenshotSave( SDL_Renderer *renderer, const char *filename )
   return 1;
 }
 
+SDL_Surface* a_FramebufferCapture( void )
+{
+  int w, h;
+
+  // Queued primitives must be on the target before we read it back
+  a_DrawFlush();
+
+  if ( SDL_GetRendererOutputSize( app.renderer, &w, &h ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to query renderer output size: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return NULL;
+  }
+
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat( 0, w, h, 32, SDL_PIXELFORMAT_ARGB8888 );
+  if ( surface == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create surface %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return NULL;
+  }
+
+  if ( SDL_RenderReadPixels( app.renderer, NULL, surface->format->format,
+                             surface->pixels, surface->pitch ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to read pixels from renderer: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+
+    SDL_FreeSurface( surface );
+    return NULL;
+  }
+
+  return surface;
+}
+
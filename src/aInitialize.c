@@ -21,6 +21,9 @@
 
 aApp_t app;
 
+// Extra settings from a_InitEx(); plain a_Init() sees all zeroes
+static aInitOptions_t init_options = { 0 };
+
 typedef enum {
     INIT_SUCCESS = 0,
     INIT_ERROR_SDL = -1,
@@ -71,14 +74,31 @@ int a_Init( const int width, const int height, const char *title )
     return status;
   }
 
-  // Create window and renderer
-  if (SDL_CreateWindowAndRenderer( width, height, 0, &app.window, &app.renderer ) < 0) {
+  // Create window and renderer; headless renders into a plain surface
+  app.options.headless = init_options.headless;
+  if ( init_options.headless ) {
+    app.window = NULL;
+    app.framebuffer = SDL_CreateRGBSurfaceWithFormat( 0, width, height, 32, SDL_PIXELFORMAT_ARGB8888 );
+    app.renderer = app.framebuffer ? SDL_CreateSoftwareRenderer( app.framebuffer ) : NULL;
+    if ( app.renderer == NULL ) {
+      SDL_FreeSurface( app.framebuffer );
+      app.framebuffer = NULL;
+      a_CleanupSubsystems();
+      return INIT_ERROR_WINDOW;
+    }
+  }
+  else if (SDL_CreateWindowAndRenderer( width, height, init_options.window_flags, &app.window, &app.renderer ) < 0) {
     a_CleanupSubsystems();
     return INIT_ERROR_WINDOW;
   }
 
+  // Fresh renderer: nothing in the shadow state is known yet
+  a_RenderStateInvalidate();
+
   // Set window title after window creation
-  SDL_SetWindowTitle( app.window, title );
+  if ( app.window ) {
+    SDL_SetWindowTitle( app.window, title );
+  }
 
   // Initialize mouse state
   app.mouse = (aMouse_t){
@@ -99,7 +119,8 @@ int a_Init( const int width, const int height, const char *title )
 
   // Initialize image cache
   app.img_cache = NULL;
-  app.options.frame_cap = 1;
+  app.options.frame_cap = FRAME_PACE_UNCAPPED;
+  app.options.target_fps = FPS_CAP;
   app.options.scale_factor = 2;
 
   // Set app to running state
@@ -113,6 +134,25 @@ int a_Init( const int width, const int height, const char *title )
   return 0;
 }
 
+int a_InitEx( const aInitOptions_t* options )
+{
+  if ( options == NULL ) {
+    return INIT_ERROR_WINDOW;
+  }
+
+  if ( options->headless ) {
+    // Only fill in drivers the caller has not chosen already
+    SDL_setenv( "SDL_VIDEODRIVER", "dummy", 0 );
+    SDL_setenv( "SDL_AUDIODRIVER", "dummy", 0 );
+  }
+
+  init_options = *options;
+  int status = a_Init( options->width, options->height, options->title );
+  init_options = (aInitOptions_t){ 0 };
+
+  return status;
+}
+
 void a_Quit( void )
 {
   // Call optional exit delegate first
@@ -130,12 +170,27 @@ void a_Quit( void )
     app.time.FPS_cap_timer = NULL;
   }
 
+  a_HotReloadCleanUp();
+
+  // Workers may still hold jobs that point into the cache
+  a_ImageAsyncCleanUp();
+
   if ( app.img_cache ) {
     a_ImageCacheCleanUp();
     free( app.img_cache );
     app.img_cache = NULL;
   }
 
+  a_AtlasCleanUp();
+  a_PackCleanUp();
+  a_LayerCleanUp();
+
+  a_DrawCleanUp();
+  a_SpriteBatchCleanUp();
+  a_DrawListCleanUp();
+  a_ParticlesCleanUp();
+  a_CaptureCleanUp();
+
   // Clean up audio system (before SDL shutdown)
   a_AudioQuit();
 
@@ -150,6 +205,11 @@ void a_Quit( void )
     app.window = NULL;
   }
 
+  if ( app.framebuffer ) {
+    SDL_FreeSurface( app.framebuffer );
+    app.framebuffer = NULL;
+  }
+
   // Shutdown SDL subsystems last (reverse order of init)
   a_CleanupSubsystems();
 
@@ -70,6 +70,15 @@ void a_DoInput( void )
         a_DoMouseMotion( &event.motion );
         break;
 
+      case SDL_RENDER_TARGETS_RESET:
+        // Target textures lost their contents, redraw them on next use
+        a_LayerInvalidateAll();
+        break;
+
+      case SDL_RENDER_DEVICE_RESET:
+        a_LayerRecreateAll();
+        break;
+
       default:
         // Silently ignore unknown events (normal behavior for unhandled types)
         break;
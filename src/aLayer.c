@@ -0,0 +1,221 @@
+/*
+ * aLayer.c:
+ *
+ * Render-target layers for content that rarely changes. A layer owns an
+ * SDL_TEXTUREACCESS_TARGET texture; it is only redrawn after it has been
+ * invalidated and otherwise costs a single copy per frame. Layers hold
+ * premultiplied color (what blending into a cleared target produces), so
+ * they are composited with a premultiplied blend mode where available.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Archimedes.h"
+
+static aLayer_t* layer_head = NULL;
+static aLayer_t* layer_active = NULL;
+
+static int LayerCreateTexture( aLayer_t* layer );
+
+aLayer_t* a_LayerCreate( const int w, const int h )
+{
+  if ( w <= 0 || h <= 0 ) return NULL;
+
+  if ( !SDL_RenderTargetSupported( app.renderer ) )
+  {
+    LOG( "Renderer does not support render targets, layers are unavailable" );
+    return NULL;
+  }
+
+  aLayer_t* layer = malloc( sizeof( aLayer_t ) );
+  if ( layer == NULL )
+  {
+    LOG( "Failed to allocate memory for layer" );
+    return NULL;
+  }
+
+  *layer = (aLayer_t){ 0 };
+  layer->w = w;
+  layer->h = h;
+
+  if ( LayerCreateTexture( layer ) != 0 )
+  {
+    free( layer );
+    return NULL;
+  }
+
+  layer->next = layer_head;
+  layer_head = layer;
+
+  return layer;
+}
+
+void a_LayerDestroy( aLayer_t* layer )
+{
+  if ( layer == NULL ) return;
+
+  for ( aLayer_t** link = &layer_head; *link != NULL; link = &( *link )->next )
+  {
+    if ( *link == layer )
+    {
+      *link = layer->next;
+      break;
+    }
+  }
+
+  if ( layer_active == layer )
+  {
+    a_LayerEnd( layer );
+  }
+
+  if ( layer->texture != NULL )
+  {
+    a_RenderStateForgetTexture( layer->texture );
+    SDL_DestroyTexture( layer->texture );
+  }
+
+  free( layer );
+}
+
+void a_LayerInvalidate( aLayer_t* layer )
+{
+  if ( layer != NULL )
+  {
+    layer->dirty = 1;
+  }
+}
+
+void a_LayerInvalidateAll( void )
+{
+  for ( aLayer_t* layer = layer_head; layer != NULL; layer = layer->next )
+  {
+    layer->dirty = 1;
+  }
+}
+
+void a_LayerRecreateAll( void )
+{
+  for ( aLayer_t* layer = layer_head; layer != NULL; layer = layer->next )
+  {
+    if ( layer->texture != NULL )
+    {
+      a_RenderStateForgetTexture( layer->texture );
+      SDL_DestroyTexture( layer->texture );
+      layer->texture = NULL;
+    }
+
+    LayerCreateTexture( layer );
+  }
+}
+
+int a_LayerBegin( aLayer_t* layer )
+{
+  if ( layer == NULL || layer->texture == NULL || !layer->dirty ) return 0;
+
+  if ( layer_active != NULL )
+  {
+    LOG( "a_LayerBegin called while another layer is being drawn" );
+    return 0;
+  }
+
+  // Anything queued so far belongs to the previous target
+  a_DrawFlush();
+
+  layer->previous_target = SDL_GetRenderTarget( app.renderer );
+  RENDER_STATS_ADD( target_changes, 1 );
+  if ( SDL_SetRenderTarget( app.renderer, layer->texture ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to bind layer as render target: %s",
+             log_level_strings[new_error.error_type], SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 0;
+  }
+
+  // SDL swaps viewport and clip rect with the target
+  a_RenderStateInvalidate();
+  layer_active = layer;
+
+  a_RenderStateSetDrawColor( (aColor_t){ 0, 0, 0, 0 } );
+  SDL_RenderClear( app.renderer );
+  RENDER_STATS_DRAW( NULL, 0 );
+
+  return 1;
+}
+
+void a_LayerEnd( aLayer_t* layer )
+{
+  if ( layer == NULL || layer_active != layer ) return;
+
+  a_DrawFlush();
+
+  SDL_SetRenderTarget( app.renderer, layer->previous_target );
+  RENDER_STATS_ADD( target_changes, 1 );
+  a_RenderStateInvalidate();
+
+  layer->previous_target = NULL;
+  layer->dirty = 0;
+  layer_active = NULL;
+}
+
+void a_BlitLayer( aLayer_t* layer, const int x, const int y )
+{
+  if ( layer == NULL || layer->texture == NULL ) return;
+
+  if ( layer_active == layer )
+  {
+    LOG( "a_BlitLayer called on a layer that is still being drawn" );
+    return;
+  }
+
+  a_DrawFlush();
+
+  SDL_Rect dest = { x, y, layer->w, layer->h };
+  SDL_RenderCopy( app.renderer, layer->texture, NULL, &dest );
+  RENDER_STATS_DRAW( layer->texture, 4 );
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)dest.w * dest.h );
+}
+
+void a_LayerCleanUp( void )
+{
+  while ( layer_head != NULL )
+  {
+    a_LayerDestroy( layer_head );
+  }
+}
+
+static int LayerCreateTexture( aLayer_t* layer )
+{
+  layer->texture = SDL_CreateTexture( app.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                      SDL_TEXTUREACCESS_TARGET, layer->w, layer->h );
+  if ( layer->texture == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create %dx%d layer: %s",
+             log_level_strings[new_error.error_type], layer->w, layer->h, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  // Premultiplied over; renderers without custom blend modes fall back to
+  // plain blending, which slightly darkens translucent edges
+  SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode( SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                                            SDL_BLENDOPERATION_ADD,
+                                                            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                                            SDL_BLENDOPERATION_ADD );
+  if ( SDL_SetTextureBlendMode( layer->texture, premultiplied ) != 0 )
+  {
+    SDL_SetTextureBlendMode( layer->texture, SDL_BLENDMODE_BLEND );
+  }
+
+  layer->dirty = 1;
+
+  return 0;
+}
+
@@ -0,0 +1,695 @@
+/*
+ * aPack.c:
+ *
+ * Asset packs: images baked ahead of time into pixel blocks in the
+ * renderer's preferred format, found through a hashed path table. A
+ * mounted pack is mapped into memory, so loading a packed image is a
+ * table probe plus (for compressed blocks) a fast LZ pass, with no PNG
+ * parsing or inflate. a_PackWrite() builds packs; see tools/apack.c.
+ *
+ * Layout, little-endian, every section 16-byte aligned:
+ *
+ *   aPackHeader_t
+ *   aPackSlot_t  [slots]   open-addressing table on the path's FNV-1a hash
+ *   aPackEntry_t [count]
+ *   path strings           not NUL terminated
+ *   pixel blocks
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL_image.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PACK_HAVE_MMAP
+#endif
+
+#include "Archimedes.h"
+
+#define PACK_MAGIC        "APAK"
+#define PACK_VERSION      1
+#define PACK_ALIGN        16
+#define PACK_PIXEL_FORMAT SDL_PIXELFORMAT_ARGB8888  // What SDL's renderers create by default
+
+#define PACK_CODEC_RAW 0
+#define PACK_CODEC_LZ  1
+
+// LZ sequences: token (literal run << 4 | match length - 4), literals, u16 offset
+#define PACK_LZ_MIN_MATCH   4
+#define PACK_LZ_HASH_BITS   14
+#define PACK_LZ_MAX_OFFSET  65535
+
+typedef struct
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t count;
+  uint32_t slots;           // Power of two, at most half full
+} aPackHeader_t;
+
+typedef struct
+{
+  uint64_t hash;
+  uint32_t entry;           // Index + 1, 0 for an empty slot
+  uint32_t reserved;
+} aPackSlot_t;
+
+typedef struct
+{
+  uint64_t data_offset;
+  uint64_t stored_size;     // Bytes in the pack; w * 4 * h when raw
+  uint32_t path_offset;     // From the start of the file
+  uint32_t path_length;
+  uint32_t w;
+  uint32_t h;
+  uint32_t format;          // SDL_PixelFormatEnum of the pixels
+  uint32_t codec;
+  uint32_t reserved[2];
+} aPackEntry_t;
+
+typedef struct
+{
+  uint8_t* base;
+  size_t size;
+  int mapped;               // 0 when the pack was read into a malloc'd buffer
+  const aPackHeader_t* header;
+  const aPackSlot_t* slots;
+  const aPackEntry_t* entries;
+} aPackMount_t;
+
+static aPackMount_t mounts[PACK_MAX_MOUNTS];
+static int mount_count = 0;
+
+static uint64_t PackHash( const char* path, const size_t length );
+static const aPackEntry_t* PackFind( const aPackMount_t* mount, const char* path );
+static int PackValidate( aPackMount_t* mount );
+static void PackUnmap( aPackMount_t* mount );
+static size_t PackCompress( const uint8_t* src, const size_t size, uint8_t* dst, const size_t capacity );
+static int PackDecompress( const uint8_t* src, const size_t size, uint8_t* dst, const size_t dst_size );
+
+int a_PackMount( const char* filename )
+{
+  if ( filename == NULL ) return 1;
+
+  if ( mount_count == PACK_MAX_MOUNTS )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Can't mount %s, %d packs already mounted",
+             log_level_strings[new_error.error_type], filename, PACK_MAX_MOUNTS );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  aPackMount_t mount = { 0 };
+
+#if defined(PACK_HAVE_MMAP)
+  int fd = open( filename, O_RDONLY );
+  struct stat st;
+
+  if ( fd >= 0 && fstat( fd, &st ) == 0 && st.st_size > 0 )
+  {
+    // Private and writable: a surface made from a block can be drawn on
+    // without touching the file, pages are only copied when written
+    void* base = mmap( NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    if ( base != MAP_FAILED )
+    {
+      mount.base = base;
+      mount.size = (size_t)st.st_size;
+      mount.mapped = 1;
+    }
+  }
+
+  if ( fd >= 0 ) close( fd );
+#endif
+
+  // No mmap (or it failed): read the whole pack in instead
+  if ( mount.base == NULL )
+  {
+    FILE* file = fopen( filename, "rb" );
+    long size = -1;
+
+    if ( file != NULL && fseek( file, 0, SEEK_END ) == 0 )
+    {
+      size = ftell( file );
+      rewind( file );
+    }
+
+    if ( size > 0 )
+    {
+      mount.base = malloc( (size_t)size );
+      if ( mount.base != NULL && fread( mount.base, 1, (size_t)size, file ) == (size_t)size )
+      {
+        mount.size = (size_t)size;
+      }
+      else
+      {
+        free( mount.base );
+        mount.base = NULL;
+      }
+    }
+
+    if ( file != NULL ) fclose( file );
+  }
+
+  if ( mount.base == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to open asset pack %s",
+             log_level_strings[new_error.error_type], filename );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  // Every offset is checked once here so lookups can trust the tables
+  if ( PackValidate( &mount ) != 0 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: %s is not a valid asset pack",
+             log_level_strings[new_error.error_type], filename );
+    LOG( new_error.error_msg );
+
+    PackUnmap( &mount );
+    return 1;
+  }
+
+  mounts[mount_count++] = mount;
+
+  return 0;
+}
+
+int a_PackContains( const char* path )
+{
+  if ( path == NULL ) return 0;
+
+  for ( int i = mount_count - 1; i >= 0; i-- )
+  {
+    if ( PackFind( &mounts[i], path ) != NULL ) return 1;
+  }
+
+  return 0;
+}
+
+SDL_Surface* a_PackLoadSurface( const char* path )
+{
+  if ( path == NULL ) return NULL;
+
+  // Newest mount first, so a patch pack can override a base pack
+  for ( int i = mount_count - 1; i >= 0; i-- )
+  {
+    const aPackMount_t* mount = &mounts[i];
+    const aPackEntry_t* entry = PackFind( mount, path );
+    if ( entry == NULL ) continue;
+
+    uint8_t* data = mount->base + entry->data_offset;
+    const int pitch = (int)entry->w * 4;
+
+    // Raw blocks are used in place; the surface doesn't own its pixels
+    if ( entry->codec == PACK_CODEC_RAW )
+    {
+      return SDL_CreateRGBSurfaceWithFormatFrom( data, (int)entry->w, (int)entry->h, 32,
+                                                 pitch, entry->format );
+    }
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat( 0, (int)entry->w, (int)entry->h,
+                                                           32, entry->format );
+    if ( surface == NULL ) return NULL;
+
+    if ( surface->pitch != pitch ||
+         PackDecompress( data, entry->stored_size, surface->pixels,
+                         (size_t)pitch * entry->h ) != 0 )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Corrupt pixel block for %s",
+               log_level_strings[new_error.error_type], path );
+      LOG( new_error.error_msg );
+
+      SDL_FreeSurface( surface );
+      return NULL;
+    }
+
+    return surface;
+  }
+
+  return NULL;
+}
+
+int a_PackWrite( const char* filename, const char** paths, const int count, const int flags )
+{
+  if ( filename == NULL || paths == NULL || count <= 0 ) return 1;
+
+  aPackEntry_t* entries = calloc( count, sizeof( aPackEntry_t ) );
+  uint8_t** blocks = calloc( count, sizeof( uint8_t* ) );
+  const char** names = calloc( count, sizeof( char* ) );
+  int packed = 0;
+  int failed = 0;
+  uint64_t raw_total = 0;
+
+  if ( entries == NULL || blocks == NULL || names == NULL )
+  {
+    LOG( "Failed to allocate memory for the asset pack" );
+    free( entries );
+    free( blocks );
+    free( names );
+    return 1;
+  }
+
+  for ( int i = 0; i < count; i++ )
+  {
+    int duplicate = 0;
+    for ( int j = 0; j < packed; j++ )
+    {
+      if ( strcmp( names[j], paths[i] ) == 0 ) duplicate = 1;
+    }
+    if ( duplicate ) continue;
+
+    SDL_Surface* decoded = IMG_Load( paths[i] );
+    SDL_Surface* surface = decoded ? SDL_ConvertSurfaceFormat( decoded, PACK_PIXEL_FORMAT, 0 ) : NULL;
+    SDL_FreeSurface( decoded );
+
+    if ( surface == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to load image: %s, %s",
+               log_level_strings[new_error.error_type], paths[i], SDL_GetError() );
+      LOG( new_error.error_msg );
+      failed = 1;
+      continue;
+    }
+
+    // Rows are stored tightly, whatever pitch the surface had
+    const size_t row = (size_t)surface->w * 4;
+    const size_t raw_size = row * surface->h;
+    uint8_t* raw = malloc( raw_size );
+    if ( raw == NULL )
+    {
+      SDL_FreeSurface( surface );
+      failed = 1;
+      continue;
+    }
+
+    for ( int y = 0; y < surface->h; y++ )
+    {
+      memcpy( raw + row * y, (uint8_t*)surface->pixels + (size_t)surface->pitch * y, row );
+    }
+
+    aPackEntry_t* entry = &entries[packed];
+    entry->w = surface->w;
+    entry->h = surface->h;
+    entry->format = PACK_PIXEL_FORMAT;
+    entry->codec = PACK_CODEC_RAW;
+    entry->stored_size = raw_size;
+    entry->path_length = (uint32_t)strlen( paths[i] );
+    blocks[packed] = raw;
+
+    SDL_FreeSurface( surface );
+
+    // Only keep the compressed block when it actually saves space
+    if ( flags & PACK_WRITE_COMPRESS )
+    {
+      uint8_t* lz = malloc( raw_size );
+      size_t lz_size = lz ? PackCompress( raw, raw_size, lz, raw_size ) : 0;
+
+      if ( lz_size > 0 && lz_size < raw_size )
+      {
+        free( raw );
+        blocks[packed] = lz;
+        entry->codec = PACK_CODEC_LZ;
+        entry->stored_size = lz_size;
+      }
+      else
+      {
+        free( lz );
+      }
+    }
+
+    raw_total += raw_size;
+    names[packed++] = paths[i];
+  }
+
+  // Half-full table keeps probes short
+  uint32_t slots = 8;
+  while ( slots < (uint32_t)packed * 2 ) slots *= 2;
+
+  aPackSlot_t* table = calloc( slots, sizeof( aPackSlot_t ) );
+  FILE* file = ( table != NULL ) ? fopen( filename, "wb" ) : NULL;
+
+  if ( file == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create asset pack %s",
+             log_level_strings[new_error.error_type], filename );
+    LOG( new_error.error_msg );
+    failed = 1;
+  }
+  else
+  {
+    uint64_t offset = sizeof( aPackHeader_t ) + sizeof( aPackSlot_t ) * slots
+                    + sizeof( aPackEntry_t ) * packed;
+
+    for ( int i = 0; i < packed; i++ )
+    {
+      entries[i].path_offset = (uint32_t)offset;
+      offset += entries[i].path_length;
+
+      uint64_t hash = PackHash( names[i], entries[i].path_length );
+      uint32_t s = (uint32_t)hash & ( slots - 1 );
+      while ( table[s].entry != 0 ) s = ( s + 1 ) & ( slots - 1 );
+
+      table[s].hash = hash;
+      table[s].entry = i + 1;
+    }
+
+    for ( int i = 0; i < packed; i++ )
+    {
+      offset = ( offset + PACK_ALIGN - 1 ) & ~(uint64_t)( PACK_ALIGN - 1 );
+      entries[i].data_offset = offset;
+      offset += entries[i].stored_size;
+    }
+
+    aPackHeader_t header = { .version = PACK_VERSION, .count = (uint32_t)packed, .slots = slots };
+    memcpy( header.magic, PACK_MAGIC, 4 );
+
+    static const uint8_t zeros[PACK_ALIGN] = { 0 };
+    int ok = fwrite( &header, sizeof( header ), 1, file ) == 1
+          && fwrite( table, sizeof( aPackSlot_t ), slots, file ) == slots
+          && fwrite( entries, sizeof( aPackEntry_t ), packed, file ) == (size_t)packed;
+
+    for ( int i = 0; ok && i < packed; i++ )
+    {
+      ok = fwrite( names[i], 1, entries[i].path_length, file ) == entries[i].path_length;
+    }
+
+    for ( int i = 0; ok && i < packed; i++ )
+    {
+      long pad = (long)entries[i].data_offset - ftell( file );
+      ok = pad >= 0 && fwrite( zeros, 1, (size_t)pad, file ) == (size_t)pad
+        && fwrite( blocks[i], 1, entries[i].stored_size, file ) == entries[i].stored_size;
+    }
+
+    if ( fclose( file ) != 0 ) ok = 0;
+
+    if ( !ok )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to write asset pack %s",
+               log_level_strings[new_error.error_type], filename );
+      LOG( new_error.error_msg );
+      failed = 1;
+    }
+    else
+    {
+      printf( "Packed %d images into %s: %llu KiB of pixels, %llu KiB on disk\n", packed, filename,
+              (unsigned long long)( raw_total / 1024 ), (unsigned long long)( offset / 1024 ) );
+    }
+  }
+
+  for ( int i = 0; i < packed; i++ )
+  {
+    free( blocks[i] );
+  }
+
+  free( table );
+  free( entries );
+  free( blocks );
+  free( names );
+
+  return failed;
+}
+
+void a_PackCleanUp( void )
+{
+  for ( int i = 0; i < mount_count; i++ )
+  {
+    PackUnmap( &mounts[i] );
+  }
+
+  mount_count = 0;
+}
+
+static uint64_t PackHash( const char* path, const size_t length )
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  for ( size_t i = 0; i < length; i++ )
+  {
+    hash ^= (unsigned char)path[i];
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+static const aPackEntry_t* PackFind( const aPackMount_t* mount, const char* path )
+{
+  const size_t length = strlen( path );
+  const uint64_t hash = PackHash( path, length );
+  const uint32_t mask = mount->header->slots - 1;
+
+  for ( uint32_t s = (uint32_t)hash & mask; ; s = ( s + 1 ) & mask )
+  {
+    const aPackSlot_t* slot = &mount->slots[s];
+    if ( slot->entry == 0 ) return NULL;
+
+    const aPackEntry_t* entry = &mount->entries[slot->entry - 1];
+    if ( slot->hash == hash && entry->path_length == length &&
+         memcmp( mount->base + entry->path_offset, path, length ) == 0 )
+    {
+      return entry;
+    }
+  }
+}
+
+static int PackValidate( aPackMount_t* mount )
+{
+  const uint64_t size = mount->size;
+
+  if ( size < sizeof( aPackHeader_t ) ) return 1;
+
+  mount->header = (const aPackHeader_t*)mount->base;
+
+  const aPackHeader_t* header = mount->header;
+  if ( memcmp( header->magic, PACK_MAGIC, 4 ) != 0 || header->version != PACK_VERSION ) return 1;
+
+  // Slots must be a power of two with at least one empty, or probes never end
+  if ( header->slots == 0 || ( header->slots & ( header->slots - 1 ) ) != 0 ||
+       header->count >= header->slots )
+  {
+    return 1;
+  }
+
+  const uint64_t tables = sizeof( aPackHeader_t ) + (uint64_t)sizeof( aPackSlot_t ) * header->slots
+                        + (uint64_t)sizeof( aPackEntry_t ) * header->count;
+  if ( tables > size ) return 1;
+
+  mount->slots = (const aPackSlot_t*)( mount->base + sizeof( aPackHeader_t ) );
+  mount->entries = (const aPackEntry_t*)( mount->slots + header->slots );
+
+  for ( uint32_t i = 0; i < header->slots; i++ )
+  {
+    if ( mount->slots[i].entry > header->count ) return 1;
+  }
+
+  for ( uint32_t i = 0; i < header->count; i++ )
+  {
+    const aPackEntry_t* e = &mount->entries[i];
+    const uint64_t raw_size = (uint64_t)e->w * 4 * e->h;
+
+    if ( e->w == 0 || e->h == 0 || e->w > 16384 || e->h > 16384 ) return 1;
+    if ( (uint64_t)e->path_offset + e->path_length > size ) return 1;
+    if ( e->data_offset > size || e->stored_size > size - e->data_offset ) return 1;
+    if ( e->data_offset % PACK_ALIGN != 0 ) return 1;
+    if ( SDL_BITSPERPIXEL( e->format ) != 32 ) return 1;
+    if ( e->codec == PACK_CODEC_RAW && e->stored_size != raw_size ) return 1;
+    if ( e->codec != PACK_CODEC_RAW && e->codec != PACK_CODEC_LZ ) return 1;
+  }
+
+  return 0;
+}
+
+static void PackUnmap( aPackMount_t* mount )
+{
+#if defined(PACK_HAVE_MMAP)
+  if ( mount->mapped )
+  {
+    munmap( mount->base, mount->size );
+  }
+  else
+#endif
+  {
+    free( mount->base );
+  }
+
+  *mount = (aPackMount_t){ 0 };
+}
+
+static inline uint32_t PackRead32( const uint8_t* p )
+{
+  uint32_t v;
+  memcpy( &v, p, sizeof( v ) );
+  return v;
+}
+
+static uint8_t* PackWriteLength( uint8_t* op, const uint8_t* end, size_t length )
+{
+  while ( length >= 255 )
+  {
+    if ( op >= end ) return NULL;
+    *op++ = 255;
+    length -= 255;
+  }
+
+  if ( op >= end ) return NULL;
+  *op++ = (uint8_t)length;
+
+  return op;
+}
+
+/*
+ * Greedy single-probe matcher in the spirit of LZ4: fast enough to run
+ * over a whole asset directory at build time, and the format decodes with
+ * nothing but copies. Returns 0 if the output doesn't fit in capacity.
+ */
+static size_t PackCompress( const uint8_t* src, const size_t size, uint8_t* dst, const size_t capacity )
+{
+  uint32_t* table = calloc( (size_t)1 << PACK_LZ_HASH_BITS, sizeof( uint32_t ) );
+  if ( table == NULL ) return 0;
+
+  const uint8_t* ip = src;
+  const uint8_t* anchor = src;
+  const uint8_t* const end = src + size;
+  uint8_t* op = dst;
+  uint8_t* const op_end = dst + capacity;
+
+  while ( ip + PACK_LZ_MIN_MATCH <= end )
+  {
+    const uint32_t seq = PackRead32( ip );
+    const uint32_t h = ( seq * 2654435761u ) >> ( 32 - PACK_LZ_HASH_BITS );
+    const uint8_t* ref = src + table[h];
+    table[h] = (uint32_t)( ip - src );
+
+    if ( ref >= ip || ip - ref > PACK_LZ_MAX_OFFSET || PackRead32( ref ) != seq )
+    {
+      ip++;
+      continue;
+    }
+
+    const uint8_t* match_end = ip + PACK_LZ_MIN_MATCH;
+    const uint8_t* ref_end = ref + PACK_LZ_MIN_MATCH;
+    while ( match_end < end && *match_end == *ref_end )
+    {
+      match_end++;
+      ref_end++;
+    }
+
+    size_t literals = (size_t)( ip - anchor );
+    size_t match = (size_t)( match_end - ip ) - PACK_LZ_MIN_MATCH;
+
+    if ( op >= op_end ) goto overflow;
+    uint8_t* token = op++;
+    *token = (uint8_t)( ( literals < 15 ? literals : 15 ) << 4 | ( match < 15 ? match : 15 ) );
+
+    if ( literals >= 15 && ( op = PackWriteLength( op, op_end, literals - 15 ) ) == NULL ) goto overflow;
+    if ( (size_t)( op_end - op ) < literals + 2 ) goto overflow;
+    memcpy( op, anchor, literals );
+    op += literals;
+
+    const uint16_t offset = (uint16_t)( ip - ref );
+    *op++ = (uint8_t)( offset & 0xFF );
+    *op++ = (uint8_t)( offset >> 8 );
+
+    if ( match >= 15 && ( op = PackWriteLength( op, op_end, match - 15 ) ) == NULL ) goto overflow;
+
+    ip = match_end;
+    anchor = ip;
+  }
+
+  // Last sequence is literals only and ends the stream
+  size_t literals = (size_t)( end - anchor );
+  if ( op >= op_end ) goto overflow;
+  *op++ = (uint8_t)( ( literals < 15 ? literals : 15 ) << 4 );
+  if ( literals >= 15 && ( op = PackWriteLength( op, op_end, literals - 15 ) ) == NULL ) goto overflow;
+  if ( (size_t)( op_end - op ) < literals ) goto overflow;
+  memcpy( op, anchor, literals );
+  op += literals;
+
+  free( table );
+  return (size_t)( op - dst );
+
+overflow:
+  free( table );
+  return 0;
+}
+
+static int PackReadLength( const uint8_t** ip, const uint8_t* end, size_t* length )
+{
+  uint8_t b;
+
+  do
+  {
+    if ( *ip >= end ) return 1;
+    b = *( *ip )++;
+    *length += b;
+  } while ( b == 255 );
+
+  return 0;
+}
+
+static int PackDecompress( const uint8_t* src, const size_t size, uint8_t* dst, const size_t dst_size )
+{
+  const uint8_t* ip = src;
+  const uint8_t* const end = src + size;
+  uint8_t* op = dst;
+  uint8_t* const op_end = dst + dst_size;
+
+  while ( ip < end )
+  {
+    const uint8_t token = *ip++;
+
+    size_t literals = token >> 4;
+    if ( literals == 15 && PackReadLength( &ip, end, &literals ) ) return 1;
+    if ( (size_t)( end - ip ) < literals || (size_t)( op_end - op ) < literals ) return 1;
+
+    memcpy( op, ip, literals );
+    ip += literals;
+    op += literals;
+
+    // The stream ends on a literal run
+    if ( ip == end ) break;
+
+    if ( end - ip < 2 ) return 1;
+    const size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+    ip += 2;
+
+    size_t match = token & 0x0F;
+    if ( match == 15 && PackReadLength( &ip, end, &match ) ) return 1;
+    match += PACK_LZ_MIN_MATCH;
+
+    if ( offset == 0 || offset > (size_t)( op - dst ) || (size_t)( op_end - op ) < match ) return 1;
+
+    // Byte at a time: overlapping matches repeat a run
+    const uint8_t* ref = op - offset;
+    for ( size_t i = 0; i < match; i++ )
+    {
+      op[i] = ref[i];
+    }
+    op += match;
+  }
+
+  return op == op_end ? 0 : 1;
+}
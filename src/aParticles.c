@@ -0,0 +1,279 @@
+/*
+ * aParticles.c:
+ *
+ * Structure-of-arrays particle drawing. Positions and colors are read
+ * straight from the caller's arrays, four particles at a time, and
+ * expanded into one quad each; the whole set goes out in a single
+ * SDL_RenderGeometryRaw call. Texture coordinates and indices don't
+ * depend on the particles, so they are built once and reused.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define PARTICLES_INITIAL_SIZE 1024
+
+static float* xy = NULL;          // 8 floats per particle
+static uint32_t* colors = NULL;   // 4 SDL_Colors per particle
+static float* uv = NULL;          // 8 floats per particle
+static int* indices = NULL;       // 6 per particle
+static int particle_max = 0;
+
+static aRectf_t uv_region = { 0 };
+static int uv_count = 0;          // Particles with uv built for uv_region
+
+static int ParticlesReserve( const int count );
+static void ParticlesExpandXY( const float* x, const float* y, const float size, const int count );
+static void ParticlesExpandColors( const aParticles_t* p );
+static void ParticlesBuildUV( const aRectf_t region, const int count );
+
+void a_DrawParticles( const aParticles_t* particles )
+{
+  if ( particles == NULL || particles->x == NULL || particles->y == NULL ||
+       particles->count <= 0 || particles->size <= 0 )
+  {
+    return;
+  }
+
+  const int count = particles->count;
+  aImage_t* img = particles->image;
+
+  if ( img != NULL && ( img->texture == NULL || img->w <= 0 || img->h <= 0 ) ) return;
+
+  if ( ParticlesReserve( count ) ) return;
+
+  if ( img != NULL ) IMAGE_TOUCH( img );
+
+  ParticlesExpandXY( particles->x, particles->y, particles->size, count );
+  ParticlesExpandColors( particles );
+
+  // Queued primitives keep their place underneath the particles
+  a_DrawFlush();
+
+  if ( img == NULL )
+  {
+    a_RenderStateSetBlendMode( SDL_BLENDMODE_BLEND );
+    SDL_RenderGeometryRaw( app.renderer, NULL, xy, sizeof( float ) * 2,
+                           (const SDL_Color*)colors, sizeof( SDL_Color ),
+                           NULL, 0, count * 4, indices, count * 6, sizeof( int ) );
+  }
+  else
+  {
+    const aRectf_t* src = &particles->src;
+    aRectf_t s = a_ImageSourceRect( img, ( src->w > 0 && src->h > 0 ) ? src : NULL );
+    aRectf_t region = { s.x / img->w, s.y / img->h,
+                        ( s.x + s.w ) / img->w, ( s.y + s.h ) / img->h };
+
+    ParticlesBuildUV( region, count );
+
+    SDL_RenderGeometryRaw( app.renderer, img->texture, xy, sizeof( float ) * 2,
+                           (const SDL_Color*)colors, sizeof( SDL_Color ),
+                           uv, sizeof( float ) * 2, count * 4, indices, count * 6, sizeof( int ) );
+  }
+
+  RENDER_STATS_DRAW( img ? img->texture : NULL, count * 4 );
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)( particles->size * particles->size ) * count );
+}
+
+void a_ParticlesCleanUp( void )
+{
+  free( xy );
+  free( colors );
+  free( uv );
+  free( indices );
+
+  xy = NULL;
+  colors = NULL;
+  uv = NULL;
+  indices = NULL;
+  particle_max = 0;
+  uv_count = 0;
+}
+
+static int ParticlesReserve( const int count )
+{
+  if ( count <= particle_max ) return 0;
+
+  int new_max = particle_max ? particle_max : PARTICLES_INITIAL_SIZE;
+  while ( new_max < count ) new_max *= 2;
+
+  float* new_xy = realloc( xy, sizeof( float ) * 8 * new_max );
+  if ( new_xy != NULL ) xy = new_xy;
+
+  uint32_t* new_colors = realloc( colors, sizeof( uint32_t ) * 4 * new_max );
+  if ( new_colors != NULL ) colors = new_colors;
+
+  float* new_uv = realloc( uv, sizeof( float ) * 8 * new_max );
+  if ( new_uv != NULL ) uv = new_uv;
+
+  int* new_indices = realloc( indices, sizeof( int ) * 6 * new_max );
+  if ( new_indices != NULL ) indices = new_indices;
+
+  if ( !new_xy || !new_colors || !new_uv || !new_indices )
+  {
+    LOG( "Failed to grow the particle buffers" );
+    return 1;
+  }
+
+  a_SpriteBatchQuadIndices( indices, particle_max, new_max );
+
+  particle_max = new_max;
+
+  return 0;
+}
+
+/*
+ * Corners go top-left, top-right, bottom-right, bottom-left, i.e.
+ *   x y  r y  r b  x b   with r = x + size, b = y + size
+ */
+static void ParticlesExpandXY( const float* x, const float* y, const float size, const int count )
+{
+  int i = 0;
+  float* out = xy;
+
+#if defined(__SSE2__)
+  const __m128 s = _mm_set1_ps( size );
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    __m128 vx = _mm_loadu_ps( x + i );
+    __m128 vy = _mm_loadu_ps( y + i );
+    __m128 vr = _mm_add_ps( vx, s );
+    __m128 vb = _mm_add_ps( vy, s );
+
+    __m128 xy_lo = _mm_unpacklo_ps( vx, vy );   // x0 y0 x1 y1
+    __m128 xy_hi = _mm_unpackhi_ps( vx, vy );   // x2 y2 x3 y3
+    __m128 ry_lo = _mm_unpacklo_ps( vr, vy );
+    __m128 ry_hi = _mm_unpackhi_ps( vr, vy );
+    __m128 rb_lo = _mm_unpacklo_ps( vr, vb );
+    __m128 rb_hi = _mm_unpackhi_ps( vr, vb );
+    __m128 xb_lo = _mm_unpacklo_ps( vx, vb );
+    __m128 xb_hi = _mm_unpackhi_ps( vx, vb );
+
+    _mm_storeu_ps( out,      _mm_movelh_ps( xy_lo, ry_lo ) );   // x0 y0 r0 y0
+    _mm_storeu_ps( out + 4,  _mm_movelh_ps( rb_lo, xb_lo ) );   // r0 b0 x0 b0
+    _mm_storeu_ps( out + 8,  _mm_movehl_ps( ry_lo, xy_lo ) );   // x1 y1 r1 y1
+    _mm_storeu_ps( out + 12, _mm_movehl_ps( xb_lo, rb_lo ) );   // r1 b1 x1 b1
+    _mm_storeu_ps( out + 16, _mm_movelh_ps( xy_hi, ry_hi ) );
+    _mm_storeu_ps( out + 20, _mm_movelh_ps( rb_hi, xb_hi ) );
+    _mm_storeu_ps( out + 24, _mm_movehl_ps( ry_hi, xy_hi ) );
+    _mm_storeu_ps( out + 28, _mm_movehl_ps( xb_hi, rb_hi ) );
+
+    out += 32;
+  }
+#endif
+
+  for ( ; i < count; i++ )
+  {
+    float r = x[i] + size;
+    float b = y[i] + size;
+
+    out[0] = x[i]; out[1] = y[i];
+    out[2] = r;    out[3] = y[i];
+    out[4] = r;    out[5] = b;
+    out[6] = x[i]; out[7] = b;
+    out += 8;
+  }
+}
+
+static inline uint32_t ParticlesPack( const aColor_t c )
+{
+  uint32_t packed;
+
+  // Same byte order as SDL_Color, whatever the host endianness
+  memcpy( &packed, &c, sizeof( packed ) );
+
+  return packed;
+}
+
+static void ParticlesExpandColors( const aParticles_t* p )
+{
+  const int count = p->count;
+  const aColor_t* src = NULL;
+  uint32_t* out = colors;
+  int i = 0;
+
+  if ( p->colors != NULL )
+  {
+    // aColor_t and SDL_Color share a layout; each one is copied as a packed word
+    src = p->colors;
+  }
+  else if ( p->life != NULL && p->alpha_ramp != NULL && p->ramp_size > 0 )
+  {
+    // Resolve the ramp into the first count words of the output; the
+    // broadcast below runs back to front so it never overwrites its input
+    const float scale = ( p->ramp_size - 1 ) / ( p->life_max > 0 ? p->life_max : 1.0f );
+    aColor_t c = p->color;
+
+    for ( int k = 0; k < count; k++ )
+    {
+      float t = p->life[k] * scale;
+      int idx = t <= 0.0f ? 0 : ( t >= p->ramp_size - 1 ? p->ramp_size - 1 : (int)t );
+      c.a = p->alpha_ramp[idx];
+      out[k] = ParticlesPack( c );
+    }
+
+    for ( int k = count - 1; k >= 0; k-- )
+    {
+      uint32_t packed = out[k];
+      out[k * 4] = out[k * 4 + 1] = out[k * 4 + 2] = out[k * 4 + 3] = packed;
+    }
+    return;
+  }
+  else
+  {
+    a_PixelsFill32( out, count * 4, ParticlesPack( p->color ) );
+    return;
+  }
+
+#if defined(__SSE2__)
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+    _mm_storeu_si128( (__m128i*)( out ),      _mm_shuffle_epi32( v, 0x00 ) );
+    _mm_storeu_si128( (__m128i*)( out + 4 ),  _mm_shuffle_epi32( v, 0x55 ) );
+    _mm_storeu_si128( (__m128i*)( out + 8 ),  _mm_shuffle_epi32( v, 0xAA ) );
+    _mm_storeu_si128( (__m128i*)( out + 12 ), _mm_shuffle_epi32( v, 0xFF ) );
+    out += 16;
+  }
+#endif
+
+  for ( ; i < count; i++ )
+  {
+    out[0] = out[1] = out[2] = out[3] = ParticlesPack( src[i] );
+    out += 4;
+  }
+}
+
+static void ParticlesBuildUV( const aRectf_t region, const int count )
+{
+  // region holds u0 v0 u1 v1 in x y w h
+  if ( memcmp( &region, &uv_region, sizeof( region ) ) != 0 )
+  {
+    uv_region = region;
+    uv_count = 0;
+  }
+
+  if ( count <= uv_count ) return;
+
+  const float quad[8] = { region.x, region.y, region.w, region.y,
+                          region.w, region.h, region.x, region.h };
+
+  for ( int i = uv_count; i < count; i++ )
+  {
+    memcpy( &uv[i * 8], quad, sizeof( quad ) );
+  }
+
+  uv_count = count;
+}
+
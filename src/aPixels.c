@@ -0,0 +1,670 @@
+/*
+ * aPixels.c:
+ *
+ * Bulk pixel access for SDL surfaces. A session locks the surface once,
+ * maps colors through the surface's real pixel format and tracks the
+ * rect it touched, so procedural textures can be built row by row and
+ * pushed back to the GPU with a_ImageUploadRect(). The 32-bit span
+ * kernels underneath (fill, copy, src-over blend) are shared with the
+ * surface rasterizer and pick AVX2, SSE2 or scalar code at runtime.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+#include <immintrin.h>
+#define PIXELS_HAVE_AVX2 1
+#endif
+
+typedef void (*FillFunc_t)( uint32_t* dst, int count, uint32_t pixel );
+typedef void (*BlendColorFunc_t)( uint32_t* dst, int count, uint32_t pixel, uint8_t alpha );
+typedef void (*BlendFunc_t)( uint32_t* dst, const uint32_t* src, int count, int alpha_shift );
+
+static FillFunc_t       fill_span        = NULL;
+static BlendColorFunc_t blend_color_span = NULL;
+static BlendFunc_t      blend_span       = NULL;
+
+static void PixelsSelectKernels( void );
+static int PixelsIs8888( const SDL_PixelFormat* format );
+static int PixelsClipRow( const aPixels_t* px, int* x, const int y, int* count );
+static void PixelsMarkDirty( aPixels_t* px, const int x, const int y, const int w, const int h );
+static uint32_t PixelsLoad( const uint8_t* p, const int bpp );
+static void PixelsStore( uint8_t* p, const int bpp, const uint32_t value );
+static uint32_t PixelsBlendGeneric( const SDL_PixelFormat* format, const uint32_t d,
+                                    const aColor_t s );
+
+/*
+ * Span kernels. Blending is a byte-wise lerp toward a pixel whose alpha
+ * byte is 255, which is exactly src-over for every 8888 layout:
+ *   out = ( s * a + d * ( 255 - a ) + 128 ) / 255   (rounded)
+ * Every version of a kernel produces identical results.
+ */
+static inline uint32_t PixelsLerp( const uint32_t d, const uint32_t s, const uint32_t a )
+{
+  const uint32_t inv = 255 - a;
+  uint32_t out = 0;
+
+  for ( int shift = 0; shift < 32; shift += 8 )
+  {
+    uint32_t t = ( ( s >> shift ) & 0xFF ) * a + ( ( d >> shift ) & 0xFF ) * inv + 128;
+    out |= ( ( t + ( t >> 8 ) ) >> 8 ) << shift;
+  }
+
+  return out;
+}
+
+static void FillScalar( uint32_t* dst, int count, uint32_t pixel )
+{
+  for ( int i = 0; i < count; i++ )
+  {
+    dst[i] = pixel;
+  }
+}
+
+static void BlendColorScalar( uint32_t* dst, int count, uint32_t pixel, uint8_t alpha )
+{
+  for ( int i = 0; i < count; i++ )
+  {
+    dst[i] = PixelsLerp( dst[i], pixel, alpha );
+  }
+}
+
+static void BlendScalar( uint32_t* dst, const uint32_t* src, int count, int alpha_shift )
+{
+  const uint32_t amask = 0xFFu << alpha_shift;
+
+  for ( int i = 0; i < count; i++ )
+  {
+    uint32_t s = src[i];
+    uint32_t a = ( s >> alpha_shift ) & 0xFF;
+
+    if ( a == 255 )
+    {
+      dst[i] = s;
+    }
+    else if ( a != 0 )
+    {
+      dst[i] = PixelsLerp( dst[i], s | amask, a );
+    }
+  }
+}
+
+#if defined(__SSE2__)
+static void FillSSE2( uint32_t* dst, int count, uint32_t pixel )
+{
+  const __m128i p = _mm_set1_epi32( (int)pixel );
+  int i = 0;
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    _mm_storeu_si128( (__m128i*)( dst + i ), p );
+  }
+
+  FillScalar( dst + i, count - i, pixel );
+}
+
+static void BlendColorSSE2( uint32_t* dst, int count, uint32_t pixel, uint8_t alpha )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i inv  = _mm_set1_epi16( 255 - alpha );
+  const __m128i half = _mm_set1_epi16( 128 );
+  const __m128i src  = _mm_unpacklo_epi8( _mm_set1_epi32( (int)pixel ), zero );
+  const __m128i sa   = _mm_add_epi16( _mm_mullo_epi16( src, _mm_set1_epi16( alpha ) ), half );
+  int i = 0;
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    __m128i d  = _mm_loadu_si128( (const __m128i*)( dst + i ) );
+    __m128i lo = _mm_add_epi16( sa, _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), inv ) );
+    __m128i hi = _mm_add_epi16( sa, _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), inv ) );
+
+    lo = _mm_srli_epi16( _mm_add_epi16( lo, _mm_srli_epi16( lo, 8 ) ), 8 );
+    hi = _mm_srli_epi16( _mm_add_epi16( hi, _mm_srli_epi16( hi, 8 ) ), 8 );
+
+    _mm_storeu_si128( (__m128i*)( dst + i ), _mm_packus_epi16( lo, hi ) );
+  }
+
+  BlendColorScalar( dst + i, count - i, pixel, alpha );
+}
+
+static void BlendSSE2( uint32_t* dst, const uint32_t* src, int count, int alpha_shift )
+{
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i full  = _mm_set1_epi16( 255 );
+  const __m128i half  = _mm_set1_epi16( 128 );
+  const __m128i amask = _mm_set1_epi32( (int)( 0xFFu << alpha_shift ) );
+  const __m128i byte  = _mm_set1_epi32( 0xFF );
+  const __m128i shift = _mm_cvtsi32_si128( alpha_shift );
+  int i = 0;
+
+  for ( ; i + 4 <= count; i += 4 )
+  {
+    __m128i s = _mm_loadu_si128( (const __m128i*)( src + i ) );
+    __m128i d = _mm_loadu_si128( (const __m128i*)( dst + i ) );
+
+    // Broadcast each pixel's alpha byte across its four channels
+    __m128i a = _mm_and_si128( _mm_srl_epi32( s, shift ), byte );
+    a = _mm_or_si128( a, _mm_slli_epi32( a, 8 ) );
+    a = _mm_or_si128( a, _mm_slli_epi32( a, 16 ) );
+
+    s = _mm_or_si128( s, amask );
+
+    __m128i a_lo = _mm_unpacklo_epi8( a, zero );
+    __m128i a_hi = _mm_unpackhi_epi8( a, zero );
+
+    __m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), a_lo ),
+                                _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), _mm_sub_epi16( full, a_lo ) ) );
+    __m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), a_hi ),
+                                _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), _mm_sub_epi16( full, a_hi ) ) );
+
+    lo = _mm_add_epi16( lo, half );
+    hi = _mm_add_epi16( hi, half );
+    lo = _mm_srli_epi16( _mm_add_epi16( lo, _mm_srli_epi16( lo, 8 ) ), 8 );
+    hi = _mm_srli_epi16( _mm_add_epi16( hi, _mm_srli_epi16( hi, 8 ) ), 8 );
+
+    _mm_storeu_si128( (__m128i*)( dst + i ), _mm_packus_epi16( lo, hi ) );
+  }
+
+  BlendScalar( dst + i, src + i, count - i, alpha_shift );
+}
+#endif
+
+#if defined(PIXELS_HAVE_AVX2)
+__attribute__((target("avx2")))
+static void FillAVX2( uint32_t* dst, int count, uint32_t pixel )
+{
+  const __m256i p = _mm256_set1_epi32( (int)pixel );
+  int i = 0;
+
+  for ( ; i + 8 <= count; i += 8 )
+  {
+    _mm256_storeu_si256( (__m256i*)( dst + i ), p );
+  }
+
+  FillScalar( dst + i, count - i, pixel );
+}
+
+__attribute__((target("avx2")))
+static void BlendColorAVX2( uint32_t* dst, int count, uint32_t pixel, uint8_t alpha )
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i inv  = _mm256_set1_epi16( 255 - alpha );
+  const __m256i half = _mm256_set1_epi16( 128 );
+  const __m256i src  = _mm256_unpacklo_epi8( _mm256_set1_epi32( (int)pixel ), zero );
+  const __m256i sa   = _mm256_add_epi16( _mm256_mullo_epi16( src, _mm256_set1_epi16( alpha ) ), half );
+  int i = 0;
+
+  for ( ; i + 8 <= count; i += 8 )
+  {
+    __m256i d  = _mm256_loadu_si256( (const __m256i*)( dst + i ) );
+    __m256i lo = _mm256_add_epi16( sa, _mm256_mullo_epi16( _mm256_unpacklo_epi8( d, zero ), inv ) );
+    __m256i hi = _mm256_add_epi16( sa, _mm256_mullo_epi16( _mm256_unpackhi_epi8( d, zero ), inv ) );
+
+    lo = _mm256_srli_epi16( _mm256_add_epi16( lo, _mm256_srli_epi16( lo, 8 ) ), 8 );
+    hi = _mm256_srli_epi16( _mm256_add_epi16( hi, _mm256_srli_epi16( hi, 8 ) ), 8 );
+
+    // unpack/pack both work per 128-bit lane, so pixel order is preserved
+    _mm256_storeu_si256( (__m256i*)( dst + i ), _mm256_packus_epi16( lo, hi ) );
+  }
+
+  BlendColorScalar( dst + i, count - i, pixel, alpha );
+}
+
+__attribute__((target("avx2")))
+static void BlendAVX2( uint32_t* dst, const uint32_t* src, int count, int alpha_shift )
+{
+  const __m256i zero  = _mm256_setzero_si256();
+  const __m256i full  = _mm256_set1_epi16( 255 );
+  const __m256i half  = _mm256_set1_epi16( 128 );
+  const __m256i amask = _mm256_set1_epi32( (int)( 0xFFu << alpha_shift ) );
+  const __m256i byte  = _mm256_set1_epi32( 0xFF );
+  const __m128i shift = _mm_cvtsi32_si128( alpha_shift );
+  int i = 0;
+
+  for ( ; i + 8 <= count; i += 8 )
+  {
+    __m256i s = _mm256_loadu_si256( (const __m256i*)( src + i ) );
+    __m256i d = _mm256_loadu_si256( (const __m256i*)( dst + i ) );
+
+    __m256i a = _mm256_and_si256( _mm256_srl_epi32( s, shift ), byte );
+    a = _mm256_or_si256( a, _mm256_slli_epi32( a, 8 ) );
+    a = _mm256_or_si256( a, _mm256_slli_epi32( a, 16 ) );
+
+    s = _mm256_or_si256( s, amask );
+
+    __m256i a_lo = _mm256_unpacklo_epi8( a, zero );
+    __m256i a_hi = _mm256_unpackhi_epi8( a, zero );
+
+    __m256i lo = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( s, zero ), a_lo ),
+                                   _mm256_mullo_epi16( _mm256_unpacklo_epi8( d, zero ),
+                                                       _mm256_sub_epi16( full, a_lo ) ) );
+    __m256i hi = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( s, zero ), a_hi ),
+                                   _mm256_mullo_epi16( _mm256_unpackhi_epi8( d, zero ),
+                                                       _mm256_sub_epi16( full, a_hi ) ) );
+
+    lo = _mm256_add_epi16( lo, half );
+    hi = _mm256_add_epi16( hi, half );
+    lo = _mm256_srli_epi16( _mm256_add_epi16( lo, _mm256_srli_epi16( lo, 8 ) ), 8 );
+    hi = _mm256_srli_epi16( _mm256_add_epi16( hi, _mm256_srli_epi16( hi, 8 ) ), 8 );
+
+    _mm256_storeu_si256( (__m256i*)( dst + i ), _mm256_packus_epi16( lo, hi ) );
+  }
+
+  BlendScalar( dst + i, src + i, count - i, alpha_shift );
+}
+#endif
+
+static void PixelsSelectKernels( void )
+{
+  fill_span        = FillScalar;
+  blend_color_span = BlendColorScalar;
+  blend_span       = BlendScalar;
+
+#if defined(__SSE2__)
+  fill_span        = FillSSE2;
+  blend_color_span = BlendColorSSE2;
+  blend_span       = BlendSSE2;
+#endif
+
+#if defined(PIXELS_HAVE_AVX2)
+  if ( SDL_HasAVX2() )
+  {
+    fill_span        = FillAVX2;
+    blend_color_span = BlendColorAVX2;
+    blend_span       = BlendAVX2;
+  }
+#endif
+}
+
+void a_PixelsFill32( uint32_t* dst, const int count, const uint32_t pixel )
+{
+  if ( fill_span == NULL ) PixelsSelectKernels();
+
+  if ( count > 0 ) fill_span( dst, count, pixel );
+}
+
+void a_PixelsCopy32( uint32_t* dst, const uint32_t* src, const int count )
+{
+  // libc's memmove is already vectorized and handles overlap
+  if ( count > 0 ) memmove( dst, src, (size_t)count * sizeof( uint32_t ) );
+}
+
+void a_PixelsBlendColor32( uint32_t* dst, const int count, const uint32_t pixel, const uint8_t alpha )
+{
+  if ( fill_span == NULL ) PixelsSelectKernels();
+
+  if ( count <= 0 || alpha == 0 ) return;
+
+  if ( alpha == 255 )
+  {
+    fill_span( dst, count, pixel );
+  }
+  else
+  {
+    blend_color_span( dst, count, pixel, alpha );
+  }
+}
+
+void a_PixelsBlend32( uint32_t* dst, const uint32_t* src, const int count, const int alpha_shift )
+{
+  if ( fill_span == NULL ) PixelsSelectKernels();
+
+  if ( count <= 0 ) return;
+
+  // The vector kernels assume a byte-aligned alpha channel
+  if ( alpha_shift & 7 )
+  {
+    LOG( "a_PixelsBlend32: alpha channel is not byte aligned" );
+    return;
+  }
+
+  blend_span( dst, src, count, alpha_shift );
+}
+
+int a_PixelsBegin( aPixels_t* px, SDL_Surface* surface )
+{
+  if ( px == NULL || surface == NULL ) return 1;
+
+  *px = (aPixels_t){ 0 };
+
+  if ( SDL_MUSTLOCK( surface ) )
+  {
+    if ( SDL_LockSurface( surface ) != 0 )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to lock surface: %s",
+               log_level_strings[new_error.error_type], SDL_GetError() );
+      LOG( new_error.error_msg );
+      return 1;
+    }
+    px->locked = 1;
+  }
+
+  px->surface = surface;
+  px->pixels  = surface->pixels;
+  px->pitch   = surface->pitch;
+  px->bpp     = surface->format->BytesPerPixel;
+  px->fast    = PixelsIs8888( surface->format );
+
+  return 0;
+}
+
+void a_PixelsEnd( aPixels_t* px )
+{
+  if ( px == NULL || px->surface == NULL ) return;
+
+  if ( px->locked )
+  {
+    SDL_UnlockSurface( px->surface );
+  }
+
+  // Keep dirty so the caller can hand it to a_ImageUploadRect()
+  px->surface = NULL;
+  px->pixels  = NULL;
+  px->locked  = 0;
+}
+
+uint32_t a_PixelsMapColor( const aPixels_t* px, const aColor_t color )
+{
+  return SDL_MapRGBA( px->surface->format, color.r, color.g, color.b, color.a );
+}
+
+void a_PixelsWrite( aPixels_t* px, const int x, const int y, const aColor_t color )
+{
+  int cx = x;
+  int count = 1;
+
+  if ( !PixelsClipRow( px, &cx, y, &count ) ) return;
+
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)x * px->bpp;
+  PixelsStore( p, px->bpp, a_PixelsMapColor( px, color ) );
+
+  PixelsMarkDirty( px, x, y, 1, 1 );
+}
+
+void a_PixelsWriteSpan( aPixels_t* px, const int x, const int y,
+                        const aColor_t* colors, const int count )
+{
+  int cx = x;
+  int n = count;
+
+  if ( colors == NULL || !PixelsClipRow( px, &cx, y, &n ) ) return;
+
+  const SDL_PixelFormat* format = px->surface->format;
+  const aColor_t* c = colors + ( cx - x );
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)cx * px->bpp;
+
+  if ( px->bpp == 4 )
+  {
+    uint32_t* row = (uint32_t*)p;
+    for ( int i = 0; i < n; i++ )
+    {
+      row[i] = SDL_MapRGBA( format, c[i].r, c[i].g, c[i].b, c[i].a );
+    }
+  }
+  else
+  {
+    for ( int i = 0; i < n; i++ )
+    {
+      PixelsStore( p + i * px->bpp, px->bpp, SDL_MapRGBA( format, c[i].r, c[i].g, c[i].b, c[i].a ) );
+    }
+  }
+
+  PixelsMarkDirty( px, cx, y, n, 1 );
+}
+
+void a_PixelsFillRow( aPixels_t* px, const int x, const int y, const int count,
+                      const aColor_t color )
+{
+  int cx = x;
+  int n = count;
+
+  if ( !PixelsClipRow( px, &cx, y, &n ) ) return;
+
+  uint32_t pixel = a_PixelsMapColor( px, color );
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)cx * px->bpp;
+
+  if ( px->bpp == 4 )
+  {
+    a_PixelsFill32( (uint32_t*)p, n, pixel );
+  }
+  else
+  {
+    for ( int i = 0; i < n; i++ )
+    {
+      PixelsStore( p + i * px->bpp, px->bpp, pixel );
+    }
+  }
+
+  PixelsMarkDirty( px, cx, y, n, 1 );
+}
+
+void a_PixelsFillRect( aPixels_t* px, const aRecti_t rect, const aColor_t color )
+{
+  for ( int y = rect.y; y < rect.y + rect.h; y++ )
+  {
+    a_PixelsFillRow( px, rect.x, y, rect.w, color );
+  }
+}
+
+void a_PixelsBlendRow( aPixels_t* px, const int x, const int y, const int count,
+                       const aColor_t color )
+{
+  int cx = x;
+  int n = count;
+
+  if ( color.a == 0 || !PixelsClipRow( px, &cx, y, &n ) ) return;
+
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)cx * px->bpp;
+
+  if ( px->fast )
+  {
+    // Opaque alpha byte, see the blend kernels above
+    uint32_t pixel = SDL_MapRGBA( px->surface->format, color.r, color.g, color.b, 255 );
+    a_PixelsBlendColor32( (uint32_t*)p, n, pixel, color.a );
+  }
+  else
+  {
+    for ( int i = 0; i < n; i++ )
+    {
+      uint8_t* q = p + i * px->bpp;
+      PixelsStore( q, px->bpp, PixelsBlendGeneric( px->surface->format, PixelsLoad( q, px->bpp ), color ) );
+    }
+  }
+
+  PixelsMarkDirty( px, cx, y, n, 1 );
+}
+
+void a_PixelsBlendRect( aPixels_t* px, const aRecti_t rect, const aColor_t color )
+{
+  for ( int y = rect.y; y < rect.y + rect.h; y++ )
+  {
+    a_PixelsBlendRow( px, rect.x, y, rect.w, color );
+  }
+}
+
+void a_PixelsCopySpan( aPixels_t* px, const int x, const int y, const void* src, const int count )
+{
+  int cx = x;
+  int n = count;
+
+  if ( src == NULL || !PixelsClipRow( px, &cx, y, &n ) ) return;
+
+  const uint8_t* s = (const uint8_t*)src + (size_t)( cx - x ) * px->bpp;
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)cx * px->bpp;
+
+  memmove( p, s, (size_t)n * px->bpp );
+
+  PixelsMarkDirty( px, cx, y, n, 1 );
+}
+
+void a_PixelsBlendSpan( aPixels_t* px, const int x, const int y, const void* src, const int count )
+{
+  int cx = x;
+  int n = count;
+
+  if ( src == NULL || !PixelsClipRow( px, &cx, y, &n ) ) return;
+
+  const SDL_PixelFormat* format = px->surface->format;
+
+  // Without an alpha channel src-over is a plain copy
+  if ( format->Amask == 0 )
+  {
+    a_PixelsCopySpan( px, x, y, src, count );
+    return;
+  }
+
+  const uint8_t* s = (const uint8_t*)src + (size_t)( cx - x ) * px->bpp;
+  uint8_t* p = px->pixels + (size_t)y * px->pitch + (size_t)cx * px->bpp;
+
+  if ( px->fast )
+  {
+    a_PixelsBlend32( (uint32_t*)p, (const uint32_t*)s, n, format->Ashift );
+  }
+  else
+  {
+    for ( int i = 0; i < n; i++ )
+    {
+      aColor_t c;
+      SDL_GetRGBA( PixelsLoad( s + i * px->bpp, px->bpp ), format, &c.r, &c.g, &c.b, &c.a );
+
+      uint8_t* q = p + i * px->bpp;
+      PixelsStore( q, px->bpp, PixelsBlendGeneric( format, PixelsLoad( q, px->bpp ), c ) );
+    }
+  }
+
+  PixelsMarkDirty( px, cx, y, n, 1 );
+}
+
+/*
+ * 32-bit formats with full 8-bit channels (and a byte-aligned alpha, if
+ * any) go through the vector kernels; everything else is done per pixel.
+ */
+static int PixelsIs8888( const SDL_PixelFormat* format )
+{
+  if ( format->BytesPerPixel != 4 ) return 0;
+  if ( format->Rloss || format->Gloss || format->Bloss ) return 0;
+  if ( format->Amask && ( format->Aloss || ( format->Ashift & 7 ) ) ) return 0;
+
+  return 1;
+}
+
+/*
+ * Clips a row of *count pixels starting at (*x, y) to the surface's clip
+ * rect. Returns 0 when nothing is left to draw.
+ */
+static int PixelsClipRow( const aPixels_t* px, int* x, const int y, int* count )
+{
+  if ( px == NULL || px->pixels == NULL ) return 0;
+
+  const SDL_Rect* clip = &px->surface->clip_rect;
+
+  if ( y < clip->y || y >= clip->y + clip->h ) return 0;
+
+  int x0 = MAX( *x, clip->x );
+  int x1 = MIN( *x + *count, clip->x + clip->w );
+
+  if ( x0 >= x1 ) return 0;
+
+  *x = x0;
+  *count = x1 - x0;
+
+  return 1;
+}
+
+static void PixelsMarkDirty( aPixels_t* px, const int x, const int y, const int w, const int h )
+{
+  aRecti_t* d = &px->dirty;
+
+  if ( d->w == 0 || d->h == 0 )
+  {
+    *d = (aRecti_t){ x, y, w, h };
+    return;
+  }
+
+  int x0 = MIN( d->x, x );
+  int y0 = MIN( d->y, y );
+  int x1 = MAX( d->x + d->w, x + w );
+  int y1 = MAX( d->y + d->h, y + h );
+
+  *d = (aRecti_t){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+static uint32_t PixelsLoad( const uint8_t* p, const int bpp )
+{
+  switch ( bpp )
+  {
+    case 1:
+      return *p;
+
+    case 2:
+      return *(const uint16_t*)p;
+
+    case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+      return ( (uint32_t)p[0] << 16 ) | ( (uint32_t)p[1] << 8 ) | p[2];
+#else
+      return p[0] | ( (uint32_t)p[1] << 8 ) | ( (uint32_t)p[2] << 16 );
+#endif
+
+    default:
+      return *(const uint32_t*)p;
+  }
+}
+
+static void PixelsStore( uint8_t* p, const int bpp, const uint32_t value )
+{
+  switch ( bpp )
+  {
+    case 1:
+      *p = (uint8_t)value;
+      break;
+
+    case 2:
+      *(uint16_t*)p = (uint16_t)value;
+      break;
+
+    case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+      p[0] = ( value >> 16 ) & 0xFF;
+      p[1] = ( value >> 8 ) & 0xFF;
+      p[2] = value & 0xFF;
+#else
+      p[0] = value & 0xFF;
+      p[1] = ( value >> 8 ) & 0xFF;
+      p[2] = ( value >> 16 ) & 0xFF;
+#endif
+      break;
+
+    default:
+      *(uint32_t*)p = value;
+      break;
+  }
+}
+
+static uint32_t PixelsBlendGeneric( const SDL_PixelFormat* format, const uint32_t d,
+                                    const aColor_t s )
+{
+  aColor_t dc;
+  SDL_GetRGBA( d, format, &dc.r, &dc.g, &dc.b, &dc.a );
+
+  // Same rounding as the 32-bit kernels
+  uint32_t out = PixelsLerp( ( (uint32_t)dc.a << 24 ) | ( (uint32_t)dc.r << 16 ) | ( (uint32_t)dc.g << 8 ) | dc.b,
+                             ( 255u << 24 ) | ( (uint32_t)s.r << 16 ) | ( (uint32_t)s.g << 8 ) | s.b,
+                             s.a );
+
+  return SDL_MapRGBA( format, ( out >> 16 ) & 0xFF, ( out >> 8 ) & 0xFF, out & 0xFF, out >> 24 );
+}
+
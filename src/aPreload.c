@@ -0,0 +1,551 @@
+/*
+ * aPreload.c:
+ *
+ * Loads a whole manifest of images, sounds and widget files at once for
+ * loading screens. All files are handed to the kernel for read-ahead as
+ * one batch before anything is decoded, so the disk is busy while the
+ * first decodes run. Images then go through a_ImageLoadAsync() and its
+ * loader threads and upload budget; sounds decode on a few preload
+ * threads of their own; widget files are applied on the main thread once
+ * the images they draw are in. Every asset records how long it took.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "Archimedes.h"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static aPreload_t* PreloadCreate( aPreloadProgress_t progress, void* user );
+static int PreloadAdd( aPreload_t* preload, const char* path, const int type );
+static int PreloadTypeFromPath( const char* path );
+static int PreloadParseAUF( aPreload_t* preload, const char* manifest );
+static int PreloadParseList( aPreload_t* preload, const char* manifest );
+static aPreload_t* PreloadStart( aPreload_t* preload, const int image_flags );
+static void PreloadReadAhead( const aPreload_t* preload );
+static int PreloadWorker( void* data );
+static void PreloadImageLoaded( aImage_t* img, void* user );
+static void PreloadFinish( aPreloadAsset_t* asset, const int failed );
+static void PreloadCollect( aPreload_t* preload );
+static void PreloadJoin( aPreload_t* preload );
+static float PreloadElapsedMs( const Uint64 start );
+static int PreloadCompareTime( const void* a, const void* b );
+
+aPreload_t* a_Preload( const char* manifest, const int image_flags,
+                       aPreloadProgress_t progress, void* user )
+{
+  if ( manifest == NULL ) return NULL;
+
+  aPreload_t* preload = PreloadCreate( progress, user );
+  if ( preload == NULL ) return NULL;
+
+  const char* ext = strrchr( manifest, '.' );
+  int status = ( ext != NULL && strcasecmp( ext, ".auf" ) == 0 )
+             ? PreloadParseAUF( preload, manifest )
+             : PreloadParseList( preload, manifest );
+
+  if ( status != 0 )
+  {
+    a_PreloadFree( preload );
+    return NULL;
+  }
+
+  return PreloadStart( preload, image_flags );
+}
+
+aPreload_t* a_PreloadList( const char** paths, const int count, const int image_flags,
+                           aPreloadProgress_t progress, void* user )
+{
+  if ( paths == NULL || count < 0 ) return NULL;
+
+  aPreload_t* preload = PreloadCreate( progress, user );
+  if ( preload == NULL ) return NULL;
+
+  for ( int i = 0; i < count; i++ )
+  {
+    int type = PreloadTypeFromPath( paths[i] );
+    if ( type < 0 ) continue;
+
+    if ( PreloadAdd( preload, paths[i], type ) != 0 )
+    {
+      a_PreloadFree( preload );
+      return NULL;
+    }
+  }
+
+  return PreloadStart( preload, image_flags );
+}
+
+int a_PreloadUpdate( aPreload_t* preload )
+{
+  if ( preload == NULL ) return 1;
+
+  PreloadCollect( preload );
+
+  // Everything but the widget files is in, so their images are cache hits
+  if ( preload->widgets_left > 0 && preload->done + preload->widgets_left == preload->count )
+  {
+    for ( int i = 0; i < preload->count; i++ )
+    {
+      aPreloadAsset_t* asset = &preload->assets[i];
+      if ( asset->type != PRELOAD_WIDGETS || asset->state != PRELOAD_PENDING ) continue;
+
+      Uint64 start = SDL_GetPerformanceCounter();
+      a_WidgetsInit( asset->path );
+      asset->upload_ms = PreloadElapsedMs( start );
+
+      preload->widgets_left--;
+      PreloadFinish( asset, 0 );
+    }
+  }
+
+  if ( preload->done < preload->count ) return 0;
+
+  if ( preload->worker_count > 0 )
+  {
+    PreloadJoin( preload );
+  }
+
+  return 1;
+}
+
+int a_PreloadWait( aPreload_t* preload )
+{
+  if ( preload == NULL ) return 1;
+
+  // a_ImageLoad() finishes a pending image on the spot, callback included
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    aPreloadAsset_t* asset = &preload->assets[i];
+    if ( asset->type == PRELOAD_IMAGE && asset->state == PRELOAD_PENDING &&
+         asset->image != NULL && asset->image->state == IMAGE_STATE_PENDING )
+    {
+      a_ImageRelease( a_ImageLoad( asset->path ) );
+    }
+  }
+
+  if ( preload->worker_count > 0 )
+  {
+    PreloadJoin( preload );
+  }
+
+  a_PreloadUpdate( preload );
+
+  return preload->failed > 0;
+}
+
+int a_PreloadTakeSound( aPreload_t* preload, const char* filename, aSoundEffect_t* sound )
+{
+  if ( preload == NULL || filename == NULL || sound == NULL ) return 1;
+
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    aPreloadAsset_t* asset = &preload->assets[i];
+    if ( asset->type != PRELOAD_SOUND || asset->state != PRELOAD_DONE ||
+         asset->sound.chunk == NULL || strcmp( asset->path, filename ) != 0 )
+    {
+      continue;
+    }
+
+    *sound = asset->sound;
+    asset->sound.chunk = NULL;
+    return 0;
+  }
+
+  return 1;
+}
+
+void a_PreloadReport( const aPreload_t* preload, const int max_rows )
+{
+  if ( preload == NULL || preload->count == 0 ) return;
+
+  const aPreloadAsset_t** order = malloc( sizeof( aPreloadAsset_t* ) * preload->count );
+  if ( order == NULL ) return;
+
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    order[i] = &preload->assets[i];
+  }
+  qsort( order, preload->count, sizeof( aPreloadAsset_t* ), PreloadCompareTime );
+
+  static const char* types[] = { "image", "sound", "widgets" };
+  int rows = ( max_rows > 0 && max_rows < preload->count ) ? max_rows : preload->count;
+
+  printf( "Preload: %d assets, %d failed, %.1f ms\n", preload->count, preload->failed,
+          preload->total_ms );
+  printf( "  %9s %9s %9s  %-7s  %s\n", "decode", "upload", "done at", "type", "path" );
+
+  for ( int i = 0; i < rows; i++ )
+  {
+    const aPreloadAsset_t* asset = order[i];
+    printf( "  %9.2f %9.2f %9.1f  %-7s  %s%s\n", asset->decode_ms, asset->upload_ms,
+            asset->done_ms, types[asset->type], asset->path,
+            asset->state == PRELOAD_FAILED ? " (failed)" : "" );
+  }
+
+  free( order );
+}
+
+void a_PreloadFree( aPreload_t* preload )
+{
+  if ( preload == NULL ) return;
+
+  // Image callbacks and workers both point into the asset array
+  SDL_AtomicSet( &preload->cancel, 1 );
+  preload->progress = NULL;
+  a_PreloadWait( preload );
+
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    aPreloadAsset_t* asset = &preload->assets[i];
+
+    a_ImageRelease( asset->image );
+    if ( asset->sound.chunk != NULL )
+    {
+      a_AudioFreeSound( &asset->sound );
+    }
+  }
+
+  if ( preload->lock != NULL ) SDL_DestroyMutex( preload->lock );
+  free( preload->finished );
+  free( preload->assets );
+  free( preload );
+}
+
+static aPreload_t* PreloadCreate( aPreloadProgress_t progress, void* user )
+{
+  aPreload_t* preload = calloc( 1, sizeof( aPreload_t ) );
+  if ( preload == NULL )
+  {
+    LOG( "Failed to allocate memory for a preload" );
+    return NULL;
+  }
+
+  preload->progress = progress;
+  preload->user = user;
+  preload->start = SDL_GetPerformanceCounter();
+
+  return preload;
+}
+
+static int PreloadAdd( aPreload_t* preload, const char* path, const int type )
+{
+  // Capacity is the next power of two, so it's full exactly when count is one
+  const int count = preload->count;
+  if ( ( count & ( count - 1 ) ) == 0 )
+  {
+    aPreloadAsset_t* assets = realloc( preload->assets,
+                                       sizeof( aPreloadAsset_t ) * ( count ? count * 2 : 1 ) );
+    if ( assets == NULL )
+    {
+      LOG( "Failed to allocate memory for preload assets" );
+      return 1;
+    }
+    preload->assets = assets;
+  }
+
+  aPreloadAsset_t* asset = &preload->assets[preload->count++];
+  *asset = (aPreloadAsset_t){ 0 };
+  STRNCPY( asset->path, path, MAX_FILENAME_LENGTH );
+  asset->type = type;
+  asset->state = PRELOAD_PENDING;
+  asset->preload = preload;
+
+  if ( type == PRELOAD_WIDGETS ) preload->widgets_left++;
+
+  return 0;
+}
+
+static int PreloadTypeFromPath( const char* path )
+{
+  static const char* images[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".qoi" };
+  static const char* sounds[] = { ".wav", ".ogg", ".mp3", ".flac", ".opus" };
+
+  const char* ext = ( path != NULL ) ? strrchr( path, '.' ) : NULL;
+
+  if ( ext != NULL )
+  {
+    for ( size_t i = 0; i < sizeof( images ) / sizeof( images[0] ); i++ )
+    {
+      if ( strcasecmp( ext, images[i] ) == 0 ) return PRELOAD_IMAGE;
+    }
+
+    for ( size_t i = 0; i < sizeof( sounds ) / sizeof( sounds[0] ); i++ )
+    {
+      if ( strcasecmp( ext, sounds[i] ) == 0 ) return PRELOAD_SOUND;
+    }
+
+    if ( strcasecmp( ext, ".auf" ) == 0 ) return PRELOAD_WIDGETS;
+  }
+
+  aError_t new_error;
+  new_error.error_type = WARNING;
+  snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Don't know how to preload %s, skipping it",
+           log_level_strings[new_error.error_type], path ? path : "(null)" );
+  LOG( new_error.error_msg );
+
+  return -1;
+}
+
+static int PreloadParseAUF( aPreload_t* preload, const char* manifest )
+{
+  static const char* keys[] = { "images", "sounds", "widgets" };
+  static const int types[] = { PRELOAD_IMAGE, PRELOAD_SOUND, PRELOAD_WIDGETS };
+
+  aAUF_t* root = a_AUFParser( manifest );
+  if ( root == NULL ) return 1;
+
+  int status = 0;
+
+  for ( aAUFNode_t* section = root->head; section != NULL && status == 0; section = section->next )
+  {
+    for ( int k = 0; k < 3 && status == 0; k++ )
+    {
+      aAUFNode_t* list = a_AUFGetObjectItem( section, (char*)keys[k] );
+      if ( list == NULL ) continue;
+
+      for ( aAUFNode_t* item = list->child; item != NULL && status == 0; item = item->next )
+      {
+        if ( item->value_string == NULL ) continue;
+
+        status = PreloadAdd( preload, item->value_string, types[k] );
+      }
+    }
+  }
+
+  a_AUFFree( root );
+  free( root );
+
+  return status;
+}
+
+static int PreloadParseList( aPreload_t* preload, const char* manifest )
+{
+  int size = 0;
+  char* text = a_ReadFile( manifest, &size );
+  if ( text == NULL ) return 1;
+
+  int status = 0;
+  char* line = text;
+
+  while ( line != NULL && status == 0 )
+  {
+    char* next = strchr( line, '\n' );
+    if ( next != NULL ) *next++ = '\0';
+
+    // Trim both ends; Windows line endings leave a '\r' behind
+    while ( *line == ' ' || *line == '\t' ) line++;
+    char* end = line + strlen( line );
+    while ( end > line && ( end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' ) ) *--end = '\0';
+
+    if ( *line != '\0' && *line != '#' )
+    {
+      int type = PreloadTypeFromPath( line );
+      if ( type >= 0 ) status = PreloadAdd( preload, line, type );
+    }
+
+    line = next;
+  }
+
+  free( text );
+
+  return status;
+}
+
+static aPreload_t* PreloadStart( aPreload_t* preload, const int image_flags )
+{
+  PreloadReadAhead( preload );
+
+  int sounds = 0;
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    sounds += ( preload->assets[i].type == PRELOAD_SOUND );
+  }
+
+  if ( sounds > 0 )
+  {
+    preload->lock = SDL_CreateMutex();
+    preload->finished = malloc( sizeof( int ) * sounds );
+    if ( preload->lock == NULL || preload->finished == NULL )
+    {
+      LOG( "Failed to set up the preload sound queue" );
+      a_PreloadFree( preload );
+      return NULL;
+    }
+
+    // Leave a core for the main thread and one for the image loader
+    int wanted = SDL_GetCPUCount() - 2;
+    if ( wanted < 1 ) wanted = 1;
+    if ( wanted > PRELOAD_MAX_WORKERS ) wanted = PRELOAD_MAX_WORKERS;
+    if ( wanted > sounds ) wanted = sounds;
+
+    for ( int i = 0; i < wanted; i++ )
+    {
+      SDL_Thread* worker = SDL_CreateThread( PreloadWorker, "aPreload", preload );
+      if ( worker == NULL ) break;
+
+      preload->workers[preload->worker_count++] = worker;
+    }
+
+    // No threads: the sounds load here instead
+    if ( preload->worker_count == 0 )
+    {
+      PreloadWorker( preload );
+    }
+  }
+
+  preload->queueing = 1;
+
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    aPreloadAsset_t* asset = &preload->assets[i];
+    if ( asset->type != PRELOAD_IMAGE ) continue;
+
+    asset->image = a_ImageLoadAsync( asset->path, image_flags, PreloadImageLoaded, asset );
+    if ( asset->image == NULL && asset->state == PRELOAD_PENDING )
+    {
+      PreloadFinish( asset, 1 );
+    }
+  }
+
+  preload->queueing = 0;
+
+  return preload;
+}
+
+/*
+ * One pass over every file before any decoding starts, so the reads are
+ * queued together and overlap with the first decodes. Packed images are
+ * skipped; their pixels come out of the pack's mapping instead.
+ */
+static void PreloadReadAhead( const aPreload_t* preload )
+{
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+  for ( int i = 0; i < preload->count; i++ )
+  {
+    const aPreloadAsset_t* asset = &preload->assets[i];
+    if ( asset->type == PRELOAD_IMAGE && a_PackContains( asset->path ) ) continue;
+
+    int fd = open( asset->path, O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 ) continue;
+
+    posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+    close( fd );
+  }
+#else
+  (void)preload;
+#endif
+}
+
+static int PreloadWorker( void* data )
+{
+  aPreload_t* preload = data;
+
+  for ( ;; )
+  {
+    if ( SDL_AtomicGet( &preload->cancel ) ) break;
+
+    int i = SDL_AtomicAdd( &preload->next, 1 );
+    if ( i >= preload->count ) break;
+
+    aPreloadAsset_t* asset = &preload->assets[i];
+    if ( asset->type != PRELOAD_SOUND ) continue;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    int failed = a_AudioLoadSound( asset->path, &asset->sound ) != 0;
+    asset->decode_ms = PreloadElapsedMs( start );
+
+    // state belongs to the main thread; failures are queued as -1 - index
+    SDL_LockMutex( preload->lock );
+    preload->finished[preload->finished_count++] = failed ? -1 - i : i;
+    SDL_UnlockMutex( preload->lock );
+  }
+
+  return 0;
+}
+
+static void PreloadImageLoaded( aImage_t* img, void* user )
+{
+  aPreloadAsset_t* asset = user;
+
+  // Already cached and ready: nothing was decoded for this preload
+  if ( !asset->preload->queueing || img->state != IMAGE_STATE_READY )
+  {
+    asset->decode_ms = img->decode_ms;
+    asset->upload_ms = img->upload_ms;
+  }
+
+  PreloadFinish( asset, img->state != IMAGE_STATE_READY );
+}
+
+static void PreloadFinish( aPreloadAsset_t* asset, const int failed )
+{
+  aPreload_t* preload = asset->preload;
+
+  asset->state = failed ? PRELOAD_FAILED : PRELOAD_DONE;
+
+  asset->done_ms = PreloadElapsedMs( preload->start );
+
+  preload->done++;
+  if ( asset->state == PRELOAD_FAILED ) preload->failed++;
+
+  if ( preload->done == preload->count )
+  {
+    preload->total_ms = asset->done_ms;
+  }
+
+  if ( preload->progress != NULL ) preload->progress( preload, asset, preload->user );
+}
+
+static void PreloadCollect( aPreload_t* preload )
+{
+  if ( preload->lock == NULL ) return;
+
+  SDL_LockMutex( preload->lock );
+  int finished_count = preload->finished_count;
+  SDL_UnlockMutex( preload->lock );
+
+  // Entries below finished_count are never written again
+  while ( preload->finished_read < finished_count )
+  {
+    int i = preload->finished[preload->finished_read++];
+    PreloadFinish( &preload->assets[i < 0 ? -1 - i : i], i < 0 );
+  }
+}
+
+static void PreloadJoin( aPreload_t* preload )
+{
+  for ( int i = 0; i < preload->worker_count; i++ )
+  {
+    SDL_WaitThread( preload->workers[i], NULL );
+    preload->workers[i] = NULL;
+  }
+
+  preload->worker_count = 0;
+
+  PreloadCollect( preload );
+}
+
+static float PreloadElapsedMs( const Uint64 start )
+{
+  return (float)( ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() );
+}
+
+static int PreloadCompareTime( const void* a, const void* b )
+{
+  const aPreloadAsset_t* pa = *(const aPreloadAsset_t* const*)a;
+  const aPreloadAsset_t* pb = *(const aPreloadAsset_t* const*)b;
+  float ta = pa->decode_ms + pa->upload_ms;
+  float tb = pb->decode_ms + pb->upload_ms;
+
+  return ( ta < tb ) - ( ta > tb );
+}
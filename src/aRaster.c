@@ -0,0 +1,177 @@
+/*
+ * aRaster.c:
+ *
+ * CPU rasterizer for filled triangles and convex polygons drawn straight
+ * into an SDL_Surface. Triangles are walked one scanline at a time with
+ * incremental edge functions; each row resolves to a single span that is
+ * handed to the shared fill/blend kernels in aPixels.c.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+#include "Archimedes.h"
+
+#define RASTER_SUBPIXEL_BITS 4
+#define RASTER_SUBPIXEL      ( 1 << RASTER_SUBPIXEL_BITS )
+#define RASTER_HALF_PIXEL    ( RASTER_SUBPIXEL / 2 )
+
+static void RasterTriangle( SDL_Surface* surface, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                            int32_t x2, int32_t y2, const uint32_t pixel, const uint8_t alpha );
+
+static int64_t FloorDiv( const int64_t a, const int64_t b )
+{
+  int64_t q = a / b;
+  return ( ( a % b ) != 0 && ( ( a < 0 ) != ( b < 0 ) ) ) ? q - 1 : q;
+}
+
+static int64_t CeilDiv( const int64_t a, const int64_t b )
+{
+  return -FloorDiv( -a, b );
+}
+
+/*
+ * Coordinates are fixed point with RASTER_SUBPIXEL_BITS of fraction.
+ * Pixel (px, py) is covered when its center lies inside all three edges;
+ * centers exactly on an edge belong to the triangle only if that edge is
+ * a top or left edge, so shared edges are filled exactly once.
+ */
+static void RasterTriangle( SDL_Surface* surface, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                            int32_t x2, int32_t y2, const uint32_t pixel, const uint8_t alpha )
+{
+  int64_t area = (int64_t)( x1 - x0 ) * ( y2 - y0 ) - (int64_t)( y1 - y0 ) * ( x2 - x0 );
+  if ( area == 0 ) return;
+
+  if ( area < 0 )
+  {
+    int32_t tx = x1, ty = y1;
+    x1 = x2; y1 = y2;
+    x2 = tx; y2 = ty;
+  }
+
+  const int32_t vx[3] = { x0, x1, x2 };
+  const int32_t vy[3] = { y0, y1, y2 };
+
+  int64_t row_value[3];  // Edge function at pixel x = 0 for the current row
+  int64_t step_x[3];     // Change per pixel to the right
+  int64_t step_y[3];     // Change per row down
+  int64_t bias[3];
+
+  const SDL_Rect* clip = &surface->clip_rect;
+
+  int min_y = MIN( y0, MIN( y1, y2 ) ) >> RASTER_SUBPIXEL_BITS;
+  int max_y = MAX( y0, MAX( y1, y2 ) ) >> RASTER_SUBPIXEL_BITS;
+  min_y = MAX( min_y, clip->y );
+  max_y = MIN( max_y, clip->y + clip->h - 1 );
+
+  if ( min_y > max_y ) return;
+
+  const int64_t py0 = (int64_t)min_y * RASTER_SUBPIXEL + RASTER_HALF_PIXEL;
+
+  for ( int e = 0; e < 3; e++ )
+  {
+    int a = e;
+    int b = ( e + 1 ) % 3;
+    int64_t dx = vx[b] - vx[a];
+    int64_t dy = vy[b] - vy[a];
+
+    row_value[e] = dx * ( py0 - vy[a] ) - dy * ( RASTER_HALF_PIXEL - vx[a] );
+    step_x[e] = -dy * RASTER_SUBPIXEL;
+    step_y[e] =  dx * RASTER_SUBPIXEL;
+
+    // Top-left rule for this winding: edges going up, or flat edges going right
+    int top_left = ( dy < 0 ) || ( dy == 0 && dx > 0 );
+    bias[e] = top_left ? 0 : -1;
+  }
+
+  const int clip_x0 = clip->x;
+  const int clip_x1 = clip->x + clip->w - 1;
+
+  for ( int py = min_y; py <= max_y; py++ )
+  {
+    int64_t left  = clip_x0;
+    int64_t right = clip_x1;
+
+    for ( int e = 0; e < 3; e++ )
+    {
+      int64_t c = row_value[e] + bias[e];
+
+      // Solve c + step_x * px >= 0 for px
+      if ( step_x[e] > 0 )
+      {
+        left = MAX( left, CeilDiv( -c, step_x[e] ) );
+      }
+      else if ( step_x[e] < 0 )
+      {
+        right = MIN( right, FloorDiv( c, -step_x[e] ) );
+      }
+      else if ( c < 0 )
+      {
+        right = left - 1;
+      }
+
+      row_value[e] += step_y[e];
+    }
+
+    if ( left > right ) continue;
+
+    uint32_t* row = (uint32_t*)( (uint8_t*)surface->pixels + (size_t)py * surface->pitch ) + left;
+
+    a_PixelsBlendColor32( row, (int)( right - left + 1 ), pixel, alpha );
+  }
+}
+
+void a_DrawSurfaceFilledPolygon( SDL_Surface* surface, const aPoint2f_t* points,
+                                 const int count, const aColor_t color )
+{
+  if ( surface == NULL || points == NULL || count < 3 || color.a == 0 ) return;
+
+  if ( surface->format->BytesPerPixel != 4 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Surface rasterizer needs a 32-bit surface, got %s",
+             log_level_strings[new_error.error_type], SDL_GetPixelFormatName( surface->format->format ) );
+    LOG( new_error.error_msg );
+    return;
+  }
+
+  if ( SDL_MUSTLOCK( surface ) && SDL_LockSurface( surface ) != 0 )
+  {
+    return;
+  }
+
+  // Opaque alpha byte, see the blend kernels in aPixels.c
+  uint32_t pixel = SDL_MapRGB( surface->format, color.r, color.g, color.b );
+
+  int32_t fx0 = (int32_t)lrintf( points[0].x * RASTER_SUBPIXEL );
+  int32_t fy0 = (int32_t)lrintf( points[0].y * RASTER_SUBPIXEL );
+
+  for ( int i = 1; i < count - 1; i++ )
+  {
+    RasterTriangle( surface, fx0, fy0,
+                    (int32_t)lrintf( points[i].x * RASTER_SUBPIXEL ),
+                    (int32_t)lrintf( points[i].y * RASTER_SUBPIXEL ),
+                    (int32_t)lrintf( points[i + 1].x * RASTER_SUBPIXEL ),
+                    (int32_t)lrintf( points[i + 1].y * RASTER_SUBPIXEL ),
+                    pixel, color.a );
+  }
+
+  if ( SDL_MUSTLOCK( surface ) )
+  {
+    SDL_UnlockSurface( surface );
+  }
+}
+
+void a_DrawSurfaceFilledTriangle( SDL_Surface* surface, const int x0, const int y0,
+                                  const int x1, const int y1, const int x2, const int y2,
+                                  const aColor_t color )
+{
+  const aPoint2f_t points[3] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+
+  a_DrawSurfaceFilledPolygon( surface, points, 3, color );
+}
+
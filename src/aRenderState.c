@@ -0,0 +1,183 @@
+/*
+ * aRenderState.c:
+ *
+ * Shadow copy of the SDL renderer state. Every engine draw path goes
+ * through these setters, which only call into SDL when the requested
+ * value differs from what the renderer already has.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#define RENDER_STATE_DRAW_COLOR 0x01
+#define RENDER_STATE_BLEND_MODE 0x02
+
+static aTextureModState_t* TextureSlot( SDL_Texture* texture );
+
+void a_RenderStateInvalidate( void )
+{
+  aRenderState_t* rs = &app.render_state;
+
+  rs->known = 0;
+  memset( rs->textures, 0, sizeof( rs->textures ) );
+}
+
+void a_RenderStateSetDrawColor( const aColor_t color )
+{
+  aRenderState_t* rs = &app.render_state;
+
+  if ( ( rs->known & RENDER_STATE_DRAW_COLOR ) &&
+       rs->draw_color.r == color.r && rs->draw_color.g == color.g &&
+       rs->draw_color.b == color.b && rs->draw_color.a == color.a )
+  {
+    rs->skipped++;
+    return;
+  }
+
+  SDL_SetRenderDrawColor( app.renderer, color.r, color.g, color.b, color.a );
+  rs->draw_color = color;
+  rs->known |= RENDER_STATE_DRAW_COLOR;
+  rs->applied++;
+}
+
+void a_RenderStateSetBlendMode( const SDL_BlendMode mode )
+{
+  aRenderState_t* rs = &app.render_state;
+
+  if ( ( rs->known & RENDER_STATE_BLEND_MODE ) && rs->blend_mode == mode )
+  {
+    rs->skipped++;
+    return;
+  }
+
+  SDL_SetRenderDrawBlendMode( app.renderer, mode );
+  rs->blend_mode = mode;
+  rs->known |= RENDER_STATE_BLEND_MODE;
+  rs->applied++;
+}
+
+void a_RenderStateSetTextureColorMod( SDL_Texture* texture, const uint8_t r,
+                                      const uint8_t g, const uint8_t b )
+{
+  if ( texture == NULL ) return;
+
+  aRenderState_t* rs = &app.render_state;
+  aTextureModState_t* slot = TextureSlot( texture );
+
+  if ( slot->texture == texture && slot->color_known &&
+       slot->mod.r == r && slot->mod.g == g && slot->mod.b == b )
+  {
+    rs->skipped++;
+    return;
+  }
+
+  if ( slot->texture != texture )
+  {
+    // Slot belonged to another texture; start over with nothing known
+    *slot = (aTextureModState_t){ .texture = texture };
+  }
+
+  SDL_SetTextureColorMod( texture, r, g, b );
+  slot->mod.r = r;
+  slot->mod.g = g;
+  slot->mod.b = b;
+  slot->color_known = 1;
+  rs->applied++;
+}
+
+void a_RenderStateSetTextureAlphaMod( SDL_Texture* texture, const uint8_t a )
+{
+  if ( texture == NULL ) return;
+
+  aRenderState_t* rs = &app.render_state;
+  aTextureModState_t* slot = TextureSlot( texture );
+
+  if ( slot->texture == texture && slot->alpha_known && slot->mod.a == a )
+  {
+    rs->skipped++;
+    return;
+  }
+
+  if ( slot->texture != texture )
+  {
+    *slot = (aTextureModState_t){ .texture = texture };
+  }
+
+  SDL_SetTextureAlphaMod( texture, a );
+  slot->mod.a = a;
+  slot->alpha_known = 1;
+  rs->applied++;
+}
+
+void a_RenderStateSetTextureBlendMode( SDL_Texture* texture, const SDL_BlendMode mode )
+{
+  if ( texture == NULL ) return;
+
+  aRenderState_t* rs = &app.render_state;
+  aTextureModState_t* slot = TextureSlot( texture );
+
+  if ( slot->texture == texture && slot->blend_known && slot->blend == mode )
+  {
+    rs->skipped++;
+    return;
+  }
+
+  if ( slot->texture != texture )
+  {
+    *slot = (aTextureModState_t){ .texture = texture };
+  }
+
+  SDL_SetTextureBlendMode( texture, mode );
+  slot->blend = mode;
+  slot->blend_known = 1;
+  rs->applied++;
+}
+
+SDL_BlendMode a_RenderStateGetTextureBlendMode( SDL_Texture* texture )
+{
+  SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+
+  if ( texture == NULL ) return mode;
+
+  aTextureModState_t* slot = TextureSlot( texture );
+
+  if ( slot->texture == texture && slot->blend_known ) return slot->blend;
+
+  if ( slot->texture != texture )
+  {
+    *slot = (aTextureModState_t){ .texture = texture };
+  }
+
+  // A read, not a state change, so it doesn't count either way
+  SDL_GetTextureBlendMode( texture, &mode );
+  slot->blend = mode;
+  slot->blend_known = 1;
+
+  return mode;
+}
+
+void a_RenderStateForgetTexture( SDL_Texture* texture )
+{
+  aTextureModState_t* slot = TextureSlot( texture );
+
+  if ( slot->texture == texture )
+  {
+    *slot = (aTextureModState_t){ 0 };
+  }
+}
+
+static aTextureModState_t* TextureSlot( SDL_Texture* texture )
+{
+  uintptr_t key = (uintptr_t)texture;
+
+  // Heap pointers are at least 16 byte aligned; fold the upper bits in
+  key = ( key >> 4 ) ^ ( key >> 12 );
+
+  return &app.render_state.textures[key & ( RENDER_STATE_TEXTURE_SLOTS - 1 )];
+}
+
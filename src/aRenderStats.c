@@ -0,0 +1,88 @@
+/*
+ * aRenderStats.c:
+ *
+ * Per-frame renderer counters. Draw paths bump them through the
+ * RENDER_STATS_* macros, which expand to nothing unless the engine is
+ * built with -DARCHIMEDES_RENDER_STATS (make STATS=1), so release builds
+ * pay nothing.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdint.h>
+
+#include "Archimedes.h"
+
+static aRenderStats_t render_stats = { 0 };
+
+#if defined(ARCHIMEDES_RENDER_STATS)
+static aRenderStats_t render_stats_last = { 0 };
+static SDL_Texture* stats_texture = NULL;
+static uint32_t stats_applied = 0;
+static uint32_t stats_skipped = 0;
+#endif
+
+int a_RenderStatsGet( aRenderStats_t* stats )
+{
+#if defined(ARCHIMEDES_RENDER_STATS)
+  if ( stats != NULL )
+  {
+    *stats = render_stats_last;
+  }
+
+  return 0;
+#else
+  if ( stats != NULL )
+  {
+    *stats = (aRenderStats_t){ 0 };
+  }
+
+  return 1;
+#endif
+}
+
+void a_RenderStatsBegin( void )
+{
+#if defined(ARCHIMEDES_RENDER_STATS)
+  render_stats = (aRenderStats_t){ 0 };
+  stats_texture = NULL;
+
+  // State changes are already counted by the shadow state; keep a baseline
+  stats_applied = app.render_state.applied;
+  stats_skipped = app.render_state.skipped;
+#endif
+}
+
+void a_RenderStatsEnd( void )
+{
+#if defined(ARCHIMEDES_RENDER_STATS)
+  render_stats.state_changes = app.render_state.applied - stats_applied;
+  render_stats.state_skipped = app.render_state.skipped - stats_skipped;
+
+  render_stats_last = render_stats;
+#endif
+}
+
+aRenderStats_t* a_RenderStatsCounters( void )
+{
+  return &render_stats;
+}
+
+void a_RenderStatsDraw( SDL_Texture* texture, const int vertices )
+{
+#if defined(ARCHIMEDES_RENDER_STATS)
+  render_stats.draw_calls++;
+  render_stats.vertices += vertices;
+
+  if ( texture != NULL && texture != stats_texture )
+  {
+    render_stats.texture_binds++;
+    stats_texture = texture;
+  }
+#else
+  (void)texture;
+  (void)vertices;
+#endif
+}
+
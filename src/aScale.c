@@ -0,0 +1,366 @@
+/*
+ * aScale.c:
+ *
+ * Nearest-neighbour integer upscaling for 32-bit surfaces, used to
+ * pre-compose pixel art at app.options.scale_factor on the CPU. Each
+ * source row is widened once (AVX2 permutes for any factor up to 8,
+ * SSE2 shuffles for 2x/3x/4x, fills for anything larger) and then
+ * written to every destination row it covers.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Archimedes.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+#include <immintrin.h>
+#define SCALE_HAVE_AVX2 1
+#endif
+
+#define SCALE_MAX_PERMUTE 8
+
+static int have_avx2 = -1;
+
+static void ExpandRow( uint32_t* dst, const uint32_t* src, const int w, const int n );
+static int ScaleBlit( SDL_Surface* src, const SDL_Rect* src_rect, SDL_Surface* dest,
+                      const int x, const int y, const int scale, const int alpha_shift );
+
+static void ExpandRowScalar( uint32_t* dst, const uint32_t* src, const int w, const int n )
+{
+  for ( int i = 0; i < w; i++ )
+  {
+    const uint32_t p = src[i];
+    for ( int k = 0; k < n; k++ )
+    {
+      *dst++ = p;
+    }
+  }
+}
+
+#if defined(__SSE2__)
+static void ExpandRow2SSE2( uint32_t* dst, const uint32_t* src, const int w )
+{
+  int i = 0;
+
+  for ( ; i + 4 <= w; i += 4 )
+  {
+    __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 2 ),     _mm_unpacklo_epi32( v, v ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 2 + 4 ), _mm_unpackhi_epi32( v, v ) );
+  }
+
+  ExpandRowScalar( dst + i * 2, src + i, w - i, 2 );
+}
+
+static void ExpandRow3SSE2( uint32_t* dst, const uint32_t* src, const int w )
+{
+  int i = 0;
+
+  // 4 pixels in, 12 out: 0001 1122 2333
+  for ( ; i + 4 <= w; i += 4 )
+  {
+    __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 3 ),     _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 0, 0 ) ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 3 + 4 ), _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 2, 1, 1 ) ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 3 + 8 ), _mm_shuffle_epi32( v, _MM_SHUFFLE( 3, 3, 3, 2 ) ) );
+  }
+
+  ExpandRowScalar( dst + i * 3, src + i, w - i, 3 );
+}
+
+static void ExpandRow4SSE2( uint32_t* dst, const uint32_t* src, const int w )
+{
+  int i = 0;
+
+  for ( ; i + 4 <= w; i += 4 )
+  {
+    __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 4 ),      _mm_shuffle_epi32( v, 0x00 ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 4 + 4 ),  _mm_shuffle_epi32( v, 0x55 ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 4 + 8 ),  _mm_shuffle_epi32( v, 0xAA ) );
+    _mm_storeu_si128( (__m128i*)( dst + i * 4 + 12 ), _mm_shuffle_epi32( v, 0xFF ) );
+  }
+
+  ExpandRowScalar( dst + i * 4, src + i, w - i, 4 );
+}
+#endif
+
+#if defined(SCALE_HAVE_AVX2)
+/*
+ * 8 pixels in, 8 * n out. Output vector k, lane j repeats source pixel
+ * ( k * 8 + j ) / n, so n permutes cover any factor up to 8.
+ */
+__attribute__((target("avx2")))
+static void ExpandRowAVX2( uint32_t* dst, const uint32_t* src, const int w, const int n )
+{
+  __m256i index[SCALE_MAX_PERMUTE];
+  int i = 0;
+
+  for ( int k = 0; k < n; k++ )
+  {
+    int lanes[8];
+    for ( int j = 0; j < 8; j++ )
+    {
+      lanes[j] = ( k * 8 + j ) / n;
+    }
+    index[k] = _mm256_loadu_si256( (const __m256i*)lanes );
+  }
+
+  for ( ; i + 8 <= w; i += 8 )
+  {
+    __m256i v = _mm256_loadu_si256( (const __m256i*)( src + i ) );
+    uint32_t* out = dst + i * n;
+
+    for ( int k = 0; k < n; k++ )
+    {
+      _mm256_storeu_si256( (__m256i*)( out + k * 8 ), _mm256_permutevar8x32_epi32( v, index[k] ) );
+    }
+  }
+
+  ExpandRowScalar( dst + i * n, src + i, w - i, n );
+}
+#endif
+
+static void ExpandRow( uint32_t* dst, const uint32_t* src, const int w, const int n )
+{
+  if ( n == 1 )
+  {
+    a_PixelsCopy32( dst, src, w );
+    return;
+  }
+
+#if defined(SCALE_HAVE_AVX2)
+  if ( have_avx2 < 0 )
+  {
+    have_avx2 = SDL_HasAVX2() ? 1 : 0;
+  }
+
+  if ( have_avx2 && n <= SCALE_MAX_PERMUTE )
+  {
+    ExpandRowAVX2( dst, src, w, n );
+    return;
+  }
+#endif
+
+#if defined(__SSE2__)
+  switch ( n )
+  {
+    case 2: ExpandRow2SSE2( dst, src, w ); return;
+    case 3: ExpandRow3SSE2( dst, src, w ); return;
+    case 4: ExpandRow4SSE2( dst, src, w ); return;
+    default: break;
+  }
+#endif
+
+  // Wide factors: every source pixel is a vector-sized run already
+  if ( n >= SCALE_MAX_PERMUTE )
+  {
+    for ( int i = 0; i < w; i++ )
+    {
+      a_PixelsFill32( dst + i * n, n, src[i] );
+    }
+    return;
+  }
+
+  ExpandRowScalar( dst, src, w, n );
+}
+
+/*
+ * alpha_shift is where src keeps its alpha when blending, or -1 to copy.
+ * A destination without alpha of its own takes src in its layout with the
+ * alpha in the padding byte, and is blended on that directly.
+ */
+static int ScaleBlit( SDL_Surface* src, const SDL_Rect* src_rect, SDL_Surface* dest,
+                      const int x, const int y, const int scale, const int alpha_shift )
+{
+  SDL_Rect bounds = { 0, 0, src->w, src->h };
+  SDL_Rect sr = bounds;
+
+  if ( src_rect != NULL && !SDL_IntersectRect( src_rect, &bounds, &sr ) ) return 0;
+
+  // Only source pixels that land inside the destination clip get expanded
+  const SDL_Rect* clip = &dest->clip_rect;
+  int dx0 = MAX( x, clip->x );
+  int dy0 = MAX( y, clip->y );
+  int dx1 = MIN( x + sr.w * scale, clip->x + clip->w );
+  int dy1 = MIN( y + sr.h * scale, clip->y + clip->h );
+
+  if ( dx0 >= dx1 || dy0 >= dy1 ) return 0;
+
+  int sx0 = ( dx0 - x ) / scale;
+  int sx1 = ( dx1 - 1 - x ) / scale + 1;
+  int skip = ( dx0 - x ) - sx0 * scale;   // Expanded pixels left of the clip
+  int span = dx1 - dx0;
+
+  uint32_t* row = malloc( sizeof( uint32_t ) * (size_t)( sx1 - sx0 ) * scale );
+  if ( row == NULL )
+  {
+    LOG( "Failed to allocate scale row" );
+    return 1;
+  }
+
+  if ( SDL_MUSTLOCK( src ) && SDL_LockSurface( src ) != 0 )
+  {
+    free( row );
+    return 1;
+  }
+
+  aPixels_t px;
+  if ( a_PixelsBegin( &px, dest ) != 0 )
+  {
+    if ( SDL_MUSTLOCK( src ) ) SDL_UnlockSurface( src );
+    free( row );
+    return 1;
+  }
+
+  int dy = dy0;
+  while ( dy < dy1 )
+  {
+    int sy = ( dy - y ) / scale;
+    int row_end = MIN( y + ( sy + 1 ) * scale, dy1 );
+    const uint32_t* src_row = (const uint32_t*)( (const uint8_t*)src->pixels
+                              + (size_t)( sr.y + sy ) * src->pitch ) + sr.x + sx0;
+
+    ExpandRow( row, src_row, sx1 - sx0, scale );
+
+    // Row duplication: the widened row is reused for every copy of it
+    for ( ; dy < row_end; dy++ )
+    {
+      if ( alpha_shift < 0 )
+      {
+        a_PixelsCopySpan( &px, dx0, dy, row + skip, span );
+      }
+      else if ( dest->format->Amask == 0 )
+      {
+        uint32_t* dest_row = (uint32_t*)( px.pixels + (size_t)dy * px.pitch ) + dx0;
+        a_PixelsBlend32( dest_row, row + skip, span, alpha_shift );
+      }
+      else
+      {
+        a_PixelsBlendSpan( &px, dx0, dy, row + skip, span );
+      }
+    }
+  }
+
+  a_PixelsEnd( &px );
+
+  if ( SDL_MUSTLOCK( src ) ) SDL_UnlockSurface( src );
+  free( row );
+
+  return 0;
+}
+
+int a_BlitSurfaceScaled( SDL_Surface* src, const SDL_Rect* src_rect, SDL_Surface* dest,
+                         const int x, const int y, const int scale )
+{
+  if ( src == NULL || dest == NULL ) return 1;
+
+  if ( dest->format->BytesPerPixel != 4 )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Scaled blit needs a 32-bit destination, got %s",
+             log_level_strings[new_error.error_type], SDL_GetPixelFormatName( dest->format->format ) );
+    LOG( new_error.error_msg );
+    return 1;
+  }
+
+  // Match SDL_BlitSurface: alpha-blended sources are composited src-over
+  SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+  SDL_GetSurfaceBlendMode( src, &mode );
+  int blend = ( mode == SDL_BLENDMODE_BLEND && src->format->Amask != 0 );
+
+  const SDL_PixelFormat* df = dest->format;
+  uint32_t format = df->format;
+  if ( blend && df->Amask == 0 )
+  {
+    // Converting to dest's format would drop the alpha; keep it in the padding byte
+    format = SDL_MasksToPixelFormatEnum( 32, df->Rmask, df->Gmask, df->Bmask,
+                                         ~( df->Rmask | df->Gmask | df->Bmask ) );
+    if ( format == SDL_PIXELFORMAT_UNKNOWN )
+    {
+      format = df->format;
+      blend = 0;
+    }
+  }
+
+  SDL_Surface* converted = src;
+  if ( src->format->format != format )
+  {
+    converted = SDL_ConvertSurfaceFormat( src, format, 0 );
+    if ( converted == NULL )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to convert surface for scaled blit: %s",
+               log_level_strings[new_error.error_type], SDL_GetError() );
+      LOG( new_error.error_msg );
+      return 1;
+    }
+  }
+
+  int status = ScaleBlit( converted, src_rect, dest, x, y, MAX( scale, 1 ),
+                          blend ? converted->format->Ashift : -1 );
+
+  if ( converted != src )
+  {
+    SDL_FreeSurface( converted );
+  }
+
+  return status;
+}
+
+SDL_Surface* a_SurfaceScale( SDL_Surface* src, const int scale )
+{
+  if ( src == NULL || scale < 1 ) return NULL;
+
+  uint32_t format = src->format->BytesPerPixel == 4 ? src->format->format : SDL_PIXELFORMAT_ARGB8888;
+
+  SDL_Surface* out = SDL_CreateRGBSurfaceWithFormat( 0, src->w * scale, src->h * scale, 32, format );
+  if ( out == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to create %dx scaled surface: %s",
+             log_level_strings[new_error.error_type], scale, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return NULL;
+  }
+
+  SDL_Surface* converted = src;
+  if ( src->format->format != format )
+  {
+    converted = SDL_ConvertSurfaceFormat( src, format, 0 );
+    if ( converted == NULL )
+    {
+      SDL_FreeSurface( out );
+      return NULL;
+    }
+  }
+
+  // A straight copy: the new surface starts out as an exact scaled image
+  int status = ScaleBlit( converted, NULL, out, 0, 0, scale, -1 );
+
+  if ( converted != src )
+  {
+    SDL_FreeSurface( converted );
+  }
+
+  if ( status != 0 )
+  {
+    SDL_FreeSurface( out );
+    return NULL;
+  }
+
+  return out;
+}
+
@@ -0,0 +1,296 @@
+/*
+ * aSpriteBatch.c:
+ *
+ * Deferred textured quads. Sprites submitted between a_SpriteBatchBegin()
+ * and a_SpriteBatchEnd() are sorted by layer, then grouped by texture, and
+ * every run of sprites sharing a texture goes out as one SDL_RenderGeometry
+ * call.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "Archimedes.h"
+
+#define SPRITE_BATCH_INITIAL_SIZE 1024
+#define SPRITE_BATCH_MAX_TEXTURES 256
+
+typedef struct
+{
+  SDL_Texture* texture;
+  int w;
+  int h;
+} aBatchTexture_t;
+
+typedef struct
+{
+  aRectf_t src;
+  aRectf_t dest;
+  aColor_t color;
+  float angle;
+  int flip;
+  int layer;
+  int texture;      // Index into batch_textures, in first-seen order
+  int seq;          // Submission order, keeps the sort stable
+} aBatchSprite_t;
+
+static aBatchSprite_t* sprites = NULL;
+static int sprite_count = 0;
+static int sprite_max = 0;
+
+static aBatchTexture_t batch_textures[SPRITE_BATCH_MAX_TEXTURES];
+static int batch_texture_count = 0;
+
+static SDL_Vertex* vertices = NULL;
+static int* indices = NULL;
+static int vertex_max = 0;
+
+static int batch_active = 0;
+
+static int BatchTextureIndex( const aImage_t* img );
+static int SpriteCompare( const void* a, const void* b );
+static int SpriteBatchGrow( void );
+static void SpriteBatchEmit( void );
+
+void a_SpriteBatchBegin( void )
+{
+  sprite_count = 0;
+  batch_texture_count = 0;
+  batch_active = 1;
+}
+
+void a_SpriteBatchSubmit( aImage_t* img, const aRectf_t* src, const aRectf_t* dest,
+                          const aColor_t color, const float angle,
+                          const SDL_RendererFlip flip, const int layer )
+{
+  if ( img == NULL || img->texture == NULL || img->w <= 0 || img->h <= 0 ) return;
+
+  if ( !batch_active )
+  {
+    LOG( "a_SpriteBatchSubmit called outside a_SpriteBatchBegin/End" );
+    return;
+  }
+
+  IMAGE_TOUCH( img );
+
+  int texture = BatchTextureIndex( img );
+  if ( texture < 0 )
+  {
+    // Texture table is full: draw what we have and start a new batch
+    a_SpriteBatchEnd();
+    a_SpriteBatchBegin();
+    texture = BatchTextureIndex( img );
+  }
+
+  if ( sprite_count == sprite_max && SpriteBatchGrow() )
+  {
+    return;
+  }
+
+  aBatchSprite_t* s = &sprites[sprite_count];
+
+  s->src  = a_ImageSourceRect( img, src );
+  s->dest = dest ? *dest : (aRectf_t){ 0, 0, s->src.w, s->src.h };
+  RENDER_STATS_ADD( pixels_filled, (uint64_t)( s->dest.w * s->dest.h ) );
+  s->color   = color;
+  s->angle   = angle;
+  s->flip    = flip;
+  s->layer   = layer;
+  s->texture = texture;
+  s->seq     = sprite_count;
+
+  sprite_count++;
+}
+
+void a_SpriteBatchEnd( void )
+{
+  if ( !batch_active ) return;
+
+  batch_active = 0;
+
+  if ( sprite_count == 0 ) return;
+
+  // Primitives queued before the batch must land underneath it
+  a_DrawFlush();
+
+  qsort( sprites, sprite_count, sizeof( aBatchSprite_t ), SpriteCompare );
+
+  SpriteBatchEmit();
+
+  sprite_count = 0;
+}
+
+void a_SpriteBatchCleanUp( void )
+{
+  free( sprites );
+  free( vertices );
+  free( indices );
+
+  sprites = NULL;
+  vertices = NULL;
+  indices = NULL;
+  sprite_count = sprite_max = vertex_max = 0;
+  batch_active = 0;
+}
+
+void a_SpriteBatchQuad( SDL_Vertex* v, const aRectf_t src, const int tex_w, const int tex_h,
+                        const aRectf_t dest, const aColor_t color, const float angle,
+                        const int flip )
+{
+  float u0 = src.x / tex_w;
+  float v0 = src.y / tex_h;
+  float u1 = ( src.x + src.w ) / tex_w;
+  float v1 = ( src.y + src.h ) / tex_h;
+
+  if ( flip & SDL_FLIP_HORIZONTAL )
+  {
+    float t = u0; u0 = u1; u1 = t;
+  }
+  if ( flip & SDL_FLIP_VERTICAL )
+  {
+    float t = v0; v0 = v1; v1 = t;
+  }
+
+  // Corners relative to the dest center, matching SDL_RenderCopyEx's pivot
+  float hw = dest.w * 0.5f;
+  float hh = dest.h * 0.5f;
+  float cx = dest.x + hw;
+  float cy = dest.y + hh;
+  const float corner_x[4] = { -hw,  hw, hw, -hw };
+  const float corner_y[4] = { -hh, -hh, hh,  hh };
+  const float corner_u[4] = { u0, u1, u1, u0 };
+  const float corner_v[4] = { v0, v0, v1, v1 };
+
+  float cs = 1.0f;
+  float sn = 0.0f;
+  if ( angle != 0.0f )
+  {
+    float rad = angle * (float)M_PI / 180.0f;
+    cs = cosf( rad );
+    sn = sinf( rad );
+  }
+
+  SDL_Color c = { color.r, color.g, color.b, color.a };
+
+  for ( int k = 0; k < 4; k++ )
+  {
+    v[k].position.x  = cx + corner_x[k] * cs - corner_y[k] * sn;
+    v[k].position.y  = cy + corner_x[k] * sn + corner_y[k] * cs;
+    v[k].color       = c;
+    v[k].tex_coord.x = corner_u[k];
+    v[k].tex_coord.y = corner_v[k];
+  }
+}
+
+void a_SpriteBatchQuadIndices( int* indices, const int first, const int last )
+{
+  for ( int i = first; i < last; i++ )
+  {
+    int* idx = &indices[i * 6];
+    idx[0] = i * 4;
+    idx[1] = i * 4 + 1;
+    idx[2] = i * 4 + 2;
+    idx[3] = i * 4;
+    idx[4] = i * 4 + 2;
+    idx[5] = i * 4 + 3;
+  }
+}
+
+static int BatchTextureIndex( const aImage_t* img )
+{
+  SDL_Texture* texture = img->texture;
+
+  // Batches rarely touch more than a handful of textures; a scan is cheapest
+  for ( int i = batch_texture_count - 1; i >= 0; i-- )
+  {
+    if ( batch_textures[i].texture == texture ) return i;
+  }
+
+  if ( batch_texture_count == SPRITE_BATCH_MAX_TEXTURES ) return -1;
+
+  aBatchTexture_t* bt = &batch_textures[batch_texture_count];
+  bt->texture = texture;
+  bt->w = img->w;
+  bt->h = img->h;
+
+  return batch_texture_count++;
+}
+
+static int SpriteCompare( const void* a, const void* b )
+{
+  const aBatchSprite_t* sa = a;
+  const aBatchSprite_t* sb = b;
+
+  if ( sa->layer != sb->layer )     return ( sa->layer < sb->layer ) ? -1 : 1;
+  if ( sa->texture != sb->texture ) return ( sa->texture < sb->texture ) ? -1 : 1;
+
+  return ( sa->seq < sb->seq ) ? -1 : ( sa->seq > sb->seq );
+}
+
+static int SpriteBatchGrow( void )
+{
+  int new_max = sprite_max ? sprite_max * 2 : SPRITE_BATCH_INITIAL_SIZE;
+
+  aBatchSprite_t* new_sprites = realloc( sprites, sizeof( aBatchSprite_t ) * new_max );
+  if ( new_sprites == NULL )
+  {
+    LOG( "Failed to grow the sprite batch" );
+    return 1;
+  }
+  sprites = new_sprites;
+
+  SDL_Vertex* new_vertices = realloc( vertices, sizeof( SDL_Vertex ) * new_max * 4 );
+  if ( new_vertices == NULL )
+  {
+    LOG( "Failed to grow the sprite batch vertices" );
+    return 1;
+  }
+  vertices = new_vertices;
+
+  int* new_indices = realloc( indices, sizeof( int ) * new_max * 6 );
+  if ( new_indices == NULL )
+  {
+    LOG( "Failed to grow the sprite batch indices" );
+    return 1;
+  }
+  indices = new_indices;
+
+  // Index pattern only depends on the position within a run, so build it once
+  a_SpriteBatchQuadIndices( indices, vertex_max / 4, new_max );
+
+  vertex_max = new_max * 4;
+  sprite_max = new_max;
+
+  return 0;
+}
+
+static void SpriteBatchEmit( void )
+{
+  int run_start = 0;
+
+  for ( int i = 0; i < sprite_count; i++ )
+  {
+    const aBatchSprite_t* s = &sprites[i];
+    const aBatchTexture_t* bt = &batch_textures[s->texture];
+
+    a_SpriteBatchQuad( &vertices[i * 4], s->src, bt->w, bt->h, s->dest,
+                       s->color, s->angle, s->flip );
+
+    // Neighbouring layers that happen to share a texture still go out together
+    int last = ( i + 1 == sprite_count );
+    if ( last || sprites[i + 1].texture != s->texture )
+    {
+      int run_count = i + 1 - run_start;
+
+      SDL_RenderGeometry( app.renderer, bt->texture, &vertices[run_start * 4], run_count * 4,
+                          indices, run_count * 6 );
+      RENDER_STATS_DRAW( bt->texture, run_count * 4 );
+
+      run_start = i + 1;
+    }
+  }
+}
+
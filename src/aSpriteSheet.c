@@ -0,0 +1,282 @@
+/*
+ * aSpriteSheet.c:
+ *
+ * Sprite sheets described in .auf files. The descriptor is parsed once
+ * into a frame table of trimmed rects with their pivot already folded
+ * into a draw offset, and every animation's frames are copied back to
+ * back into one sequence array. Animations made from the sheet point
+ * straight into that array, so nothing is looked up or worked out while
+ * they play.
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Archimedes.h"
+
+#define SPRITE_SHEET_FRAME_VALUES 8   // x, y, w, h, pivot x, y, trim x, y
+#define SPRITE_SHEET_DEFAULT_MS   100
+
+static int SpriteSheetParseFrames( aSpriteSheet_t* sheet, aAUFNode_t* section );
+static int SpriteSheetParseAnims( aSpriteSheet_t* sheet, aAUF_t* root );
+static float SpriteSheetNumber( const aAUFNode_t* node );
+
+aSpriteSheet_t* a_SpriteSheetLoad( const char* filename )
+{
+  if ( filename == NULL ) return NULL;
+
+  aAUF_t* root = a_AUFParser( filename );
+  if ( root == NULL ) return NULL;
+
+  aSpriteSheet_t* sheet = calloc( 1, sizeof( aSpriteSheet_t ) );
+  if ( sheet == NULL )
+  {
+    LOG( "Failed to allocate memory for sprite sheet" );
+    if ( root->head != NULL ) a_AUFFree( root );
+    free( root );
+    return NULL;
+  }
+
+  aAUFNode_t* section = root->head;
+  while ( section != NULL && ( section->string == NULL || strcmp( section->string, "SHEET" ) != 0 ) )
+  {
+    section = section->next;
+  }
+
+  aAUFNode_t* image = section ? a_AUFGetObjectItem( section, "image" ) : NULL;
+
+  int status = 1;
+  if ( image == NULL || image->value_string == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: %s has no [SHEET.name] section with an image",
+             log_level_strings[new_error.error_type], filename );
+    LOG( new_error.error_msg );
+  }
+  else
+  {
+    sheet->image = a_ImageLoad( image->value_string );
+    if ( sheet->image != NULL &&
+         SpriteSheetParseFrames( sheet, section ) == 0 &&
+         SpriteSheetParseAnims( sheet, root ) == 0 )
+    {
+      status = 0;
+    }
+  }
+
+  if ( root->head != NULL ) a_AUFFree( root );
+  free( root );
+
+  if ( status != 0 )
+  {
+    a_SpriteSheetFree( sheet );
+    return NULL;
+  }
+
+  return sheet;
+}
+
+void a_SpriteSheetFree( aSpriteSheet_t* sheet )
+{
+  if ( sheet == NULL ) return;
+
+  for ( int i = 0; i < sheet->frame_count; i++ )
+  {
+    free( sheet->frame_names[i] );
+  }
+
+  for ( int i = 0; i < sheet->anim_count; i++ )
+  {
+    free( sheet->anims[i].name );
+  }
+
+  a_ImageRelease( sheet->image );
+  free( sheet->frame_names );
+  free( sheet->frames );
+  free( sheet->sequence );
+  free( sheet->anims );
+  free( sheet );
+}
+
+int a_SpriteSheetFindFrame( const aSpriteSheet_t* sheet, const char* name )
+{
+  if ( sheet == NULL || name == NULL ) return -1;
+
+  for ( int i = 0; i < sheet->frame_count; i++ )
+  {
+    if ( strcmp( sheet->frame_names[i], name ) == 0 ) return i;
+  }
+
+  return -1;
+}
+
+void a_SpriteSheetBlit( const aSpriteSheet_t* sheet, const int frame,
+                        const aPoint2f_t pos, const float scale )
+{
+  if ( sheet == NULL || frame < 0 || frame >= sheet->frame_count ) return;
+
+  const aSpriteFrame_t* f = &sheet->frames[frame];
+  aRectf_t src = f->rect;
+  aRectf_t dest = { pos.x + f->offset.x * scale, pos.y + f->offset.y * scale,
+                    f->rect.w, f->rect.h };
+
+  a_BlitRect( sheet->image, &src, &dest, scale );
+}
+
+/*
+ * Every key in the SHEET section other than image is a frame:
+ * name:[x,y,w,h] with an optional pivot and trim offset after it.
+ */
+static int SpriteSheetParseFrames( aSpriteSheet_t* sheet, aAUFNode_t* section )
+{
+  int count = 0;
+  for ( aAUFNode_t* node = section->child; node != NULL; node = node->next )
+  {
+    if ( node->child != NULL ) count++;
+  }
+
+  if ( count == 0 ) return 0;
+
+  sheet->frames = malloc( sizeof( aSpriteFrame_t ) * count );
+  sheet->frame_names = malloc( sizeof( char* ) * count );
+  if ( sheet->frames == NULL || sheet->frame_names == NULL )
+  {
+    LOG( "Failed to allocate memory for sprite sheet frames" );
+    return 1;
+  }
+
+  for ( aAUFNode_t* node = section->child; node != NULL; node = node->next )
+  {
+    if ( node->child == NULL || node->string == NULL ) continue;
+
+    float v[SPRITE_SHEET_FRAME_VALUES] = { 0 };
+    int n = 0;
+    for ( aAUFNode_t* value = node->child; value != NULL && n < SPRITE_SHEET_FRAME_VALUES;
+          value = value->next )
+    {
+      v[n++] = SpriteSheetNumber( value );
+    }
+
+    if ( n < 4 || v[2] <= 0 || v[3] <= 0 )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Sprite frame %s needs [x,y,w,h], skipping it",
+               log_level_strings[new_error.error_type], node->string );
+      LOG( new_error.error_msg );
+      continue;
+    }
+
+    // The blit clips to the image rather than wrapping into its neighbours
+    if ( v[0] < 0 || v[1] < 0 ||
+         v[0] + v[2] > sheet->image->rect.w || v[1] + v[3] > sheet->image->rect.h )
+    {
+      aError_t new_error;
+      new_error.error_type = WARNING;
+      snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Sprite frame %s runs off %s",
+               log_level_strings[new_error.error_type], node->string, sheet->image->filename );
+      LOG( new_error.error_msg );
+    }
+
+    char* name = strdup( node->string );
+    if ( name == NULL ) return 1;
+
+    // Pivot and trim are both in untrimmed frame space; only their
+    // difference matters once the frame is drawn
+    sheet->frames[sheet->frame_count] = (aSpriteFrame_t){
+      .rect = { v[0], v[1], v[2], v[3] },
+      .offset = { v[6] - v[4], v[7] - v[5] }
+    };
+    sheet->frame_names[sheet->frame_count] = name;
+    sheet->frame_count++;
+  }
+
+  return 0;
+}
+
+static int SpriteSheetParseAnims( aSpriteSheet_t* sheet, aAUF_t* root )
+{
+  int anims = 0;
+  int frames = 0;
+
+  for ( aAUFNode_t* section = root->head; section != NULL; section = section->next )
+  {
+    if ( section->string == NULL || strcmp( section->string, "ANIM" ) != 0 ) continue;
+
+    anims++;
+
+    aAUFNode_t* list = a_AUFGetObjectItem( section, "frames" );
+    if ( list != NULL ) frames += list->value_int;
+  }
+
+  if ( anims == 0 ) return 0;
+
+  sheet->anims = calloc( anims, sizeof( aSpriteSheetAnim_t ) );
+  sheet->sequence = malloc( sizeof( aSpriteFrame_t ) * ( frames > 0 ? frames : 1 ) );
+  if ( sheet->anims == NULL || sheet->sequence == NULL )
+  {
+    LOG( "Failed to allocate memory for sprite sheet animations" );
+    return 1;
+  }
+
+  for ( aAUFNode_t* section = root->head; section != NULL; section = section->next )
+  {
+    if ( section->string == NULL || strcmp( section->string, "ANIM" ) != 0 ) continue;
+
+    aSpriteSheetAnim_t* anim = &sheet->anims[sheet->anim_count];
+    anim->name = strdup( section->value_string ? section->value_string : "" );
+    if ( anim->name == NULL ) return 1;
+
+    anim->first = sheet->sequence_count;
+    anim->frame_duration = SPRITE_SHEET_DEFAULT_MS;
+    anim->loop = 1;
+    sheet->anim_count++;
+
+    aAUFNode_t* list = a_AUFGetObjectItem( section, "frames" );
+    for ( aAUFNode_t* item = list ? list->child : NULL;
+          item != NULL && sheet->sequence_count < frames; item = item->next )
+    {
+      int index = a_SpriteSheetFindFrame( sheet, item->value_string );
+      if ( index < 0 )
+      {
+        aError_t new_error;
+        new_error.error_type = WARNING;
+        snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Animation %s uses unknown frame %s",
+                 log_level_strings[new_error.error_type], anim->name,
+                 item->value_string ? item->value_string : "(null)" );
+        LOG( new_error.error_msg );
+        continue;
+      }
+
+      // Copied rather than indexed so a playing animation reads one array
+      sheet->sequence[sheet->sequence_count++] = sheet->frames[index];
+    }
+
+    anim->frame_count = sheet->sequence_count - anim->first;
+
+    aAUFNode_t* duration = a_AUFGetObjectItem( section, "duration" );
+    if ( duration != NULL && SpriteSheetNumber( duration ) > 0 )
+    {
+      anim->frame_duration = (uint32_t)SpriteSheetNumber( duration );
+    }
+
+    aAUFNode_t* loop = a_AUFGetObjectItem( section, "loop" );
+    if ( loop != NULL )
+    {
+      anim->loop = loop->value_int != 0;
+    }
+  }
+
+  return 0;
+}
+
+// The parser keeps a number as a double only when it was written with a '.'
+static float SpriteSheetNumber( const aAUFNode_t* node )
+{
+  return node->value_double != 0.0 ? (float)node->value_double : (float)node->value_int;
+}
@@ -8,6 +8,7 @@
  */
 
 #include <SDL2/SDL_image.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +21,10 @@ static void initFont( const char* filename, const int font_type,
 static void initFontPNG( const char* filename, const int font_type,
                          const int glyph_width, const int glyph_height );
 
+static void BuildFont( TTF_Font* font, const int font_type );
+static void BuildFontPNG( SDL_Surface* font_surf, const int font_type );
+static void FontHotReload( const char* path, void* user );
+
 static int DrawTextWrapped( const char* text, const int x, const int y,
                             const aColor_t fg, const int font_type,
                             const int align, const int max_width,
@@ -40,6 +45,14 @@ static int is_valid_utf8_sequence( const char* text, const int start_pos, int* s
 static uint8_t warned_about[FONT_MAX][MAX_GLYPHS];
 
 static SDL_Color white_ = {255, 255, 255, 255};
+
+// What each font was built from, so a hot reload can build it again
+static struct
+{
+  int font_size;
+  int glyph_width;    // Non-zero for PNG fonts
+  int glyph_height;
+} font_sources[FONT_MAX];
 //static TTF_Font* fonts[FONT_MAX];
 //static SDL_Rect glyphs[FONT_MAX][MAX_GLYPHS];
 //static SDL_Texture* font_textures[FONT_MAX];
@@ -241,29 +254,43 @@ void a_DrawText( const char* content, int x, int y, aTextStyle_t style )
 static void initFontPNG( const char* filename, const int font_type,
                          const int glyph_width, const int glyph_height )
 {
-  SDL_Surface* surface, *font_surf;
-  SDL_Rect dest, rect;
-  int i;
+  SDL_Surface* font_surf;
 
-  memset( &app.glyphs[font_type], 0, sizeof( SDL_Rect ) * MAX_GLYPHS );
-  memset( app.glyph_exists[font_type], 0, sizeof( app.glyph_exists[font_type] ) );
-  app.fallback_glyph[font_type] = '-' - 1;  // PNG fonts use ASCII-1 indexing
-
-  font_surf = IMG_Load( filename );
+  font_surf = a_ImageDecode( filename );
   if( font_surf == NULL )
   {
     printf( "Failed to open font surface %s, %s", filename, SDL_GetError() );
     exit(1);
   }
 
+  font_sources[font_type].font_size = 0;
+  font_sources[font_type].glyph_width = glyph_width;
+  font_sources[font_type].glyph_height = glyph_height;
+
+  BuildFontPNG( font_surf, font_type );
+  SDL_FreeSurface( font_surf );
+
+  a_HotReloadWatch( filename, FontHotReload, (void*)(intptr_t)font_type );
+}
+
+static void BuildFontPNG( SDL_Surface* font_surf, const int font_type )
+{
+  SDL_Surface* surface;
+  SDL_Rect dest, rect;
+  int i;
+
+  memset( &app.glyphs[font_type], 0, sizeof( SDL_Rect ) * MAX_GLYPHS );
+  memset( app.glyph_exists[font_type], 0, sizeof( app.glyph_exists[font_type] ) );
+  app.fallback_glyph[font_type] = '-' - 1;  // PNG fonts use ASCII-1 indexing
+
   surface = SDL_CreateRGBSurface( 0, FONT_TEXTURE_SIZE, FONT_TEXTURE_SIZE, 32, 0, 0, 0, 0xff );
 
   SDL_SetColorKey( surface, SDL_TRUE, SDL_MapRGBA( surface->format, 0, 0, 0, 0 ) );
 
   dest.x = dest.y = 0;
   rect.x = rect.y = 0;
-  rect.w = dest.w = glyph_width;
-  rect.h = dest.h = glyph_height;
+  rect.w = dest.w = font_sources[font_type].glyph_width;
+  rect.h = dest.h = font_sources[font_type].glyph_height;
   i = 0;
 
   while ( rect.x < font_surf->w )
@@ -294,6 +321,24 @@ static void initFontPNG( const char* filename, const int font_type,
 }
 
 static void initFont( const char* filename, const int font_type, const int font_size )
+{
+  TTF_Font* font = TTF_OpenFont( filename, font_size );
+  if( font == NULL )
+  {
+    printf( "Failed to open font %s, %s", filename, TTF_GetError() );
+    exit(1);
+  }
+
+  font_sources[font_type].font_size = font_size;
+  font_sources[font_type].glyph_width = 0;
+  font_sources[font_type].glyph_height = 0;
+
+  BuildFont( font, font_type );
+
+  a_HotReloadWatch( filename, FontHotReload, (void*)(intptr_t)font_type );
+}
+
+static void BuildFont( TTF_Font* font, const int font_type )
 {
   SDL_Surface* surface, *text;
   SDL_Rect dest;
@@ -304,12 +349,7 @@ static void initFont( const char* filename, const int font_type, const int font_
   memset( app.glyph_exists[font_type], 0, sizeof( app.glyph_exists[font_type] ) );
   app.fallback_glyph[font_type] = '-';  // Default fallback, will be validated
 
-  app.fonts[font_type] = TTF_OpenFont( filename, font_size );
-  if( app.fonts[font_type] == NULL )
-  {
-    printf( "Failed to open font %s, %s", filename, TTF_GetError() );
-    exit(1);
-  }
+  app.fonts[font_type] = font;
 
   surface = SDL_CreateRGBSurface( 0, FONT_TEXTURE_SIZE, FONT_TEXTURE_SIZE, 32, 0, 0, 0, 0xff );
 
@@ -362,6 +402,53 @@ static void initFont( const char* filename, const int font_type, const int font_
   SDL_FreeSurface( surface );
 }
 
+/*
+ * Opens the changed file before touching anything, so a font that fails
+ * to load mid-save leaves the current glyphs up instead of calling exit().
+ */
+static void FontHotReload( const char* path, void* user )
+{
+  const int font_type = (int)(intptr_t)user;
+  TTF_Font* font = NULL;
+  SDL_Surface* font_surf = NULL;
+
+  if ( font_sources[font_type].glyph_width > 0 )
+  {
+    // Straight from disk; a mounted pack still holds the old pixels
+    font_surf = IMG_Load( path );
+  }
+  else
+  {
+    font = TTF_OpenFont( path, font_sources[font_type].font_size );
+  }
+
+  if ( font == NULL && font_surf == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: Failed to reload font %s, %s",
+             log_level_strings[new_error.error_type], path, SDL_GetError() );
+    LOG( new_error.error_msg );
+    return;
+  }
+
+  a_RenderStateForgetTexture( app.font_textures[font_type] );
+  SDL_DestroyTexture( app.font_textures[font_type] );
+  app.font_textures[font_type] = NULL;
+  memset( warned_about[font_type], 0, sizeof( warned_about[font_type] ) );
+
+  if ( font_surf != NULL )
+  {
+    BuildFontPNG( font_surf, font_type );
+    SDL_FreeSurface( font_surf );
+  }
+  else
+  {
+    if ( app.fonts[font_type] != NULL ) TTF_CloseFont( app.fonts[font_type] );
+    BuildFont( font, font_type );
+  }
+}
+
 static int DrawTextWrapped( const char* text, const int x, const int y,
                             const aColor_t fg, const int font_type,
                             const int align, const int max_width,
@@ -476,7 +563,9 @@ static void DrawTextLine( const char* text, const int x, const int y,
     }
   }
 
-  SDL_SetTextureColorMod( app.font_textures[font_type], fg.r, fg.g, fg.b );
+  a_DrawFlush();
+
+  a_RenderStateSetTextureColorMod( app.font_textures[font_type], fg.r, fg.g, fg.b );
 
   i = 0;
   len = strlen( text );
@@ -494,6 +583,9 @@ static void DrawTextLine( const char* text, const int x, const int y,
       dest.h = glyph->h * app.font_scale;
 
       SDL_RenderCopy( app.renderer, app.font_textures[font_type], glyph, &dest );
+      RENDER_STATS_DRAW( app.font_textures[font_type], 4 );
+      RENDER_STATS_ADD( glyphs, 1 );
+      RENDER_STATS_ADD( pixels_filled, (uint64_t)dest.w * dest.h );
 
       new_x += glyph->w * app.font_scale;
 
@@ -513,6 +605,9 @@ static void DrawTextLine( const char* text, const int x, const int y,
       dest.h = glyph->h * app.font_scale;
 
       SDL_RenderCopy( app.renderer, app.font_textures[font_type], glyph, &dest );
+      RENDER_STATS_DRAW( app.font_textures[font_type], 4 );
+      RENDER_STATS_ADD( glyphs, 1 );
+      RENDER_STATS_ADD( pixels_filled, (uint64_t)dest.w * dest.h );
 
       new_x += glyph->w * app.font_scale;
 
@@ -532,6 +627,9 @@ static void DrawTextLine( const char* text, const int x, const int y,
       dest.h = glyph->h * app.font_scale;
 
       SDL_RenderCopy( app.renderer, app.font_textures[font_type], glyph, &dest );
+      RENDER_STATS_DRAW( app.font_textures[font_type], 4 );
+      RENDER_STATS_ADD( glyphs, 1 );
+      RENDER_STATS_ADD( pixels_filled, (uint64_t)dest.w * dest.h );
 
       new_x += glyph->w * app.font_scale;
     }
@@ -78,6 +78,9 @@ char* a_ParseString( char delimiter, char* str, int str_len )
 
   for ( int i = 0; i < str_len; i++ )
   {
+    // Callers pass the line's length from an offset into it; stop at its end
+    if ( str[i] == '\0' ) break;
+
     if ( str[i] != delimiter )
     {
       return_str[i] = str[i];
@@ -91,6 +94,7 @@ char* a_ParseString( char delimiter, char* str, int str_len )
     }
   }
 
+  free( return_str );
   return NULL;
 }
 
@@ -105,6 +109,9 @@ char* a_ParseStringDoubleDelim( char delimiter1, char delimiter2, char* str, int
 
   for ( int i = 0; i < str_len; i++ )
   {
+    // Callers pass the line's length from an offset into it; stop at its end
+    if ( str[i] == '\0' ) break;
+
     if ( str[i] != delimiter1 && str[i] != delimiter2 )
     {
       return_str[i] = str[i];
@@ -118,6 +125,7 @@ char* a_ParseStringDoubleDelim( char delimiter1, char delimiter2, char* str, int
     }
   }
 
+  free( return_str );
   return NULL;
 }
 
@@ -53,12 +53,8 @@ void a_ViewportDrawPoint( aPoint3f_t p, aColor_t color )
   int x = (int)( ( p.x - viewport_x1 ) * current_scale.x );
   int y = (int)( ( p.y - viewport_y1 ) * current_scale.y );
 
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor(app.renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderDrawPoint(app.renderer, x, y);
-  // Reset the renderer color to white
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+  RENDER_STATS_ADD( viewport_draws, 1 );
+  a_DrawPoint( x, y, color );
 }
 
 void a_ViewportDrawRect( aRectf_t rect, aColor_t color )
@@ -74,18 +70,14 @@ void a_ViewportDrawRect( aRectf_t rect, aColor_t color )
   float world_width  = rect.w * 2.0f;
   float world_height = rect.h * 2.0f;
 
-  SDL_Rect r = {
+  aRectf_t r = {
     (int)( ( world_x1 - viewport_x1 ) * current_scale.x ),
     (int)( ( world_y1 - viewport_y1 ) * current_scale.y ),
     (int)( world_width  * current_scale.x ),
     (int)( world_height * current_scale.y )
   };
-  
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_BLEND );
-  SDL_SetRenderDrawColor( app.renderer, color.r, color.g, color.b, color.a );
- 
-  SDL_RenderDrawRect( app.renderer, &r );
-  SDL_SetRenderDrawColor(app.renderer, 255, 255, 255, 255);
-  SDL_SetRenderDrawBlendMode( app.renderer, SDL_BLENDMODE_NONE );
+
+  RENDER_STATS_ADD( viewport_draws, 1 );
+  a_DrawRect( r, color );
 }
 
@@ -37,11 +37,15 @@ static aWidget_t* GetCurrentWidget( void );
 static int WithinRange( int x, int y, aRectf_t rect );
 static void ClearWidgetsState( void );
 static void ContainerWidgetFree( aContainerWidget_t* con );
+static void WidgetReleaseImages( aWidget_t* w );
+static aWidget_t* WidgetFind( aWidget_t* head, const char* name );
+static void WidgetsHotReload( const char* path, void* user );
 
 static void WidgetColor( aWidget_t* w, aColor_t* c );
 
 static aWidget_t widget_head;
 static aWidget_t* widget_tail = NULL;
+static char widget_file[MAX_FILENAME_LENGTH];
 
 static double slider_delay;
 static double cursor_blink;
@@ -201,6 +205,8 @@ void a_DrawWidgets( void )
   aWidget_t* w;
   for ( w = widget_head.next; w != NULL; w = w->next )
   {
+    if ( w->hidden != 1 ) RENDER_STATS_ADD( widgets, 1 );
+
     switch ( w->type )
     {
       case WT_BUTTON:
@@ -249,6 +255,80 @@ void a_WidgetsInit( const char* filename )
   cursor_blink = 0;
   handle_input_widget = 0;
   handle_control_widget = 0;
+
+  STRNCPY( widget_file, filename, MAX_FILENAME_LENGTH );
+  a_HotReloadWatch( filename, WidgetsHotReload, NULL );
+}
+
+void a_WidgetsReload( const char* filename )
+{
+  aWidget_t* old_head = widget_head.next;
+  aWidget_t* old_tail = widget_tail;
+  char active[MAX_FILENAME_LENGTH] = { 0 };
+
+  if ( app.active_widget != NULL && app.active_widget != &widget_head )
+  {
+    STRNCPY( active, app.active_widget->name, MAX_FILENAME_LENGTH );
+  }
+
+  // Build the new list while the old one is still around to copy from
+  memset( &widget_head, 0, sizeof( aWidget_t ) );
+  widget_tail = &widget_head;
+
+  LoadWidgets( filename );
+
+  aWidget_t* new_head = widget_head.next;
+  aWidget_t* new_tail = widget_tail;
+
+  // Missing or mid-save: keep the UI that is already up
+  if ( new_head == NULL )
+  {
+    aError_t new_error;
+    new_error.error_type = WARNING;
+    snprintf( new_error.error_msg, MAX_LINE_LENGTH, "%s: No widgets in %s, keeping the current ones",
+             log_level_strings[new_error.error_type], filename );
+    LOG( new_error.error_msg );
+
+    widget_head.next = old_head;
+    widget_tail = old_tail;
+    return;
+  }
+
+  // Actions come from game code, not the file
+  for ( aWidget_t* w = new_head; w != NULL; w = w->next )
+  {
+    aWidget_t* old = WidgetFind( old_head, w->name );
+    if ( old != NULL ) w->action = old->action;
+
+    if ( w->type != WT_CONTAINER ) continue;
+
+    aContainerWidget_t* con = (aContainerWidget_t*)w->data;
+    for ( int i = 0; i < con->num_components; i++ )
+    {
+      old = WidgetFind( old_head, con->components[i].name );
+      if ( old != NULL ) con->components[i].action = old->action;
+    }
+  }
+
+  if ( active[0] != '\0' )
+  {
+    aWidget_t* found = WidgetFind( new_head, active );
+    app.active_widget = ( found != NULL ) ? found : new_head;
+  }
+
+  // Hand the old list to the usual teardown, then put the new one back
+  if ( old_head != NULL )
+  {
+    widget_head.next = old_head;
+    a_WidgetCacheFree();
+
+    widget_head.next = new_head;
+    widget_tail = new_tail;
+  }
+
+  slider_delay = 0;
+  handle_input_widget = 0;
+  handle_control_widget = 0;
 }
 
 aWidget_t* a_GetWidget( const char* name )
@@ -302,6 +382,7 @@ static void LoadWidgets( const char* filename )
   aAUFNode_t* node;
 
   root = a_AUFParser( filename );
+  if ( root == NULL ) return;
 
   for ( node = root->head; node != NULL; node = node->next )
   {
@@ -587,26 +668,27 @@ static void CreateWidget( aAUFNode_t* root )
       w->bg.a = bg[3];
     }
 
+    // Decoded off the main thread; a widget draws no image until its upload lands
     if ( w->texture )
     {
       if ( temp_background != NULL )
       {
-        w->images[WI_BACKGROUND] = a_ImageLoad( temp_background->value_string );
+        w->images[WI_BACKGROUND] = a_ImageLoadAsync( temp_background->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
       }
       
       if ( temp_pressed != NULL )
       {
-        w->images[WI_PRESSED] = a_ImageLoad( temp_pressed->value_string );
+        w->images[WI_PRESSED] = a_ImageLoadAsync( temp_pressed->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
       }
       
       if ( temp_hovering != NULL )
       {
-        w->images[WI_HOVERING] = a_ImageLoad( temp_hovering->value_string );
+        w->images[WI_HOVERING] = a_ImageLoadAsync( temp_hovering->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
       }
       
       if ( temp_disabled != NULL )
       {
-        w->images[WI_DISABLED] = a_ImageLoad( temp_disabled->value_string );
+        w->images[WI_DISABLED] = a_ImageLoadAsync( temp_disabled->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
       }
     }
 
@@ -899,8 +981,9 @@ static void CreateContainerWidget( aWidget_t* w, aAUFNode_t* root )
   {
     container->num_components = node_container->value_int;
 
-    container->components = ( aWidget_t* )malloc( sizeof( aWidget_t ) *
-                                                 container->num_components );
+    // Zeroed so components without textures have no images to release
+    container->components = ( aWidget_t* )calloc( container->num_components,
+                                                 sizeof( aWidget_t ) );
 
     if ( container->components == NULL )
     {
@@ -1055,22 +1138,22 @@ static void CreateContainerWidget( aWidget_t* w, aAUFNode_t* root )
       {
         if ( node_background != NULL )
         {
-          current->images[WI_BACKGROUND] = a_ImageLoad( node_background->value_string );
+          current->images[WI_BACKGROUND] = a_ImageLoadAsync( node_background->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
         }
 
         if ( node_pressed != NULL )
         {
-          current->images[WI_PRESSED] = a_ImageLoad( node_pressed->value_string );
+          current->images[WI_PRESSED] = a_ImageLoadAsync( node_pressed->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
         }
 
         if ( node_hovering != NULL )
         {
-          current->images[WI_HOVERING] = a_ImageLoad( node_hovering->value_string );
+          current->images[WI_HOVERING] = a_ImageLoadAsync( node_hovering->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
         }
 
         if ( node_disabled != NULL )
         {
-          current->images[WI_DISABLED] = a_ImageLoad( node_disabled->value_string );
+          current->images[WI_DISABLED] = a_ImageLoadAsync( node_disabled->value_string, IMAGE_LOAD_ATLAS, NULL, NULL );
         }
       }
 
@@ -1425,6 +1508,8 @@ static void DrawContainerWidget( aWidget_t* w )
       
       if ( current.hidden != 1 )
       {
+        RENDER_STATS_ADD( widgets, 1 );
+
         switch ( current.type ) {
           case WT_BUTTON:
             DrawButtonWidget( &current );
@@ -1464,16 +1549,6 @@ int a_WidgetCacheFree( void )
 
   else
   {
-    for ( int i = 0; i < MAX_WIDGET_IMAGE; i++ )
-    {
-      if ( widget_head.images[i] )
-      {
-        SDL_FreeSurface( widget_head.images[i]->surface );
-        SDL_DestroyTexture( widget_head.images[i]->texture );
-        free( widget_head.images[i]->filename );
-      }
-    }
-
     aWidget_t* current = widget_head.next;
     aWidget_t* next = NULL;
 
@@ -1489,6 +1564,8 @@ int a_WidgetCacheFree( void )
         current->action = NULL;
       }
 
+      WidgetReleaseImages( current );
+
       switch ( current->type )
       {
         case WT_SELECT:
@@ -1533,6 +1610,35 @@ int a_WidgetCacheFree( void )
   return 0;
 }
 
+static aWidget_t* WidgetFind( aWidget_t* head, const char* name )
+{
+  for ( aWidget_t* w = head; w != NULL; w = w->next )
+  {
+    if ( strcmp( w->name, name ) == 0 ) return w;
+
+    if ( w->type != WT_CONTAINER ) continue;
+
+    aContainerWidget_t* con = (aContainerWidget_t*)w->data;
+    for ( int i = 0; i < con->num_components; i++ )
+    {
+      if ( strcmp( con->components[i].name, name ) == 0 ) return &con->components[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void WidgetsHotReload( const char* path, void* user )
+{
+  (void)user;
+
+  // a_WidgetsInit() may have moved on to another file since
+  if ( strcmp( path, widget_file ) == 0 )
+  {
+    a_WidgetsReload( path );
+  }
+}
+
 static void ContainerWidgetFree( aContainerWidget_t* con )
 {
   aSelectWidget_t* temp_select = NULL;
@@ -1549,6 +1655,8 @@ static void ContainerWidgetFree( aContainerWidget_t* con )
       current->action = NULL;
     }
 
+    WidgetReleaseImages( current );
+
     switch ( current->type )
     {
       case WT_SELECT:
@@ -1589,6 +1697,16 @@ static void ContainerWidgetFree( aContainerWidget_t* con )
   free( con->components );
 }
 
+static void WidgetReleaseImages( aWidget_t* w )
+{
+  // Images come from the shared cache; hand our references back
+  for ( int i = 0; i < MAX_WIDGET_IMAGE; i++ )
+  {
+    a_ImageRelease( w->images[i] );
+    w->images[i] = NULL;
+  }
+}
+
 static aWidget_t* GetCurrentWidget( void )
 {
   aWidget_t* current = &widget_head;
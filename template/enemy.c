@@ -11,6 +11,9 @@
 #define KNOCKBACK_STRENGTH 20.0f  // Base knockback (halved)
 #define BLOOD_SPILL_DURATION 0.2f
 #define BLOOD_PARTICLE_SIZE 3.0f
+#define BLOOD_LIFETIME 12.0f
+#define BLOOD_FADE_START 10.0f
+#define BLOOD_FADE_RAMP 256
 
 // Enemy AI constants
 static float prediction_time = 0.4f;          // How far ahead to predict player movement
@@ -20,9 +23,9 @@ static float separation_force_radius = 30.0f; // Distance to avoid other enemies
 
 // Dynamic arrays
 static Enemy_t* enemies = NULL;
-static BloodParticle_t* blood_particles = NULL;
+static BloodParticles_t blood = { 0 };
+static uint8_t blood_fade_ramp[BLOOD_FADE_RAMP];
 static int max_enemies = 0;
-static int max_blood_particles = 0;
 
 // App reference (from main.c)
 extern aApp_t app;
@@ -45,12 +48,26 @@ static float lerp(float a, float b, float t) {
 void enemy_init(int max_enemy_count, int max_blood_count)
 {
   max_enemies = max_enemy_count;
-  max_blood_particles = max_blood_count;
 
   enemies = (Enemy_t*)calloc(max_enemies, sizeof(Enemy_t));
-  blood_particles = (BloodParticle_t*)calloc(max_blood_particles, sizeof(BloodParticle_t));
 
-  printf("Enemy system initialized: %d enemies, %d blood particles\n", max_enemies, max_blood_particles);
+  blood.max = max_blood_count;
+  blood.count = 0;
+  blood.x = (float*)calloc(blood.max, sizeof(float));
+  blood.y = (float*)calloc(blood.max, sizeof(float));
+  blood.vx = (float*)calloc(blood.max, sizeof(float));
+  blood.vy = (float*)calloc(blood.max, sizeof(float));
+  blood.lifetime = (float*)calloc(blood.max, sizeof(float));
+  blood.frozen = (uint8_t*)calloc(blood.max, sizeof(uint8_t));
+
+  // Opaque until BLOOD_FADE_START, then linear to 0 at BLOOD_LIFETIME
+  for (int i = 0; i < BLOOD_FADE_RAMP; i++) {
+    float t = (float)i / (BLOOD_FADE_RAMP - 1) * BLOOD_LIFETIME;
+    float fade = (t - BLOOD_FADE_START) / (BLOOD_LIFETIME - BLOOD_FADE_START);
+    blood_fade_ramp[i] = (uint8_t)(255 * (1.0f - (fade < 0.0f ? 0.0f : fade)));
+  }
+
+  printf("Enemy system initialized: %d enemies, %d blood particles\n", max_enemies, blood.max);
 }
 
 void enemy_cleanup(void)
@@ -59,10 +76,13 @@ void enemy_cleanup(void)
     free(enemies);
     enemies = NULL;
   }
-  if (blood_particles) {
-    free(blood_particles);
-    blood_particles = NULL;
-  }
+  free(blood.x);
+  free(blood.y);
+  free(blood.vx);
+  free(blood.vy);
+  free(blood.lifetime);
+  free(blood.frozen);
+  blood = (BloodParticles_t){ 0 };
 }
 
 // ============================================================================
@@ -108,94 +128,102 @@ static void spawn_blood_splatter(float x, float y, float bullet_vx, float bullet
   float dir_x = (bullet_speed > 0.1f) ? bullet_vx / bullet_speed : 1.0f;
   float dir_y = (bullet_speed > 0.1f) ? bullet_vy / bullet_speed : 0.0f;
 
-  for (int i = 0; i < particle_count; i++) {
-    // Find inactive particle
-    for (int j = 0; j < max_blood_particles; j++) {
-      if (!blood_particles[j].active) {
-        // Spawn particles OUTSIDE the enemy body in bullet direction
-        float spawn_offset = RANDF(12.0f, 24.0f);
-        blood_particles[j].x = x + ENEMY_RADIUS + dir_x * spawn_offset;
-        blood_particles[j].y = y + ENEMY_RADIUS + dir_y * spawn_offset;
-
-        // Particle velocity: bullet direction + wide spread for explosion effect
-        float speed_base = RANDF(150.0f, 400.0f);
-        float spread_angle = RANDF(-M_PI * 0.6f, M_PI * 0.6f); // 120° spread
-        float cos_spread = cosf(spread_angle);
-        float sin_spread = sinf(spread_angle);
-
-        // Rotate bullet direction by spread angle
-        blood_particles[j].vx = (dir_x * cos_spread - dir_y * sin_spread) * speed_base;
-        blood_particles[j].vy = (dir_x * sin_spread + dir_y * cos_spread) * speed_base;
-
-        blood_particles[j].lifetime = 0.0f;
-        blood_particles[j].active = 1;
-        blood_particles[j].frozen = 0;
-        break;
-      }
-    }
+  for (int i = 0; i < particle_count && blood.count < blood.max; i++) {
+    int j = blood.count++;
+
+    // Spawn particles OUTSIDE the enemy body in bullet direction
+    float spawn_offset = RANDF(12.0f, 24.0f);
+    blood.x[j] = x + ENEMY_RADIUS + dir_x * spawn_offset;
+    blood.y[j] = y + ENEMY_RADIUS + dir_y * spawn_offset;
+
+    // Particle velocity: bullet direction + wide spread for explosion effect
+    float speed_base = RANDF(150.0f, 400.0f);
+    float spread_angle = RANDF(-M_PI * 0.6f, M_PI * 0.6f); // 120° spread
+    float cos_spread = cosf(spread_angle);
+    float sin_spread = sinf(spread_angle);
+
+    // Rotate bullet direction by spread angle
+    blood.vx[j] = (dir_x * cos_spread - dir_y * sin_spread) * speed_base;
+    blood.vy[j] = (dir_x * sin_spread + dir_y * cos_spread) * speed_base;
+
+    blood.lifetime[j] = 0.0f;
+    blood.frozen[j] = 0;
   }
 }
 
+// Swap the last live particle into slot i, keeping live particles packed
+static void kill_blood_particle(int i)
+{
+  int last = --blood.count;
+
+  blood.x[i] = blood.x[last];
+  blood.y[i] = blood.y[last];
+  blood.vx[i] = blood.vx[last];
+  blood.vy[i] = blood.vy[last];
+  blood.lifetime[i] = blood.lifetime[last];
+  blood.frozen[i] = blood.frozen[last];
+}
+
 static void update_blood_particles(float dt)
 {
-  for (int i = 0; i < max_blood_particles; i++) {
-    if (blood_particles[i].active) {
-      blood_particles[i].lifetime += dt;
-
-      // Deactivate after 12 seconds
-      if (blood_particles[i].lifetime >= 12.0f) {
-        blood_particles[i].active = 0;
-        continue;
-      }
+  int i = 0;
+  while (i < blood.count) {
+    blood.lifetime[i] += dt;
 
-      // Freeze physics after 0.2s spill animation
-      if (blood_particles[i].lifetime >= BLOOD_SPILL_DURATION) {
-        blood_particles[i].frozen = 1;
-        blood_particles[i].vx = 0.0f;
-        blood_particles[i].vy = 0.0f;
-      }
+    // Deactivate after 12 seconds
+    if (blood.lifetime[i] >= BLOOD_LIFETIME) {
+      kill_blood_particle(i);
+      continue;
+    }
 
-      // Only apply physics if not frozen
-      if (!blood_particles[i].frozen) {
-        // Apply velocity
-        blood_particles[i].x += blood_particles[i].vx * dt;
-        blood_particles[i].y += blood_particles[i].vy * dt;
+    // Freeze physics after 0.2s spill animation
+    if (blood.lifetime[i] >= BLOOD_SPILL_DURATION) {
+      blood.frozen[i] = 1;
+      blood.vx[i] = 0.0f;
+      blood.vy[i] = 0.0f;
+    }
 
-        // Apply friction (slow down over time)
-        blood_particles[i].vx *= 0.95f;
-        blood_particles[i].vy *= 0.95f;
+    // Only apply physics if not frozen
+    if (!blood.frozen[i]) {
+      // Apply velocity
+      blood.x[i] += blood.vx[i] * dt;
+      blood.y[i] += blood.vy[i] * dt;
 
-        // Apply gravity
-        blood_particles[i].vy += 200.0f * dt;
-      }
+      // Apply friction (slow down over time)
+      blood.vx[i] *= 0.95f;
+      blood.vy[i] *= 0.95f;
 
-      // Deactivate if off screen
-      if (blood_particles[i].x < -10 || blood_particles[i].x > SCREEN_WIDTH + 10 ||
-          blood_particles[i].y < -10 || blood_particles[i].y > SCREEN_HEIGHT + 10) {
-        blood_particles[i].active = 0;
-      }
+      // Apply gravity
+      blood.vy[i] += 200.0f * dt;
     }
+
+    // Deactivate if off screen
+    if (blood.x[i] < -10 || blood.x[i] > SCREEN_WIDTH + 10 ||
+        blood.y[i] < -10 || blood.y[i] > SCREEN_HEIGHT + 10) {
+      kill_blood_particle(i);
+      continue;
+    }
+
+    i++;
   }
 }
 
 static void draw_blood_particles(void)
 {
-  for (int i = 0; i < max_blood_particles; i++) {
-    if (blood_particles[i].active) {
-      // Fade starts at 10 seconds, fades over 2 seconds
-      int alpha = 255;
-      if (blood_particles[i].lifetime > 10.0f) {
-        float fade_progress = (blood_particles[i].lifetime - 10.0f) / 2.0f;
-        alpha = (int)(255 * (1.0f - fade_progress));
-        if (alpha < 0) alpha = 0;
-      }
-
-      a_DrawFilledRect(
-        (aRectf_t){blood_particles[i].x, blood_particles[i].y, BLOOD_PARTICLE_SIZE, BLOOD_PARTICLE_SIZE},
-        (aColor_t){139, 0, 0, alpha} // Dark red
-      );
-    }
-  }
+  // One vertex buffer, one draw call; fades come from the ramp by lifetime
+  aParticles_t particles = {
+    .x = blood.x,
+    .y = blood.y,
+    .count = blood.count,
+    .size = BLOOD_PARTICLE_SIZE,
+    .color = {139, 0, 0, 255}, // Dark red
+    .life = blood.lifetime,
+    .life_max = BLOOD_LIFETIME,
+    .alpha_ramp = blood_fade_ramp,
+    .ramp_size = BLOOD_FADE_RAMP
+  };
+
+  a_DrawParticles(&particles);
 }
 
 // ============================================================================
@@ -667,7 +695,7 @@ void enemy_update(float dt, float player_x, float player_y, float player_vx, flo
 
 void enemy_draw(void)
 {
-  // Draw blood particles FIRST (under everything)
+  // Blood is drawn immediately, underneath everything the draw list holds
   draw_blood_particles();
 
   // Draw all enemies
@@ -692,9 +720,10 @@ void enemy_draw(void)
         if (alpha < 0) alpha = 0;
       }
 
-      a_DrawFilledRect(
+      a_DrawListFilledRect(
         (aRectf_t){e->x, e->y, ENEMY_SIZE, ENEMY_SIZE},
-        (aColor_t){red, green, blue, alpha}
+        (aColor_t){red, green, blue, alpha},
+        DRAW_LAYER_ENEMIES, SDL_BLENDMODE_BLEND, 0
       );
     }
   }
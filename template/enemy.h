@@ -3,6 +3,9 @@
 
 #include "../include/Archimedes.h"
 
+// Draw list layers for the game scene (blood is drawn beneath the list)
+#define DRAW_LAYER_ENEMIES 1
+
 // Enemy state
 typedef enum {
   ENEMY_STATE_ALIVE,
@@ -40,14 +43,17 @@ typedef struct {
   float death_timer;            // Time since death (for fade)
 } Enemy_t;
 
-// Blood particle structure
+// Blood particles as parallel arrays, so they can go straight to a_DrawParticles()
 typedef struct {
-  float x, y;                   // Position
-  float vx, vy;                 // Velocity
-  float lifetime;               // Time alive
-  int active;                   // Is particle alive?
-  int frozen;                   // Physics frozen after spill animation
-} BloodParticle_t;
+  float* x;                     // Position
+  float* y;
+  float* vx;                    // Velocity
+  float* vy;
+  float* lifetime;              // Time alive
+  uint8_t* frozen;              // Physics frozen after spill animation
+  int count;                    // Live particles, packed at the front
+  int max;
+} BloodParticles_t;
 
 /**
  * @brief Initialize enemy system
@@ -80,7 +86,7 @@ int enemy_spawn(float x, float y);
 void enemy_update(float dt, float player_x, float player_y, float player_vx, float player_vy);
 
 /**
- * @brief Draw all enemies
+ * @brief Draw blood particles and record enemies into the active draw list
  */
 void enemy_draw(void);
 
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -11,12 +12,14 @@
 #include "player_actions.h"
 #include "audio_test.h"
 #include "enemy.h"
+#include "sprite_bench.h"
 
 // Scene system
 typedef enum {
   SCENE_GAME,
   SCENE_TEST_TEXT,
-  SCENE_AUDIO_TEST
+  SCENE_AUDIO_TEST,
+  SCENE_SPRITE_BENCH
 } Scene_t;
 
 static Scene_t current_scene = SCENE_GAME;
@@ -24,12 +27,22 @@ static Scene_t current_scene = SCENE_GAME;
 // Scene function declarations
 static void scene_game_logic( float dt );
 static void scene_game_draw( float dt );
+static void draw_shortcuts( int x, int y );
 
 static void aDoLoop( float );
 static void aRenderLoop( float );
 
 aImage_t* bullet_img;
 
+// Static HUD content, redrawn only when invalidated
+#define SHORTCUTS_LAYER_W 400
+#define SHORTCUTS_LAYER_H 160
+static aLayer_t* shortcuts_layer = NULL;
+
+// Image cache table, toggled with Ctrl+I
+#define IMAGE_CACHE_TABLE_ROWS 12
+static int show_image_cache = 0;
+
 // Hit sounds (exported for enemy.c)
 #define HIT_SOUND_COUNT 5
 aSoundEffect_t hit_sounds[HIT_SOUND_COUNT];
@@ -60,12 +73,14 @@ void aInitGame( void )
   // Set background color (dark blue)
   app.background = (aColor_t){20, 20, 60, 255};
 
-  bullet_img = a_ImageLoad( "resources/assets/bullet.png" );
+  bullet_img = a_ImageLoadEx( "resources/assets/bullet.png", IMAGE_LOAD_DROP_SURFACE );
   if ( bullet_img == NULL )
   {
     printf( "Failed to load bullet image\n" );
   }
 
+  shortcuts_layer = a_LayerCreate( SHORTCUTS_LAYER_W, SHORTCUTS_LAYER_H );
+
   // Initialize player
   player_init();
 
@@ -154,6 +169,12 @@ static void aDoLoop( float dt )
         app.keyboard[ SDL_SCANCODE_ESCAPE ] = 0;
       }
       break;
+    case SCENE_SPRITE_BENCH:
+      if ( sprite_bench_logic( dt ) )
+      {
+        current_scene = SCENE_GAME;
+      }
+      break;
   }
 }
 
@@ -277,6 +298,73 @@ static void scene_game_logic( float dt )
   {
     ctrl_m_pressed = 0;
   }
+
+  // Ctrl+B to switch to sprite batch benchmark scene
+  static int ctrl_b_pressed = 0;
+  if ( (app.keyboard[ SDL_SCANCODE_LCTRL ] || app.keyboard[ SDL_SCANCODE_RCTRL ]) &&
+       app.keyboard[ SDL_SCANCODE_B ] == 1 && !ctrl_b_pressed )
+  {
+    current_scene = SCENE_SPRITE_BENCH;
+    ctrl_b_pressed = 1;
+    app.keyboard[ SDL_SCANCODE_B ] = 0;
+  }
+  if ( app.keyboard[ SDL_SCANCODE_B ] == 0 )
+  {
+    ctrl_b_pressed = 0;
+  }
+
+  // Ctrl+P saves a screenshot; captured at present, encoded off-thread
+  static int ctrl_p_pressed = 0;
+  if ( (app.keyboard[ SDL_SCANCODE_LCTRL ] || app.keyboard[ SDL_SCANCODE_RCTRL ]) &&
+       app.keyboard[ SDL_SCANCODE_P ] == 1 && !ctrl_p_pressed )
+  {
+    a_CaptureRecordStart( "screenshot_", 1, CAPTURE_FORMAT_PNG );
+    ctrl_p_pressed = 1;
+    app.keyboard[ SDL_SCANCODE_P ] = 0;
+  }
+  if ( app.keyboard[ SDL_SCANCODE_P ] == 0 )
+  {
+    ctrl_p_pressed = 0;
+  }
+
+  // Ctrl+R toggles dumping the next 600 frames as a QOI sequence
+  static int ctrl_r_pressed = 0;
+  if ( (app.keyboard[ SDL_SCANCODE_LCTRL ] || app.keyboard[ SDL_SCANCODE_RCTRL ]) &&
+       app.keyboard[ SDL_SCANCODE_R ] == 1 && !ctrl_r_pressed )
+  {
+    if ( a_CaptureIsRecording() )
+    {
+      a_CaptureRecordStop();
+    }
+    else
+    {
+      a_CaptureRecordStart( "frame_", 600, CAPTURE_FORMAT_QOI );
+    }
+    ctrl_r_pressed = 1;
+    app.keyboard[ SDL_SCANCODE_R ] = 0;
+  }
+  if ( app.keyboard[ SDL_SCANCODE_R ] == 0 )
+  {
+    ctrl_r_pressed = 0;
+  }
+
+  // Ctrl+I toggles the image cache table; the full list goes to stdout
+  static int ctrl_i_pressed = 0;
+  if ( (app.keyboard[ SDL_SCANCODE_LCTRL ] || app.keyboard[ SDL_SCANCODE_RCTRL ]) &&
+       app.keyboard[ SDL_SCANCODE_I ] == 1 && !ctrl_i_pressed )
+  {
+    show_image_cache = !show_image_cache;
+    if ( show_image_cache )
+    {
+      a_ImageCacheDump( 0 );
+    }
+    ctrl_i_pressed = 1;
+    app.keyboard[ SDL_SCANCODE_I ] = 0;
+  }
+  if ( app.keyboard[ SDL_SCANCODE_I ] == 0 )
+  {
+    ctrl_i_pressed = 0;
+  }
 }
 
 static void aRenderLoop( float dt )
@@ -293,9 +381,17 @@ static void aRenderLoop( float dt )
     case SCENE_AUDIO_TEST:
       audio_test_draw();
       break;
+    case SCENE_SPRITE_BENCH:
+      sprite_bench_draw( dt );
+      break;
   }
 
   a_DrawWidgets();
+
+  if ( show_image_cache )
+  {
+    a_ImageCacheDrawStats( 10, 10, IMAGE_CACHE_TABLE_ROWS );
+  }
 }
 
 static void scene_game_draw( float dt )
@@ -348,13 +444,48 @@ static void scene_game_draw( float dt )
 
   a_DrawText( spawn_timer_text, SCREEN_WIDTH - 20, 40, enemy_count_style );
 
-  // Draw enemies (includes blood particles)
-  enemy_draw();
+  // Recording indicator; a growing backlog means the encoder can't keep up
+  if ( a_CaptureIsRecording() )
+  {
+    char capture_text[32];
+    snprintf( capture_text, sizeof(capture_text), "REC  backlog %d", a_CaptureBacklog() );
+
+    aTextStyle_t capture_style = {
+      .type = FONT_ENTER_COMMAND,
+      .fg = {255, 64, 64, 255},
+      .align = TEXT_ALIGN_LEFT,
+      .wrap_width = 0,
+      .scale = 0.6f
+    };
+    a_DrawText( capture_text, 20, 15, capture_style );
+  }
 
-  // Draw player and bullets
+  // World is recorded out of order and sorted by layer: enemies, player,
+  // bullets, with each layer going out as a single draw call
+  a_DrawListBegin();
+  enemy_draw();
   player_draw( bullet_img );
+  a_DrawListEnd();
+
+  // Keyboard shortcuts never change, so they live in a layer
+  if ( shortcuts_layer == NULL )
+  {
+    draw_shortcuts( SCREEN_WIDTH - 20, SCREEN_HEIGHT - SHORTCUTS_LAYER_H );
+    return;
+  }
+
+  if ( a_LayerBegin( shortcuts_layer ) )
+  {
+    draw_shortcuts( SHORTCUTS_LAYER_W, 0 );
+    a_LayerEnd( shortcuts_layer );
+  }
 
-  // Draw keyboard shortcuts (bottom right, 30% opacity white)
+  a_BlitLayer( shortcuts_layer, SCREEN_WIDTH - 20 - SHORTCUTS_LAYER_W, SCREEN_HEIGHT - SHORTCUTS_LAYER_H );
+}
+
+static void draw_shortcuts( int x, int y )
+{
+  // Bottom right, 30% opacity white
   aTextStyle_t shortcuts_style = {
     .type = FONT_ENTER_COMMAND,
     .fg = {255, 255, 255, 77},  // 30% opacity (255 * 0.3 = 77)
@@ -363,28 +494,90 @@ static void scene_game_draw( float dt )
     .scale = 0.5f
   };
 
-  int y_offset = SCREEN_HEIGHT - 80;
-  a_DrawText("Ctrl+T - Text Test", SCREEN_WIDTH - 20, y_offset, shortcuts_style);
-  y_offset += 20;
-  a_DrawText("Ctrl+M - Audio Test", SCREEN_WIDTH - 20, y_offset, shortcuts_style);
-  y_offset += 20;
-  a_DrawText("ESC - Quit", SCREEN_WIDTH - 20, y_offset, shortcuts_style);
+  a_DrawText("Ctrl+T - Text Test", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("Ctrl+M - Audio Test", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("Ctrl+B - Sprite Batch Benchmark", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("Ctrl+P - Screenshot", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("Ctrl+R - Record Frames", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("Ctrl+I - Image Cache", x, y, shortcuts_style);
+  y += 20;
+  a_DrawText("ESC - Quit", x, y, shortcuts_style);
 }
 
 void aMainloop( void )
 {
+  // Read once: a second call would see the ~0 ms since the first
+  float dt = a_GetDeltaTime();
+
   a_PrepareScene();
 
-  app.delegate.logic( a_GetDeltaTime() );
-  app.delegate.draw( a_GetDeltaTime() );
-  
+  app.delegate.logic( dt );
+  app.delegate.draw( dt );
+
+  // Paces the frame according to app.options.frame_cap
   a_PresentScene();
 }
 
-int main( void )
+// Renders a fixed number of frames without a window, reports the average
+// frame cost and saves the last frame for golden-image comparisons
+static int run_headless( int frames )
 {
+  aInitOptions_t options = {
+    .width = SCREEN_WIDTH,
+    .height = SCREEN_HEIGHT,
+    .title = "Archimedes",
+    .headless = 1
+  };
+
+  if ( a_InitEx( &options ) != 0 )
+  {
+    printf( "Headless init failed: %s\n", SDL_GetError() );
+    return 1;
+  }
+
+  app.options.frame_cap = FRAME_PACE_UNCAPPED;
+  aInitGame();
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for ( int i = 0; i < frames && app.running; i++ )
+  {
+    aMainloop();
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+
+  double ms = (double)( end - start ) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+  printf( "%d headless frames, %.3f ms/frame\n", frames, frames > 0 ? ms / frames : 0.0 );
+
+  a_ScreenshotSave( app.renderer, "headless_frame.png" );
+
+  a_Quit();
+
+  return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+  // Built by `make pack`; without it every image is decoded from its PNG
+  a_PackMount( "resources/assets.apak" );
+
+  // --headless [frames]: no window, for build boxes without a display
+  if ( argc > 1 && strcmp( argv[1], "--headless" ) == 0 )
+  {
+    return run_headless( argc > 2 ? atoi( argv[2] ) : 600 );
+  }
+
   a_Init( SCREEN_WIDTH, SCREEN_HEIGHT, "Archimedes" );
 
+  #ifndef __EMSCRIPTEN__
+    // Save a PNG, font or widget file and it updates in the running game
+    a_HotReloadInit();
+  #endif
+
   aInitGame();
 
   #ifdef __EMSCRIPTEN__
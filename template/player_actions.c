@@ -200,16 +200,18 @@ int player_check_bullet_collision(float enemy_x, float enemy_y, float enemy_radi
 void player_draw(aImage_t* img)
 {
   // Draw the player square
-  a_DrawFilledRect((aRectf_t){player_x, player_y, 32, 32}, (aColor_t){0, 0, 255, 255});
+  a_DrawListFilledRect((aRectf_t){player_x, player_y, 32, 32}, (aColor_t){0, 0, 255, 255},
+                       DRAW_LAYER_PLAYER, SDL_BLENDMODE_BLEND, 0);
 
   // Draw all active bullets at 25% size
-  if (img != NULL && img->surface != NULL)
+  if (img != NULL && img->texture != NULL)
   {
-    float img_w = (float)img->surface->w;
-    float img_h = (float)img->surface->h;
+    float img_w = (float)img->rect.w;
+    float img_h = (float)img->rect.h;
     float scaled_w = img_w * 0.25f;
     float scaled_h = img_h * 0.25f;
 
+    // All bullets share one texture and layer, so they go out in one call
     for (int i = 0; i < MAX_BULLETS; i++)
     {
       if (bullets[i].active)
@@ -217,8 +219,8 @@ void player_draw(aImage_t* img)
         aRectf_t src = {0, 0, img_w, img_h};
         aRectf_t dest = {bullets[i].x, bullets[i].y, scaled_w, scaled_h};
 
-        // scale = 1 because dest already has the scaled size
-        a_BlitRect(img, &src, &dest, 1);
+        a_DrawListSprite(img, &src, &dest, white, 0.0f, SDL_FLIP_NONE,
+                         DRAW_LAYER_BULLETS, SDL_BLENDMODE_BLEND, 0);
       }
     }
   }
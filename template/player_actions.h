@@ -9,6 +9,10 @@
 
 #include "Archimedes.h"
 
+// Draw list layers, above the enemy layers
+#define DRAW_LAYER_PLAYER  2
+#define DRAW_LAYER_BULLETS 3
+
 /**
  * @brief Initialize player state
  */
@@ -21,7 +25,7 @@ void player_init(void);
 void player_update(float dt);
 
 /**
- * @brief Draw player and active bullets
+ * @brief Record player and active bullets into the active draw list
  * @param img Bullet texture image
  */
 void player_draw(aImage_t* img);
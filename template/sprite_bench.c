@@ -0,0 +1,213 @@
+/**
+ * sprite_bench.c - Sprite Batch Benchmark Scene
+ *
+ * Draws 10,000 sprites cut from the template's sprite sheets, either with
+ * one a_BlitRect call each or through a_SpriteBatch, and reports the
+ * average CPU time spent submitting them.
+ *
+ * Controls:
+ * - SPACE toggles between the batch and a_BlitRect
+ * - Ctrl+B returns to the game
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Archimedes.h"
+#include "sprite_bench.h"
+
+// ============================================================================
+// Static state for benchmark scene
+// ============================================================================
+
+#define BENCH_SPRITE_COUNT 10000
+#define BENCH_SHEET_COUNT  4
+#define BENCH_SAMPLE_FRAMES 120
+
+typedef struct
+{
+  int sheet;
+  aRectf_t src;
+  aRectf_t dest;
+} BenchSprite_t;
+
+static const char* bench_sheet_files[BENCH_SHEET_COUNT] = {
+  "resources/assets/coins.png",
+  "resources/assets/enemy.png",
+  "resources/assets/bullet.png",
+  "resources/assets/BasicStickAnim.png"
+};
+
+// Cell size used to cut each sheet into frames
+static const int bench_cell_size[BENCH_SHEET_COUNT] = { 16, 100, 100, 32 };
+
+static aImage_t* bench_sheets[BENCH_SHEET_COUNT] = { 0 };
+static BenchSprite_t* bench_sprites = NULL;
+static int bench_initialized = 0;
+
+static int use_batch = 1;
+static double sample_ms = 0.0;
+static int sample_frames = 0;
+static double avg_ms[2] = { 0.0, 0.0 };  // [0] = a_BlitRect, [1] = batch
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+static void init_bench( void )
+{
+  for ( int i = 0; i < BENCH_SHEET_COUNT; i++ )
+  {
+    // Kept off the atlas so each sheet is its own texture and the blit
+    // path really does switch textures; the surfaces aren't needed
+    bench_sheets[i] = a_ImageLoadEx( bench_sheet_files[i], IMAGE_LOAD_DROP_SURFACE );
+    if ( bench_sheets[i] == NULL )
+    {
+      printf( "Failed to load %s\n", bench_sheet_files[i] );
+      return;
+    }
+  }
+
+  bench_sprites = malloc( sizeof( BenchSprite_t ) * BENCH_SPRITE_COUNT );
+  if ( bench_sprites == NULL )
+  {
+    printf( "Failed to allocate benchmark sprites\n" );
+    return;
+  }
+
+  // Interleave sheets so the per-call path switches texture constantly,
+  // the worst (and most common) case for immediate blits
+  for ( int i = 0; i < BENCH_SPRITE_COUNT; i++ )
+  {
+    BenchSprite_t* s = &bench_sprites[i];
+    int cell = bench_cell_size[i % BENCH_SHEET_COUNT];
+    int w = bench_sheets[i % BENCH_SHEET_COUNT]->rect.w;
+    int frames = w / cell;
+
+    s->sheet = i % BENCH_SHEET_COUNT;
+    s->src   = (aRectf_t){ ( rand() % frames ) * cell, 0, cell, cell };
+    s->dest  = (aRectf_t){ RANDF( 0, SCREEN_WIDTH - 16 ), RANDF( 0, SCREEN_HEIGHT - 16 ), 16, 16 };
+  }
+
+  bench_initialized = 1;
+}
+
+// ============================================================================
+// Logic / Draw
+// ============================================================================
+
+int sprite_bench_logic( float dt )
+{
+  (void)dt;  // unused
+  static int ctrl_b_pressed = 0;
+  static int space_pressed = 0;
+
+  if ( !bench_initialized )
+  {
+    init_bench();
+  }
+
+  // Ctrl+B to return to game
+  if ( (app.keyboard[ SDL_SCANCODE_LCTRL ] || app.keyboard[ SDL_SCANCODE_RCTRL ]) &&
+       app.keyboard[ SDL_SCANCODE_B ] == 1 && !ctrl_b_pressed )
+  {
+    ctrl_b_pressed = 1;
+    app.keyboard[ SDL_SCANCODE_B ] = 0;
+    return 1;  // Signal to switch back to game
+  }
+  if ( app.keyboard[ SDL_SCANCODE_B ] == 0 )
+  {
+    ctrl_b_pressed = 0;
+  }
+
+  if ( app.keyboard[ SDL_SCANCODE_SPACE ] == 1 && !space_pressed )
+  {
+    use_batch = !use_batch;
+    sample_ms = 0.0;
+    sample_frames = 0;
+    space_pressed = 1;
+  }
+  if ( app.keyboard[ SDL_SCANCODE_SPACE ] == 0 )
+  {
+    space_pressed = 0;
+  }
+
+  return 0;
+}
+
+void sprite_bench_draw( float dt )
+{
+  (void)dt;  // unused
+
+  if ( !bench_initialized ) return;
+
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  if ( use_batch )
+  {
+    a_SpriteBatchBegin();
+    for ( int i = 0; i < BENCH_SPRITE_COUNT; i++ )
+    {
+      BenchSprite_t* s = &bench_sprites[i];
+      a_SpriteBatchSubmit( bench_sheets[s->sheet], &s->src, &s->dest, white, 0.0f, SDL_FLIP_NONE, 0 );
+    }
+    a_SpriteBatchEnd();
+  }
+  else
+  {
+    for ( int i = 0; i < BENCH_SPRITE_COUNT; i++ )
+    {
+      BenchSprite_t* s = &bench_sprites[i];
+      a_BlitRect( bench_sheets[s->sheet], &s->src, &s->dest, 1.0f );
+    }
+  }
+
+  Uint64 end = SDL_GetPerformanceCounter();
+
+  sample_ms += (double)( end - start ) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+  sample_frames++;
+
+  if ( sample_frames == BENCH_SAMPLE_FRAMES )
+  {
+    avg_ms[use_batch] = sample_ms / sample_frames;
+    sample_ms = 0.0;
+    sample_frames = 0;
+  }
+
+  // Results panel
+  aRectf_t panel = { 10, 10, 420, 135 };
+  a_DrawFilledRect( panel, (aColor_t){ 0, 0, 0, 200 } );
+
+  aTextStyle_t style = {
+    .type = FONT_ENTER_COMMAND,
+    .fg = {255, 255, 255, 255},
+    .align = TEXT_ALIGN_LEFT,
+    .wrap_width = 0,
+    .scale = 0.6f
+  };
+
+  char line[64];
+  snprintf( line, sizeof(line), "%d sprites, %d sheets - mode: %s",
+            BENCH_SPRITE_COUNT, BENCH_SHEET_COUNT, use_batch ? "a_SpriteBatch" : "a_BlitRect" );
+  a_DrawText( line, 20, 20, style );
+
+  snprintf( line, sizeof(line), "a_BlitRect:    %.3f ms/frame", avg_ms[0] );
+  a_DrawText( line, 20, 45, style );
+
+  snprintf( line, sizeof(line), "a_SpriteBatch: %.3f ms/frame", avg_ms[1] );
+  a_DrawText( line, 20, 70, style );
+
+  // Counters of the previous frame; zeros unless built with make STATS=1
+  aRenderStats_t stats;
+  if ( a_RenderStatsGet( &stats ) == 0 )
+  {
+    snprintf( line, sizeof(line), "%u draws, %u binds, %u state changes",
+              stats.draw_calls, stats.texture_binds, stats.state_changes );
+  }
+  else
+  {
+    snprintf( line, sizeof(line), "render stats disabled" );
+  }
+  a_DrawText( line, 20, 95, style );
+
+  a_DrawText( "SPACE - switch mode   Ctrl+B - back", 20, 120, style );
+}
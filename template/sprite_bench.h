@@ -0,0 +1,23 @@
+/**
+ * sprite_bench.h - Sprite Batch Benchmark Scene
+ *
+ * Public interface for the sprite batch vs a_BlitRect benchmark scene.
+ */
+
+#ifndef SPRITE_BENCH_H
+#define SPRITE_BENCH_H
+
+/**
+ * @brief Handle logic for the sprite benchmark scene
+ * @param dt Delta time (unused)
+ * @return 1 if should switch back to game, 0 to stay in benchmark scene
+ */
+int sprite_bench_logic( float dt );
+
+/**
+ * @brief Draw the sprite benchmark scene
+ * @param dt Delta time (unused)
+ */
+void sprite_bench_draw( float dt );
+
+#endif /* SPRITE_BENCH_H */
@@ -0,0 +1,162 @@
+/*
+ * apack.c:
+ *
+ * Command-line asset packer. Collects PNGs from the files and directories
+ * given and bakes them into a pack with a_PackWrite(). Paths are stored
+ * exactly as they're found from the working directory, so run it from the
+ * same place the game runs from:
+ *
+ *   bin/apack [-z] resources/assets.apak resources/assets resources/fonts
+ *
+ * Copyright (c) 2025 Jacob Kellum <jkellum819@gmail.com>
+ ************************************************************************
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include "Archimedes.h"
+
+static char** files = NULL;
+static int file_count = 0;
+static int file_max = 0;
+
+static int AddFile( const char* path );
+static int CollectImages( const char* path );
+static int CompareFiles( const void* a, const void* b );
+
+int main( int argc, char* argv[] )
+{
+  int flags = 0;
+  int arg = 1;
+
+  if ( arg < argc && strcmp( argv[arg], "-z" ) == 0 )
+  {
+    flags |= PACK_WRITE_COMPRESS;
+    arg++;
+  }
+
+  if ( argc - arg < 2 )
+  {
+    printf( "usage: %s [-z] <pack.apak> <image or directory>...\n", argv[0] );
+    printf( "  -z  LZ-compress pixel blocks\n" );
+    return 1;
+  }
+
+  const char* output = argv[arg++];
+
+  for ( ; arg < argc; arg++ )
+  {
+    // "dir/" would store "dir//file.png", which the game never asks for
+    size_t length = strlen( argv[arg] );
+    while ( length > 1 && argv[arg][length - 1] == '/' )
+    {
+      argv[arg][--length] = '\0';
+    }
+
+    if ( CollectImages( argv[arg] ) != 0 ) return 1;
+  }
+
+  if ( file_count == 0 )
+  {
+    printf( "No PNG images found\n" );
+    return 1;
+  }
+
+  // Sorted so the same inputs always produce the same pack
+  qsort( files, file_count, sizeof( char* ), CompareFiles );
+
+  int status = a_PackWrite( output, (const char**)files, file_count, flags );
+
+  for ( int i = 0; i < file_count; i++ )
+  {
+    free( files[i] );
+  }
+  free( files );
+
+  return status;
+}
+
+static int AddFile( const char* path )
+{
+  if ( file_count == file_max )
+  {
+    int new_max = file_max ? file_max * 2 : 64;
+    char** new_files = realloc( files, sizeof( char* ) * new_max );
+    if ( new_files == NULL )
+    {
+      printf( "Failed to allocate memory for the file list\n" );
+      return 1;
+    }
+
+    files = new_files;
+    file_max = new_max;
+  }
+
+  files[file_count] = strdup( path );
+  if ( files[file_count] == NULL ) return 1;
+
+  file_count++;
+
+  return 0;
+}
+
+static int CollectImages( const char* path )
+{
+  struct stat st;
+
+  if ( stat( path, &st ) != 0 )
+  {
+    printf( "Can't read %s\n", path );
+    return 1;
+  }
+
+  if ( !S_ISDIR( st.st_mode ) )
+  {
+    const char* ext = strrchr( path, '.' );
+    if ( ext != NULL && strcasecmp( ext, ".png" ) == 0 )
+    {
+      return AddFile( path );
+    }
+
+    return 0;
+  }
+
+  DIR* dir = opendir( path );
+  if ( dir == NULL )
+  {
+    printf( "Can't open directory %s\n", path );
+    return 1;
+  }
+
+  struct dirent* ent;
+  int status = 0;
+
+  while ( status == 0 && ( ent = readdir( dir ) ) != NULL )
+  {
+    if ( ent->d_name[0] == '.' ) continue;
+
+    char child[MAX_FILENAME_LENGTH];
+    int length = snprintf( child, sizeof( child ), "%s/%s", path, ent->d_name );
+    if ( length < 0 || length >= (int)sizeof( child ) )
+    {
+      printf( "Path too long: %s/%s\n", path, ent->d_name );
+      continue;
+    }
+
+    status = CollectImages( child );
+  }
+
+  closedir( dir );
+
+  return status;
+}
+
+static int CompareFiles( const void* a, const void* b )
+{
+  return strcmp( *(char* const*)a, *(char* const*)b );
+}